@@ -0,0 +1,367 @@
+// Project identifier: 43DE0E0C4C76BFAA6D8C2F5AEAE0518A9C42CF4E
+
+#ifndef ADAPTIVEPQ_H
+#define ADAPTIVEPQ_H
+
+#include <cstddef>
+#include <iterator>
+#include <memory>
+#include <utility>
+#include <variant>
+#include <vector>
+
+#include "BinaryPQ.hpp"
+#include "Eecs281PQ.hpp"
+#include "MemoryUsage.hpp"
+#include "PairingPQ.hpp"
+#include "UnorderedFastPQ.hpp"
+
+// When AdaptivePQ moves from one backend to another.  The size thresholds
+// leave a gap between them (hysteresis): after a migration at least
+// binaryAbove - unorderedBelow operations must happen before the next
+// size-driven one, so the O(n) cost of migrating stays amortized O(1).
+//
+// The size defaults come from the hold model in benchDES (double keys):
+// UnorderedFastPQ is ahead of BinaryPQ up to about 12-16 elements, and
+// falls behind quickly after that.
+//
+// The merge-rate defaults come from benchMeld (double keys, 1e3-1e5
+// elements, merges of 1-64 elements).  When the merged elements are later
+// popped (its hold model) BinaryPQ stays 2-6x ahead at any merge rate, as
+// PairingPQ's pops cost more than the pushes its meld saves.  Only when
+// the queue grows by its merges (the grow model) does PairingPQ catch up:
+// it is ahead from a merge fraction of about 0.9 with 64-element merges
+// and 0.95 with 8-element ones, while at 0.7 and below BinaryPQ is ahead
+// in all but one (noisy) run.
+struct AdaptiveThresholds {
+  // Move from UnorderedFastPQ to BinaryPQ once size() exceeds this.
+  std::size_t binaryAbove = 24; // NOLINT: calibrated default
+  // Move back to UnorderedFastPQ once size() drops below this.
+  std::size_t unorderedBelow = 8; // NOLINT: calibrated default
+  // Number of push/pop/merge operations between op-mix samples.
+  std::size_t window = 1024; // NOLINT: sampling window
+  // Move to PairingPQ once this fraction of the sampled operations are
+  // merge() calls, which it does in O(1) instead of one push per element.
+  double pairingEnter = 0.9; // NOLINT: calibrated default
+  // Leave PairingPQ again once the merge fraction drops below this.
+  double pairingLeave = 0.7; // NOLINT: calibrated default
+};                           // AdaptiveThresholds
+
+// A priority queue that watches its own size and operation mix and moves
+// its contents between UnorderedFastPQ (small queues), BinaryPQ (everything
+// else) and PairingPQ (queues that are merged often).  Migration empties
+// the old backend with extractAll() and bulk-builds the new one from the
+// range, both O(n).
+// The optional ALLOCATOR is passed on to every backend, and the optional
+// SHRINK policy (see MemoryUsage.hpp) to the vector-backed ones.
+template <typename TYPE, typename COMP_FUNCTOR = std::less<TYPE>,
+          typename ALLOCATOR = std::allocator<TYPE>,
+          typename SHRINK = NeverShrink>
+class AdaptivePQ : public Eecs281PQ<TYPE, COMP_FUNCTOR> {
+  // This is a way to refer to the base class object.
+  using BaseClass = Eecs281PQ<TYPE, COMP_FUNCTOR>;
+
+  using Unordered = UnorderedFastPQ<TYPE, COMP_FUNCTOR, ALLOCATOR, SHRINK>;
+  using Binary = BinaryPQ<TYPE, COMP_FUNCTOR, ALLOCATOR, FlatLayout, SHRINK>;
+  using Pairing = PairingPQ<TYPE, COMP_FUNCTOR, ALLOCATOR>;
+
+public:
+  using allocator_type = ALLOCATOR;
+
+  // The backends, in the order of the variant alternatives.
+  enum class Backend { Unordered, Binary, Pairing };
+
+  // Description: Construct an empty PQ with optional comparison functor,
+  //              allocator and thresholds.
+  // Runtime: O(1)
+  explicit AdaptivePQ(COMP_FUNCTOR comp = COMP_FUNCTOR(),
+                      const ALLOCATOR &alloc = ALLOCATOR(),
+                      AdaptiveThresholds limits = AdaptiveThresholds())
+      : BaseClass{comp}, thresholds{limits},
+        impl{std::in_place_type<Unordered>, comp, alloc} {} // AdaptivePQ()
+
+  // Description: Construct a PQ out of an iterator range with optional
+  //              comparison functor, allocator and thresholds.  The
+  //              backend is chosen from the size of the range.
+  // Runtime: O(n) where n is number of elements in range.
+  template <typename InputIterator>
+  AdaptivePQ(InputIterator start, InputIterator end,
+             COMP_FUNCTOR comp = COMP_FUNCTOR(),
+             const ALLOCATOR &alloc = ALLOCATOR(),
+             AdaptiveThresholds limits = AdaptiveThresholds())
+      : BaseClass{comp}, thresholds{limits},
+        impl{std::in_place_type<Unordered>, start, end, comp, alloc} {
+    if (size() > thresholds.binaryAbove) {
+      migrate(Backend::Binary);
+    } // if
+  }   // AdaptivePQ()
+
+  // Description: Destructor and copy/move constructors don't need any
+  //              code, the backend variant handles them.
+  virtual ~AdaptivePQ() = default;
+  AdaptivePQ(const AdaptivePQ &) = default;
+  AdaptivePQ(AdaptivePQ &&) noexcept = default;
+
+  // Description: Copy assignment operator.  Assigning the variant directly
+  //              would copy-construct a backend of a different kind with
+  //              rhs's allocator, so unless the allocator propagates the
+  //              elements are copied into a backend that uses ours.  The
+  //              comparator comes first: later migrations build with it.
+  // Runtime: O(n)
+  AdaptivePQ &operator=(const AdaptivePQ &rhs) {
+    using Traits = std::allocator_traits<ALLOCATOR>;
+    this->compare = rhs.compare;
+    if constexpr (Traits::propagate_on_container_copy_assignment::value ||
+                  Traits::is_always_equal::value) {
+      impl = rhs.impl;
+    } else {
+      if (this == &rhs) {
+        return *this;
+      } // if
+      AdaptivePQ copy{rhs};
+      rebuild(rhs.backend(), copy.extractAll(), get_allocator());
+    } // if
+    copyStats(rhs);
+    return *this;
+  } // operator=()
+
+  // Description: Move assignment operator.  Takes over rhs's backend when
+  //              the allocator propagates or both compare equal, and moves
+  //              the elements into a backend that uses ours otherwise.
+  // Runtime: O(1), or O(n) for unequal non-propagating allocators.
+  AdaptivePQ &operator=(AdaptivePQ &&rhs) noexcept(
+      std::allocator_traits<ALLOCATOR>::is_always_equal::value) {
+    using Traits = std::allocator_traits<ALLOCATOR>;
+    // Copied, not swapped: rhs's backend still orders with its own.
+    this->compare = rhs.compare;
+    if (Traits::propagate_on_container_move_assignment::value ||
+        get_allocator() == rhs.get_allocator()) {
+      impl = std::move(rhs.impl);
+    } else {
+      rebuild(rhs.backend(), rhs.extractAll(), get_allocator());
+    } // if
+    copyStats(rhs);
+    return *this;
+  } // operator=()
+
+  // Description: Rebuild the PQ invariant of the current backend.
+  // Runtime: O(n)
+  virtual void updatePriorities() {
+    std::visit([](auto &pq) { pq.updatePriorities(); }, impl);
+  } // updatePriorities()
+
+  // Description: Add a new element to the PQ.
+  // Runtime: Amortized O(1) while small, O(log(n)) as BinaryPQ, O(1) as
+  //          PairingPQ.
+  virtual void push(const TYPE &val) {
+    pushUncounted(val);
+    countOperation();
+  } // push()
+
+  // Description: Remove the most extreme (defined by 'compare') element
+  //              from the PQ.
+  // Runtime: O(n) while small, O(log(n)) (amortized for PairingPQ)
+  //          otherwise.
+  virtual void pop() {
+    std::visit([](auto &pq) { pq.pop(); }, impl);
+    // PairingPQ is left only when merges become rare, see countOperation().
+    if (backend() == Backend::Binary && size() < thresholds.unorderedBelow) {
+      migrate(Backend::Unordered);
+    } // if
+    countOperation();
+  } // pop()
+
+  // Description: Remove the most extreme element and add 'val', using the
+  //              current backend's replaceTop().  The size does not change,
+  //              so no size-driven migration is needed.
+  // Runtime: That of the current backend's replaceTop().
+  virtual void replaceTop(const TYPE &val) {
+    std::visit([&val](auto &pq) { pq.replaceTop(val); }, impl);
+    countOperation();
+  } // replaceTop()
+
+  // Description: Add 'val', then remove and return the most extreme
+  //              element, using the current backend's pushPop().
+  // Runtime: That of the current backend's pushPop().
+  virtual TYPE pushPop(const TYPE &val) {
+    TYPE result =
+        std::visit([&val](auto &pq) { return pq.pushPop(val); }, impl);
+    countOperation();
+    return result;
+  } // pushPop()
+
+  // Description: Return the most extreme (defined by 'compare') element of
+  //              the PQ.
+  // Runtime: O(n) while small, O(1) otherwise.
+  virtual const TYPE &top() const {
+    return std::visit([](const auto &pq) -> const TYPE & { return pq.top(); },
+                      impl);
+  } // top()
+
+  // Description: Get the number of elements in the PQ.
+  // Runtime: O(1)
+  [[nodiscard]] virtual std::size_t size() const {
+    return std::visit([](const auto &pq) { return pq.size(); }, impl);
+  } // size()
+
+  // Description: Return true if the PQ is empty.
+  // Runtime: O(1)
+  [[nodiscard]] virtual bool empty() const {
+    return std::visit([](const auto &pq) { return pq.empty(); }, impl);
+  } // empty()
+
+  // Description: Move every element of 'other' into this PQ, leaving
+  //              'other' empty.  When both are PairingPQs with allocators
+  //              that compare equal this is a single meld; frequent merges
+  //              make this PQ move to PairingPQ.  Otherwise the elements
+  //              are pushed one by one into our own backend.
+  // Runtime: O(1) as PairingPQ, O(m log(n + m)) otherwise.
+  void merge(AdaptivePQ &other) {
+    if (&other == this) {
+      return;
+    } // if
+    ++mergesInWindow;
+    if (auto *mine = std::get_if<Pairing>(&impl)) {
+      auto *theirs = std::get_if<Pairing>(&other.impl);
+      if (theirs != nullptr &&
+          mine->get_allocator() == theirs->get_allocator()) {
+        mine->merge(*theirs);
+        countOperation();
+        return;
+      } // if
+    }   // if
+    auto moved = std::visit([](auto &pq) { return pq.extractAll(); },
+                            other.impl);
+    for (const auto &val : moved) {
+      pushUncounted(val);
+    } // for ..val
+    countOperation();
+  } // merge()
+
+  // Description: Remove every element for which 'pred' returns true, using
+  //              the current backend's eraseIf(), and move to the unordered
+  //              backend if few elements are left.  Returns the number
+  //              removed.
+  // Runtime: O(n)
+  template <typename PREDICATE> std::size_t eraseIf(PREDICATE pred) {
+    std::size_t erased =
+        std::visit([&pred](auto &pq) { return pq.eraseIf(pred); }, impl);
+    if (backend() == Backend::Binary && size() < thresholds.unorderedBelow) {
+      migrate(Backend::Unordered);
+    } // if
+    countOperation();
+    return erased;
+  } // eraseIf()
+
+  // Description: Empty the PQ, writing its elements to 'out' with the most
+  //              extreme first, using the current backend's drainSorted().
+  // Runtime: That of the current backend's drainSorted().
+  template <typename OutputIterator>
+  OutputIterator drainSorted(OutputIterator out) {
+    return std::visit([&out](auto &pq) { return pq.drainSorted(out); }, impl);
+  } // drainSorted()
+
+  // Description: Empty the PQ and hand back its elements, in no particular
+  //              order.
+  // Runtime: O(1) or O(n) as PairingPQ.
+  std::vector<TYPE, ALLOCATOR> extractAll() {
+    return std::visit([](auto &pq) { return pq.extractAll(); }, impl);
+  } // extractAll()
+
+  // Description: Which backend currently holds the elements.
+  // Runtime: O(1)
+  Backend backend() const { return static_cast<Backend>(impl.index()); }
+
+  // Description: Number of migrations so far.
+  // Runtime: O(1)
+  std::size_t migrations() const { return migrationCount; }
+
+  // Description: Return a copy of the allocator passed to the backends.
+  // Runtime: O(1)
+  allocator_type get_allocator() const {
+    return std::visit(
+        [](const auto &pq) -> allocator_type { return pq.get_allocator(); },
+        impl);
+  } // get_allocator()
+
+  // Description: Return the bytes held by the current backend.
+  // Runtime: O(1), or O(n) as PairingPQ.
+  [[nodiscard]] MemoryUsage memoryUsage() const {
+    return std::visit([](const auto &pq) { return pq.memoryUsage(); }, impl);
+  } // memoryUsage()
+
+private:
+  AdaptiveThresholds thresholds;
+  std::variant<Unordered, Binary, Pairing> impl;
+  std::size_t opsInWindow = 0;
+  std::size_t mergesInWindow = 0;
+  std::size_t migrationCount = 0;
+
+  // Description: Take over rhs's thresholds and operation counts.
+  void copyStats(const AdaptivePQ &rhs) {
+    thresholds = rhs.thresholds;
+    opsInWindow = rhs.opsInWindow;
+    mergesInWindow = rhs.mergesInWindow;
+    migrationCount = rhs.migrationCount;
+  } // copyStats()
+
+  // Description: push() without counting it as an operation, for merge().
+  void pushUncounted(const TYPE &val) {
+    std::visit([&val](auto &pq) { pq.push(val); }, impl);
+    if (backend() == Backend::Unordered && size() > thresholds.binaryAbove) {
+      migrate(Backend::Binary);
+    } // if
+  }   // pushUncounted()
+
+  // Description: Count one operation, and at the end of each window decide
+  //              from the merge fraction whether PairingPQ should be used.
+  void countOperation() {
+    if (++opsInWindow < thresholds.window) {
+      return;
+    } // if
+    double mergeRate = static_cast<double>(mergesInWindow) /
+                       static_cast<double>(opsInWindow);
+    opsInWindow = 0;
+    mergesInWindow = 0;
+
+    if (backend() != Backend::Pairing && mergeRate >= thresholds.pairingEnter) {
+      migrate(Backend::Pairing);
+    } else if (backend() == Backend::Pairing &&
+               mergeRate < thresholds.pairingLeave) {
+      migrate(size() > thresholds.binaryAbove ? Backend::Binary
+                                              : Backend::Unordered);
+    } // if
+  }   // countOperation()
+
+  // Description: Move all elements into a freshly built backend.
+  // Runtime: O(n)
+  void migrate(Backend target) {
+    if (target == backend()) {
+      return;
+    } // if
+    rebuild(target, extractAll(), get_allocator());
+    ++migrationCount;
+  } // migrate()
+
+  // Description: Replace the backend by a 'target' one bulk-built from
+  //              'elts' with allocator 'alloc'.
+  // Runtime: O(n)
+  template <typename VECTOR>
+  void rebuild(Backend target, VECTOR &&elts, const ALLOCATOR &alloc) {
+    auto first = std::make_move_iterator(elts.begin());
+    auto last = std::make_move_iterator(elts.end());
+    switch (target) {
+    case Backend::Unordered:
+      impl.template emplace<Unordered>(first, last, this->compare, alloc);
+      break;
+    case Backend::Binary:
+      impl.template emplace<Binary>(first, last, this->compare, alloc);
+      break;
+    case Backend::Pairing:
+      impl.template emplace<Pairing>(first, last, this->compare, alloc);
+      break;
+    } // switch
+  }   // rebuild()
+};  // AdaptivePQ
+
+#endif // ADAPTIVEPQ_H
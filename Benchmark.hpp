@@ -0,0 +1,215 @@
+// Project identifier: 43DE0E0C4C76BFAA6D8C2F5AEAE0518A9C42CF4E
+
+#ifndef BENCHMARK_H
+#define BENCHMARK_H
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory_resource>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "AdaptivePQ.hpp"
+#include "BinaryPQ.hpp"
+#include "CompactPairingPQ.hpp"
+#include "MinMaxPQ.hpp"
+#include "PairingPQ.hpp"
+#include "PersistentPQ.hpp"
+#include "SequenceHeapPQ.hpp"
+#include "SortedPQ.hpp"
+#include "UnorderedFastPQ.hpp"
+#include "UnorderedPQ.hpp"
+
+// Shared helpers for the bench*.cpp drivers: choosing a PQ implementation
+// by name, timing, and summarizing latency samples.
+
+using BenchClock = std::chrono::steady_clock;
+
+// Description: Seconds elapsed between two clock readings.
+inline double secondsBetween(BenchClock::time_point start,
+                             BenchClock::time_point end) {
+  return std::chrono::duration<double>(end - start).count();
+} // secondsBetween()
+
+// Description: Nanoseconds elapsed between two clock readings.
+inline std::uint64_t nanosBetween(BenchClock::time_point start,
+                                  BenchClock::time_point end) {
+  return static_cast<std::uint64_t>(
+      std::chrono::duration_cast<std::chrono::nanoseconds>(end - start)
+          .count());
+} // nanosBetween()
+
+// The names accepted by visitPQ(), in menu order.
+inline const std::vector<std::string> &pqNames() {
+  static const std::vector<std::string> names{
+      "unordered", "unorderedfast", "sorted",   "binary",
+      "bheap",     "bottomup",      "pairing",  "compactpairing",
+      "minmax",    "adaptive",      "persistent", "sequence",
+  };
+  return names;
+} // pqNames()
+
+// Description: Return true for implementations whose push or pop is O(n),
+//              so drivers can skip them at sizes where a run would take
+//              hours.
+inline bool isLinearPQ(const std::string &name) {
+  return name == "unordered" || name == "unorderedfast" || name == "sorted";
+} // isLinearPQ()
+
+// Description: Construct an empty PQ of the implementation called 'name'
+//              and call 'func' with it.  The concrete type is passed, so
+//              calls in 'func' can be devirtualized; use an
+//              Eecs281PQ<TYPE, COMP_FUNCTOR> & parameter to force virtual
+//              dispatch instead.  Returns false for an unknown name.
+template <typename TYPE, typename COMP_FUNCTOR, typename FUNC>
+bool visitPQ(const std::string &name, FUNC &&func,
+             COMP_FUNCTOR comp = COMP_FUNCTOR()) {
+  if (name == "unordered") {
+    UnorderedPQ<TYPE, COMP_FUNCTOR> pq{comp};
+    func(pq);
+  } else if (name == "unorderedfast") {
+    UnorderedFastPQ<TYPE, COMP_FUNCTOR> pq{comp};
+    func(pq);
+  } else if (name == "sorted") {
+    SortedPQ<TYPE, COMP_FUNCTOR> pq{comp};
+    func(pq);
+  } else if (name == "binary") {
+    BinaryPQ<TYPE, COMP_FUNCTOR> pq{comp};
+    func(pq);
+  } else if (name == "bheap") {
+    BinaryPQ<TYPE, COMP_FUNCTOR, std::allocator<TYPE>, BHeapLayout<>> pq{comp};
+    func(pq);
+  } else if (name == "bottomup") {
+    BinaryPQ<TYPE, COMP_FUNCTOR, std::allocator<TYPE>, FlatLayout, NeverShrink,
+             BottomUpSift>
+        pq{comp};
+    func(pq);
+  } else if (name == "pairing") {
+    PairingPQ<TYPE, COMP_FUNCTOR> pq{comp};
+    func(pq);
+  } else if (name == "compactpairing") {
+    CompactPairingPQ<TYPE, COMP_FUNCTOR> pq{comp};
+    func(pq);
+  } else if (name == "minmax") {
+    MinMaxPQ<TYPE, COMP_FUNCTOR> pq{comp};
+    func(pq);
+  } else if (name == "adaptive") {
+    AdaptivePQ<TYPE, COMP_FUNCTOR> pq{comp};
+    func(pq);
+  } else if (name == "persistent") {
+    PersistentPQ<TYPE, COMP_FUNCTOR> pq{comp};
+    func(pq);
+  } else if (name == "sequence") {
+    SequenceHeapPQ<TYPE, COMP_FUNCTOR> pq{comp};
+    func(pq);
+  } else {
+    return false;
+  } // if
+  return true;
+} // visitPQ()
+
+// A memory resource that forwards to another one (by default global new)
+// and keeps track of the bytes currently allocated and the peak.  Pass it
+// to a pmr PQ to measure the PQ's own footprint, including vector slack
+// and per-node allocations.
+class CountingResource : public std::pmr::memory_resource {
+public:
+  explicit CountingResource(
+      std::pmr::memory_resource *upstream = std::pmr::new_delete_resource())
+      : upstream{upstream} {}
+
+  // Description: Bytes currently allocated through this resource.
+  std::size_t current() const { return currentBytes; }
+
+  // Description: Most bytes allocated at once since the last resetPeak().
+  std::size_t peak() const { return peakBytes; }
+
+  // Description: Start a new peak measurement from the current usage.
+  void resetPeak() { peakBytes = currentBytes; }
+
+  // Description: Number of allocate() calls so far.
+  std::size_t allocations() const { return allocationCount; }
+
+private:
+  std::pmr::memory_resource *upstream;
+  std::size_t currentBytes = 0;
+  std::size_t peakBytes = 0;
+  std::size_t allocationCount = 0;
+
+  void *do_allocate(std::size_t bytes, std::size_t alignment) override {
+    void *ptr = upstream->allocate(bytes, alignment);
+    currentBytes += bytes;
+    peakBytes = std::max(peakBytes, currentBytes);
+    ++allocationCount;
+    return ptr;
+  } // do_allocate()
+
+  void do_deallocate(void *ptr, std::size_t bytes,
+                     std::size_t alignment) override {
+    upstream->deallocate(ptr, bytes, alignment);
+    currentBytes -= bytes;
+  } // do_deallocate()
+
+  bool do_is_equal(const std::pmr::memory_resource &other) const
+      noexcept override {
+    return this == &other;
+  } // do_is_equal()
+};  // CountingResource
+
+// Percentiles of a set of latency samples, in nanoseconds.
+struct LatencySummary {
+  std::uint64_t p50 = 0;
+  std::uint64_t p90 = 0;
+  std::uint64_t p99 = 0;
+  std::uint64_t p999 = 0;
+  std::uint64_t max = 0;
+}; // LatencySummary
+
+// Description: Summarize latency samples.  The samples are reordered.
+// Runtime: O(n)
+inline LatencySummary summarizeLatencies(std::vector<std::uint64_t> &samples) {
+  LatencySummary summary;
+  if (samples.empty()) {
+    return summary;
+  } // if
+  auto at = [&samples](double fraction) {
+    auto idx = static_cast<std::size_t>(
+        fraction * static_cast<double>(samples.size() - 1));
+    std::nth_element(samples.begin(),
+                     samples.begin() + static_cast<std::ptrdiff_t>(idx),
+                     samples.end());
+    return samples[idx];
+  };
+  summary.p50 = at(0.5);   // NOLINT: percentile
+  summary.p90 = at(0.9);   // NOLINT: percentile
+  summary.p99 = at(0.99);  // NOLINT: percentile
+  summary.p999 = at(0.999); // NOLINT: percentile
+  summary.max = *std::max_element(samples.begin(), samples.end());
+  return summary;
+} // summarizeLatencies()
+
+// Description: Split a comma-separated command line list.
+inline std::vector<std::string> splitList(const std::string &list) {
+  std::vector<std::string> items;
+  std::istringstream iss{list};
+  std::string item;
+  while (std::getline(iss, item, ',')) {
+    items.push_back(item);
+  } // while
+  return items;
+} // splitList()
+
+// Description: Powers of ten from 'from' to 'to' inclusive, e.g. the
+//              steady-state sizes 1e2 ... 1e7.
+inline std::vector<std::size_t> powersOfTen(std::size_t from, std::size_t to) {
+  std::vector<std::size_t> sizes;
+  for (std::size_t n = from; n <= to; n *= 10) { // NOLINT: decades
+    sizes.push_back(n);
+  } // for ..n
+  return sizes;
+} // powersOfTen()
+
+#endif // BENCHMARK_H
@@ -5,30 +5,75 @@
 
 #include <algorithm>
 #include <cstddef>
+#include <memory>
+#include <memory_resource>
+#include <type_traits>
 
 #include "Eecs281PQ.hpp"
+#include "HeapLayout.hpp"
+#include "MemoryUsage.hpp"
+
+// Sift policies for BinaryPQ's SIFT parameter: how fixDown() (used by
+// pop(), replaceTop(), heapify and heapsort) moves an element down.
+//
+// TopDownSift compares the two children and then the element against the
+// winner, about 2 comparisons per level, and stops as soon as the element
+// fits.  It is the better choice for cheap comparisons.
+struct TopDownSift {
+  static constexpr bool bottomUp = false;
+}; // TopDownSift
+
+// BottomUpSift (Wegener's bottom-up heapsort, after Floyd) first moves the
+// hole all the way to a leaf along the more extreme children, 1 comparison
+// per level, then sifts the element back up from there.  An element taken
+// from the bottom of the heap (as in pop()) almost always belongs near the
+// bottom again, so the climb is short: about log(n) + O(1) comparisons in
+// total instead of 2 log(n).  It pays off when comparisons are expensive,
+// e.g. strings or keys behind pointers; compare with benchSift.
+struct BottomUpSift {
+  static constexpr bool bottomUp = true;
+}; // BottomUpSift
 
 // A specialized version of the priority queue ADT implemented as a binary heap.
-template <typename TYPE, typename COMP_FUNCTOR = std::less<TYPE>>
+// The optional ALLOCATOR is used for the underlying data vector, and the
+// optional LAYOUT (see HeapLayout.hpp) decides where in it each node of the
+// tree is stored.  The optional SHRINK policy (see MemoryUsage.hpp) decides
+// when pop() and eraseIf() give the vector's capacity back, and the optional
+// SIFT policy (above) how elements are moved down.
+// In C++20 builds the members marked PQ_CONSTEXPR (see Eecs281PQ.hpp) can
+// run at compile time, with any LAYOUT and SIFT but only the default
+// SHRINK policy.
+template <typename TYPE, typename COMP_FUNCTOR = std::less<TYPE>,
+          typename ALLOCATOR = std::allocator<TYPE>,
+          typename LAYOUT = FlatLayout, typename SHRINK = NeverShrink,
+          typename SIFT = TopDownSift>
 class BinaryPQ : public Eecs281PQ<TYPE, COMP_FUNCTOR> {
   // This is a way to refer to the base class object.
   using BaseClass = Eecs281PQ<TYPE, COMP_FUNCTOR>;
+  using Layout = typename LAYOUT::template Index<TYPE>;
 
 public:
-  // Description: Construct an empty PQ with an optional comparison functor.
+  using allocator_type = ALLOCATOR;
+
+  // Description: Construct an empty PQ with an optional comparison functor
+  //              and allocator.
   // Runtime: O(1)
-  explicit BinaryPQ(COMP_FUNCTOR comp = COMP_FUNCTOR()) : BaseClass{comp} {
+  PQ_CONSTEXPR explicit BinaryPQ(COMP_FUNCTOR comp = COMP_FUNCTOR(),
+                    const ALLOCATOR &alloc = ALLOCATOR())
+      : BaseClass{comp}, data(alloc) {
     // TODO: Implement this function, or verify that it is already done
   } // BinaryPQ
 
   // Description: Construct a PQ out of an iterator range with an optional
-  //              comparison functor.
+  //              comparison functor and allocator.
   // Runtime: O(n) where n is number of elements in range.
   template <typename InputIterator>
-  BinaryPQ(InputIterator start, InputIterator end,
-           COMP_FUNCTOR comp = COMP_FUNCTOR())
-      : BaseClass{comp}, data{start, end} {
+  PQ_CONSTEXPR BinaryPQ(InputIterator start, InputIterator end,
+           COMP_FUNCTOR comp = COMP_FUNCTOR(),
+           const ALLOCATOR &alloc = ALLOCATOR())
+      : BaseClass{comp}, data(start, end, alloc) {
     // TODO: Implement this function
+    addPadding();
     updatePriorities();
   } // BinaryPQ
 
@@ -49,110 +94,412 @@ public:
   // Description: Assumes that all elements inside the heap are out of order and
   //              'rebuilds' the heap by fixing the heap invariant.
   // Runtime: O(n)
-  virtual void updatePriorities() {
+  PQ_CONSTEXPR virtual void updatePriorities() {
     // TODO: Implement this function.
     if (data.empty())
       return;
-    for (size_t i = (size_t)data.size() / 2; i-- > 0;) {
-      fixDown(i);
+    for (size_t i = Layout::heapifyFrom(data.size()); i-- > Layout::root;) {
+      if (!Layout::isPadding(i)) {
+        fixDown(i);
+      }
     }
   } // updatePriorities()
 
   // Description: Add a new element to the PQ.
   // Runtime: O(log(n))
-  virtual void push(const TYPE &val) {
+  PQ_CONSTEXPR virtual void push(const TYPE &val) {
     // TODO: Implement this function.
+    // A new page starts with a padding slot.
+    while (data.size() + 1 < Layout::slots(size() + 1)) {
+      data.push_back(val);
+    }
     data.push_back(val);
     fixUp(data.size() - 1);
   } // push()
 
+  // Description: Add every element of a range, as a batch.  Floyd's
+  //              heapify costs O(n + k) whatever the order of the k new
+  //              elements, while k fixUps cost O(k) on random input but
+  //              O(k log(n)) when the new elements rise to the top, so the
+  //              heap is rebuilt once the batch is as large as the heap,
+  //              and each new element is fixed up otherwise.
+  // Runtime: O(k log(n)) if k < n, O(n + k) otherwise.
+  template <typename InputIterator>
+  PQ_CONSTEXPR void pushRange(InputIterator start, InputIterator end) {
+    size_t before = size();
+    size_t first = data.size();
+    for (; start != end; ++start) {
+      const TYPE &val = *start;
+      while (data.size() + 1 < Layout::slots(size() + 1)) {
+        data.push_back(val);
+      }
+      data.push_back(val);
+    }
+    if (size() - before >= before) {
+      updatePriorities();
+      return;
+    }
+    for (size_t i = first; i < data.size(); ++i) {
+      if (!Layout::isPadding(i)) {
+        fixUp(i);
+      }
+    }
+  } // pushRange()
+
   // Description: Remove the most extreme (defined by 'compare') element
   //              from the PQ.
   // Note: We will not run tests on your code that would require it to pop
   // an element when the PQ is empty. Though you are welcome to if you are
   // familiar with them, you do not need to use exceptions in this project.
   // Runtime: O(log(n))
-  virtual void pop() {
+  PQ_CONSTEXPR virtual void pop() {
     // TODO: Implement this function.
-    std::swap(data[0], data[data.size() - 1]);
+    std::swap(data[Layout::root], data.back());
     data.pop_back();
-    fixDown(0);
+    // Drop the padding slot when the last page becomes empty.
+    while (data.size() > Layout::slots(size())) {
+      data.pop_back();
+    }
+    fixDown(Layout::root);
+    SHRINK::apply(data);
   } // pop()
 
+  // Description: Replace the most extreme element with 'val' and restore
+  //              the heap with a single fixDown, instead of a pop() followed
+  //              by a push().
+  // Runtime: O(log(n))
+  PQ_CONSTEXPR virtual void replaceTop(const TYPE &val) {
+    data[Layout::root] = val;
+    fixDown(Layout::root);
+  } // replaceTop()
+
+  // Description: Add 'val', then remove and return the most extreme
+  //              element, with one fixDown, or none when 'val' would be the
+  //              most extreme.
+  // Runtime: O(1) if 'val' would be the most extreme, O(log(n)) otherwise.
+  PQ_CONSTEXPR virtual TYPE pushPop(const TYPE &val) {
+    if (data.empty() || !this->compare(val, data[Layout::root])) {
+      return val;
+    }
+    TYPE result = std::move(data[Layout::root]);
+    data[Layout::root] = val;
+    fixDown(Layout::root);
+    return result;
+  } // pushPop()
+
+  // Description: Empty the PQ and hand back its elements, in no particular
+  //              order, e.g. to bulk-build another PQ from them.
+  // Runtime: O(1)
+  PQ_CONSTEXPR std::vector<TYPE, ALLOCATOR> extractAll() {
+    removePadding();
+    std::vector<TYPE, ALLOCATOR> result{std::move(data)};
+    data.clear();
+    return result;
+  } // extractAll()
+
+  // Description: Remove every element for which 'pred' returns true, in
+  //              one pass over the data, then rebuild the heap bottom-up.
+  //              Returns the number removed.
+  // Runtime: O(n)
+  template <typename PREDICATE>
+  PQ_CONSTEXPR std::size_t eraseIf(PREDICATE pred) {
+    size_t erased = 0;
+    size_t out = Layout::root;
+    for (size_t pos = Layout::root; pos < data.size(); ++pos) {
+      if (Layout::isPadding(pos)) {
+        continue;
+      }
+      if (pred(data[pos])) {
+        ++erased;
+        continue;
+      }
+      // Skip the padding slots on the way out as well.
+      while (Layout::isPadding(out)) {
+        data[out] = data[pos];
+        ++out;
+      }
+      if (out != pos) {
+        data[out] = std::move(data[pos]);
+      }
+      ++out;
+    }
+    if (erased != 0) {
+      // Not 'out': with nothing left, the root page's padding goes too.
+      size_t slots = Layout::slots(size() - erased);
+      data.erase(data.begin() + static_cast<std::ptrdiff_t>(slots), data.end());
+      updatePriorities();
+      SHRINK::apply(data);
+    }
+    return erased;
+  } // eraseIf()
+
+  // Description: Empty the PQ by heapsorting the data vector in place and
+  //              handing it back.  The result is in ascending order (the
+  //              most extreme element last), the same order SortedPQ keeps.
+  // Runtime: O(n log(n))
+  PQ_CONSTEXPR std::vector<TYPE, ALLOCATOR> drainSorted() {
+    for (size_t heapSize = size(); heapSize > 1; --heapSize) {
+      std::swap(data[Layout::root], data[Layout::slots(heapSize) - 1]);
+      fixDown(Layout::root, Layout::slots(heapSize - 1));
+    }
+    removePadding();
+    std::vector<TYPE, ALLOCATOR> result{std::move(data)};
+    data.clear();
+    return result;
+  } // drainSorted()
+
+  // Description: Empty the PQ, writing its elements to 'out' with the most
+  //              extreme first.  Returns the output iterator one past the
+  //              last element written.
+  // Runtime: O(n log(n))
+  template <typename OutputIterator>
+  PQ_CONSTEXPR OutputIterator drainSorted(OutputIterator out) {
+    std::vector<TYPE, ALLOCATOR> sorted = drainSorted();
+    out = std::move(sorted.rbegin(), sorted.rend(), out);
+    // Keep the capacity, the PQ is likely to be refilled.
+    sorted.clear();
+    data.swap(sorted);
+    return out;
+  } // drainSorted()
+
   // Description: Return the most extreme (defined by 'compare') element of
   //              the PQ. This should be a reference for speed. It MUST
   //              be const because we cannot allow it to be modified, as
   //              that might make it no longer be the most extreme element.
   // Runtime: O(1)
-  virtual const TYPE &top() const {
+  PQ_CONSTEXPR virtual const TYPE &top() const {
     // TODO: Implement this function.
-    return data.front();
+    return data[Layout::root];
     // These lines are present only so that this provided file compiles.
 
   } // top()
 
   // Description: Get the number of elements in the PQ.
   // Runtime: O(1)
-  [[nodiscard]] virtual std::size_t size() const {
+  [[nodiscard]] PQ_CONSTEXPR virtual std::size_t size() const {
     // TODO: Implement this function. Might be very simple,
     // depending on your implementation.
-    return data.size(); // TODO: Delete or change this line
-  }                     // size()
+    return Layout::count(data.size()); // TODO: Delete or change this line
+  }                                    // size()
 
   // Description: Return true if the PQ is empty.
   // Runtime: O(1)
-  [[nodiscard]] virtual bool empty() const {
+  [[nodiscard]] PQ_CONSTEXPR virtual bool empty() const {
     // TODO: Implement this function. Might be very simple,
     // depending on your implementation.
     return data.empty(); // TODO: Delete or change this line
   }                      // empty()
 
+  // Description: Return a copy of the allocator used by the data vector.
+  // Runtime: O(1)
+  PQ_CONSTEXPR allocator_type get_allocator() const {
+    return data.get_allocator();
+  }
+
+  // Description: Return the bytes held for elements, for the vector's
+  //              allocation and its padding slots, and in unused capacity.
+  // Runtime: O(1)
+  [[nodiscard]] MemoryUsage memoryUsage() const {
+    return vectorMemoryUsage(data, size());
+  } // memoryUsage()
+
 private:
   // Note: This vector *must* be used for your PQ implementation.
-  std::vector<TYPE> data;
+  std::vector<TYPE, ALLOCATOR> data;
   // NOTE: You are not allowed to add any member variables. You don't need
   //       a "heapSize", since you can call your own size() member
   //       function, or check data.size().
 
   // TODO: Add any additional member functions you require here.
   //       For instance, you might add fixUp() and fixDown().
-  void fixDown(size_t k) {
+  PQ_CONSTEXPR void fixDown(size_t k) { fixDown(k, data.size()); }
+
+  // Description: fixDown() restricted to the first 'heapSlots' slots of
+  //              data, so that heapsort can use the tail as sorted output.
+  PQ_CONSTEXPR void fixDown(size_t k, size_t heapSlots) {
+    if constexpr (SIFT::bottomUp) {
+      fixDownBottomUp(k, heapSlots);
+      return;
+    } else if constexpr (std::is_trivially_copyable_v<TYPE>) {
+      fixDownBranchless(k, heapSlots);
+      return;
+    }
     size_t current = k;
     while (true) {
-      size_t leftChild = 2 * current + 1;
-      size_t rightChild = 2 * current + 2;
+      size_t best = Layout::firstChild(current);
+      if (best >= heapSlots) {
+        break;
+      }
+      size_t secondChild = Layout::secondChild(current);
+      if (secondChild < heapSlots &&
+          this->compare(data[best], data[secondChild])) {
+        best = secondChild;
+      }
+      if (!this->compare(data[current], data[best])) {
+        break;
+      }
+      std::swap(data[current], data[best]);
+      current = best;
+    }
+  }
 
-      if (leftChild >= data.size()) {
+  // Description: fixDown() for cheap, trivially copyable keys.  Instead of
+  //              swapping at every level it moves a hole down and writes
+  //              the sifted value once.  The more extreme child is picked
+  //              arithmetically (the compiler emits a cmov, not a branch),
+  //              nodes missing their second child (only near the end of
+  //              the heap) are handled after the loop, and the
+  //              grandchildren are prefetched while the children are
+  //              compared.
+  PQ_CONSTEXPR void fixDownBranchless(size_t k, size_t heapSlots) {
+    if (k >= heapSlots) {
+      return;
+    }
+    TYPE *heap = data.data();
+    const TYPE val = heap[k];
+    size_t current = k;
+    // Every node visited in this loop has two children.
+    while (Layout::secondChild(current) < heapSlots) {
+      size_t child = Layout::firstChild(current);
+      size_t secondChild = Layout::secondChild(current);
+      prefetchChildren(heap, child, heapSlots);
+      if constexpr (Layout::padded) {
+        // Below a page's leaves the children are in different pages.
+        prefetchChildren(heap, secondChild, heapSlots);
+      }
+      // A multiply rather than ?:, so the compiler cannot turn the
+      // selection back into a branch; with the flat layout the distance
+      // is 1 and it becomes an add.
+      child += static_cast<size_t>(
+                   this->compare(heap[child], heap[secondChild])) *
+               (secondChild - child);
+      if (!this->compare(val, heap[child])) {
+        heap[current] = val;
+        return;
+      }
+      heap[current] = heap[child];
+      current = child;
+    }
+    // With the flat layout only the last internal node can have a single
+    // child, and that child is a leaf.  In a B-heap a page root whose
+    // sibling page has not been started yet can still have a subtree.
+    while (Layout::firstChild(current) < heapSlots) {
+      size_t child = Layout::firstChild(current);
+      size_t secondChild = Layout::secondChild(current);
+      if (secondChild < heapSlots &&
+          this->compare(heap[child], heap[secondChild])) {
+        child = secondChild;
+      }
+      if (!this->compare(val, heap[child])) {
         break;
       }
-      if (rightChild >= data.size()) {
-        if (this->compare(data[current], data[leftChild])) {
-          std::swap(data[current], data[leftChild]);
-        }
+      heap[current] = heap[child];
+      current = child;
+    }
+    heap[current] = val;
+  }
+
+  // Description: fixDown() for BottomUpSift.  The hole left by the element
+  //              at 'k' descends to a leaf, taking the more extreme child
+  //              at each level with one comparison (picked arithmetically,
+  //              as in fixDownBranchless()).  The element is then sifted up
+  //              from that leaf, but not above 'k'.
+  PQ_CONSTEXPR void fixDownBottomUp(size_t k, size_t heapSlots) {
+    if (k >= heapSlots) {
+      return;
+    }
+    TYPE *heap = data.data();
+    TYPE val = std::move(heap[k]);
+    size_t hole = k;
+    while (Layout::secondChild(hole) < heapSlots) {
+      size_t child = Layout::firstChild(hole);
+      size_t secondChild = Layout::secondChild(hole);
+      prefetchChildren(heap, child, heapSlots);
+      if constexpr (Layout::padded) {
+        prefetchChildren(heap, secondChild, heapSlots);
+      }
+      child += static_cast<size_t>(
+                   this->compare(heap[child], heap[secondChild])) *
+               (secondChild - child);
+      heap[hole] = std::move(heap[child]);
+      hole = child;
+    }
+    // A node with only its first child; see fixDownBranchless().
+    while (Layout::firstChild(hole) < heapSlots) {
+      size_t child = Layout::firstChild(hole);
+      size_t secondChild = Layout::secondChild(hole);
+      if (secondChild < heapSlots &&
+          this->compare(heap[child], heap[secondChild])) {
+        child = secondChild;
+      }
+      heap[hole] = std::move(heap[child]);
+      hole = child;
+    }
+    while (hole != k) {
+      size_t parent = Layout::parent(hole);
+      if (!this->compare(heap[parent], val)) {
         break;
       }
-      if (this->compare(data[leftChild], data[rightChild])) {
-        if (this->compare(data[current], data[rightChild])) {
-          std::swap(data[current], data[rightChild]);
-          current = rightChild;
-        } else {
-          break;
+      heap[hole] = std::move(heap[parent]);
+      hole = parent;
+    }
+    heap[hole] = std::move(val);
+  }
+
+  // Description: Hint that the children of the node in slot 'pos' will be
+  //              read soon.  A no-op on compilers without
+  //              __builtin_prefetch, and at compile time.
+  static PQ_CONSTEXPR void prefetchChildren([[maybe_unused]] const TYPE *heap,
+                                            [[maybe_unused]] size_t pos,
+                                            [[maybe_unused]] size_t heapSlots) {
+#if defined(__GNUC__) || defined(__clang__)
+#if PQ_HAS_CONSTEXPR
+    if (std::is_constant_evaluated()) {
+      return;
+    }
+#endif
+    size_t child = Layout::firstChild(pos);
+    if (child < heapSlots) {
+      __builtin_prefetch(heap + child);
+    }
+#endif
+  }
+
+  // Description: Spread the elements of data, given one per slot, over the
+  //              slots of a paged layout.  Padding slots get a copy of the
+  //              next element, so TYPE need not be default constructible.
+  PQ_CONSTEXPR void addPadding() {
+    if constexpr (Layout::padded) {
+      std::vector<TYPE, ALLOCATOR> spread(data.get_allocator());
+      spread.reserve(Layout::slots(data.size()));
+      for (auto &val : data) {
+        if (Layout::isPadding(spread.size())) {
+          spread.push_back(val);
         }
-      } else {
-        if (this->compare(data[current], data[leftChild])) {
-          std::swap(data[current], data[leftChild]);
-          current = leftChild;
-        } else {
-          break;
+        spread.push_back(std::move(val));
+      }
+      data.swap(spread);
+    }
+  }
+
+  // Description: Move the elements to the front of data, in slot order,
+  //              dropping the padding slots of a paged layout.
+  PQ_CONSTEXPR void removePadding() {
+    if constexpr (Layout::padded) {
+      size_t out = 0;
+      for (size_t pos = 0; pos < data.size(); ++pos) {
+        if (!Layout::isPadding(pos)) {
+          data[out++] = std::move(data[pos]);
         }
       }
+      data.erase(data.begin() + static_cast<std::ptrdiff_t>(out), data.end());
     }
   }
 
-  void fixUp(size_t k) {
+  PQ_CONSTEXPR void fixUp(size_t k) {
     size_t current = k;
-    while (current > 0) {
-      size_t parent = (current - 1) / 2;
+    while (current > Layout::root) {
+      size_t parent = Layout::parent(current);
       if (this->compare(data[current], data[parent])) {
         break;
       } else {
@@ -163,4 +510,14 @@ private:
   }
 }; // BinaryPQ
 
+namespace pmr {
+// A BinaryPQ whose storage comes from a std::pmr::memory_resource.
+template <typename TYPE, typename COMP_FUNCTOR = std::less<TYPE>,
+          typename LAYOUT = FlatLayout, typename SHRINK = NeverShrink,
+          typename SIFT = TopDownSift>
+using BinaryPQ =
+    ::BinaryPQ<TYPE, COMP_FUNCTOR, std::pmr::polymorphic_allocator<TYPE>,
+               LAYOUT, SHRINK, SIFT>;
+} // namespace pmr
+
 #endif // BINARYPQ_H
@@ -0,0 +1,494 @@
+// Project identifier: 43DE0E0C4C76BFAA6D8C2F5AEAE0518A9C42CF4E
+
+#ifndef COMPACTPAIRINGPQ_H
+#define COMPACTPAIRINGPQ_H
+
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <memory_resource>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "Eecs281PQ.hpp"
+#include "MemoryUsage.hpp"
+
+// A pairing heap like PairingPQ, but with its nodes in one contiguous
+// array, linked by 32-bit indices instead of pointers.  With an int
+// element a node is 16 bytes instead of PairingPQ's 32 plus malloc's
+// header, and melds walk one array instead of scattered allocations.
+// Freed nodes are kept on a free list, threaded through their sibling
+// links, and reused by later pushes; the array never shrinks, so that
+// handles stay valid.  At most 2^32 - 1 elements fit.
+// The array is obtained from the optional ALLOCATOR, rebound to Slot.
+template <typename TYPE, typename COMP_FUNCTOR = std::less<TYPE>,
+          typename ALLOCATOR = std::allocator<TYPE>>
+class CompactPairingPQ : public Eecs281PQ<TYPE, COMP_FUNCTOR> {
+  // This is a way to refer to the base class object.
+  using BaseClass = Eecs281PQ<TYPE, COMP_FUNCTOR>;
+  using Index = std::uint32_t;
+
+  // The link that points nowhere.
+  static constexpr Index kNone = std::numeric_limits<Index>::max();
+
+public:
+  using allocator_type = ALLOCATOR;
+
+  // Refers to an element added with addNode(), for updateElt() and
+  // getElt().  It is only an index, so it is as cheap to store as the
+  // index itself, and it stays valid in copies of the heap.  It becomes
+  // invalid when its element is popped or erased.
+  class Handle {
+  public:
+    // Description: A handle that refers to no element.
+    Handle() = default;
+
+    // Description: The handle's slot in the node array, e.g. to keep
+    //              handles in a 32-bit side table.
+    [[nodiscard]] std::uint32_t index() const { return idx; }
+
+    friend bool operator==(Handle lhs, Handle rhs) {
+      return lhs.idx == rhs.idx;
+    } // operator==()
+    friend bool operator!=(Handle lhs, Handle rhs) { return !(lhs == rhs); }
+
+    friend CompactPairingPQ;
+
+  private:
+    explicit Handle(Index index) : idx{index} {}
+
+    Index idx = kNone;
+  }; // Handle
+
+  // Description: Construct an empty heap with an optional comparison
+  //              functor and allocator.
+  // Runtime: O(1)
+  explicit CompactPairingPQ(COMP_FUNCTOR comp = COMP_FUNCTOR(),
+                            const ALLOCATOR &alloc = ALLOCATOR())
+      : BaseClass{comp}, slots(SlotAllocator(alloc)) {} // CompactPairingPQ()
+
+  // Description: Construct a heap out of an iterator range with an
+  //              optional comparison functor and allocator.
+  // Runtime: O(n) where n is number of elements in range.
+  template <typename InputIterator>
+  CompactPairingPQ(InputIterator start, InputIterator end,
+                   COMP_FUNCTOR comp = COMP_FUNCTOR(),
+                   const ALLOCATOR &alloc = ALLOCATOR())
+      : BaseClass{comp}, slots(SlotAllocator(alloc)) {
+    for (; start != end; ++start) {
+      push(*start);
+    } // for ..start
+  }   // CompactPairingPQ()
+
+  // Copies duplicate the node array as it is, so a Handle of this heap
+  // refers to the same element in the copy.  The allocator is chosen and
+  // propagated the way the standard containers do it.
+  CompactPairingPQ(const CompactPairingPQ &other) = default;
+  CompactPairingPQ &operator=(const CompactPairingPQ &rhs) = default;
+
+  // Description: Move constructor.  Takes over the other heap's array and
+  //              leaves it empty; handles move along with the elements.
+  // Runtime: O(1)
+  CompactPairingPQ(CompactPairingPQ &&other) noexcept
+      : BaseClass{std::move(other)}, slots{std::move(other.slots)},
+        root{std::exchange(other.root, kNone)},
+        freeHead{std::exchange(other.freeHead, kNone)},
+        nodeCount{std::exchange(other.nodeCount, 0)} {} // CompactPairingPQ()
+
+  // Description: Move assignment operator.  The array is moved the way
+  //              std::vector moves it, which copies the elements for
+  //              unequal non-propagating allocators; 'rhs' is left empty
+  //              either way.
+  // Runtime: O(1), or O(capacity) for unequal non-propagating allocators.
+  CompactPairingPQ &operator=(CompactPairingPQ &&rhs) noexcept(
+      std::is_nothrow_move_assignable_v<Slots>) {
+    if (&rhs == this) {
+      return *this;
+    } // if
+    BaseClass::operator=(std::move(rhs));
+    slots = std::move(rhs.slots);
+    rhs.slots.clear();
+    root = std::exchange(rhs.root, kNone);
+    freeHead = std::exchange(rhs.freeHead, kNone);
+    nodeCount = std::exchange(rhs.nodeCount, 0);
+    return *this;
+  } // operator=()
+
+  // Description: Copy constructor that places the copy's nodes in 'alloc'.
+  // Runtime: O(capacity)
+  CompactPairingPQ(const CompactPairingPQ &other, const ALLOCATOR &alloc)
+      : BaseClass{other.compare}, slots(other.slots, SlotAllocator(alloc)),
+        root{other.root}, freeHead{other.freeHead},
+        nodeCount{other.nodeCount} {} // CompactPairingPQ()
+
+  virtual ~CompactPairingPQ() = default;
+
+  // Description: Assumes that all elements inside the heap are out of
+  //              order and rebuilds it by melding every node into the root
+  //              again.  No node moves, so handles stay valid.
+  // Runtime: O(n)
+  virtual void updatePriorities() {
+    if (empty() || slots[root].child == kNone) {
+      return;
+    } // if
+    std::vector<Index> pending{slots[root].child};
+    slots[root].child = kNone;
+    while (!pending.empty()) {
+      Index current = pending.back();
+      pending.pop_back();
+      Slot &slot = slots[current];
+      if (slot.sibling != kNone) {
+        pending.push_back(slot.sibling);
+      } // if
+      if (slot.child != kNone) {
+        pending.push_back(slot.child);
+      } // if
+      slot.parent = kNone;
+      slot.sibling = kNone;
+      slot.child = kNone;
+      root = meld(root, current);
+    } // while
+  }   // updatePriorities()
+
+  // Description: Add a new element to the heap.
+  // Runtime: O(1), amortized for the growth of the array.
+  virtual void push(const TYPE &val) { addNode(val); } // push()
+
+  // Description: Remove the most extreme (defined by 'compare') element
+  //              from the heap; its slot goes on the free list.
+  // Runtime: Amortized O(log(n))
+  virtual void pop() {
+    Index oldRoot = root;
+    root = mergePairs(slots[oldRoot].child);
+    freeSlot(oldRoot);
+    --nodeCount;
+  } // pop()
+
+  // Description: Remove the most extreme element and add 'val' in the same
+  //              slot.  A Handle for the old top now refers to 'val'.
+  // Runtime: Amortized O(log(n))
+  virtual void replaceTop(const TYPE &val) {
+    Index node = root;
+    root = mergePairs(slots[node].child);
+    slots[node].elt = val;
+    slots[node].child = kNone;
+    root = meld(root, node);
+  } // replaceTop()
+
+  // Description: Add 'val', then remove and return the most extreme
+  //              element, reusing the root's slot as replaceTop() does.
+  // Runtime: O(1) if 'val' would be the most extreme, amortized O(log(n))
+  //          otherwise.
+  virtual TYPE pushPop(const TYPE &val) {
+    if (root == kNone || !this->compare(val, slots[root].elt)) {
+      return val;
+    } // if
+    TYPE result = std::move(slots[root].elt);
+    replaceTop(val);
+    return result;
+  } // pushPop()
+
+  // Description: Empty the heap, writing its elements to 'out' with the
+  //              most extreme first.  Each element is moved out of its
+  //              slot.  The array keeps its capacity for later pushes.
+  //              Returns the output iterator one past the last element
+  //              written.
+  // Runtime: O(n log(n)) amortized
+  template <typename OutputIterator>
+  OutputIterator drainSorted(OutputIterator out) {
+    while (root != kNone) {
+      *out = std::move(slots[root].elt);
+      ++out;
+      root = mergePairs(slots[root].child);
+    } // while
+    slots.clear();
+    freeHead = kNone;
+    nodeCount = 0;
+    return out;
+  } // drainSorted()
+
+  // Description: Remove every element for which 'pred' returns true, the
+  //              way PairingPQ::eraseIf() does: each matching node is cut
+  //              from its parent's child list and freed, its children are
+  //              detached as separate trees, and the surviving trees are
+  //              combined with one two-pass pairing.  Handles of removed
+  //              elements become invalid.  Returns the number removed.
+  // Runtime: O(n)
+  template <typename PREDICATE> std::size_t eraseIf(PREDICATE pred) {
+    std::size_t erased = 0;
+    // Trees cut loose from the heap, their roots not yet checked.
+    std::vector<Index> detached;
+    // Surviving nodes whose child lists have not been checked yet.
+    std::vector<Index> kept;
+    // Surviving detached trees, chained through their sibling links.
+    Index survivors = kNone;
+
+    // Cut the children of a removed node loose and free it.
+    auto removeNode = [&](Index node) {
+      for (Index child = slots[node].child; child != kNone;) {
+        Index next = slots[child].sibling;
+        slots[child].parent = kNone;
+        slots[child].sibling = kNone;
+        detached.push_back(child);
+        child = next;
+      } // for ..child
+      freeSlot(node);
+      ++erased;
+    };
+
+    if (root != kNone) {
+      detached.push_back(root);
+    } // if
+    while (!detached.empty() || !kept.empty()) {
+      if (!detached.empty()) {
+        Index tree = detached.back();
+        detached.pop_back();
+        if (pred(slots[tree].elt)) {
+          removeNode(tree);
+        } else {
+          slots[tree].sibling = survivors;
+          survivors = tree;
+          kept.push_back(tree);
+        } // if
+        continue;
+      } // if
+
+      Index parent = kept.back();
+      kept.pop_back();
+      // No slots are added while erasing, so links into the array stay
+      // put.
+      Index *link = &slots[parent].child;
+      while (*link != kNone) {
+        Index child = *link;
+        if (pred(slots[child].elt)) {
+          *link = slots[child].sibling;
+          removeNode(child);
+        } else {
+          kept.push_back(child);
+          link = &slots[child].sibling;
+        } // if
+      }   // while
+    }     // while
+
+    root = mergePairs(survivors);
+    nodeCount -= erased;
+    return erased;
+  } // eraseIf()
+
+  // Description: Return the most extreme (defined by 'compare') element of
+  //              the heap.
+  // Runtime: O(1)
+  virtual const TYPE &top() const { return slots[root].elt; } // top()
+
+  // Description: Get the number of elements in the heap.
+  // Runtime: O(1)
+  [[nodiscard]] virtual std::size_t size() const {
+    return nodeCount;
+  } // size()
+
+  // Description: Return true if the heap is empty.
+  // Runtime: O(1)
+  [[nodiscard]] virtual bool empty() const { return root == kNone; } // empty()
+
+  // Description: Return a copy of the allocator used for the node array.
+  // Runtime: O(1)
+  allocator_type get_allocator() const {
+    return allocator_type(slots.get_allocator());
+  } // get_allocator()
+
+  // Description: Make room for 'count' elements in total, so that pushes
+  //              up to that size do not reallocate the array.
+  // Runtime: O(capacity)
+  void reserve(std::size_t count) {
+    checkCapacity(count);
+    slots.reserve(count);
+  } // reserve()
+
+  // Description: Return the bytes held for elements and for the nodes
+  //              around them.  The links and the allocator's header are
+  //              overhead; free and unused slots are slack, since pushes
+  //              fill them before the array grows.
+  // Runtime: O(1)
+  [[nodiscard]] MemoryUsage memoryUsage() const {
+    MemoryUsage usage;
+    usage.payload = nodeCount * sizeof(TYPE);
+    usage.overhead = nodeCount * (sizeof(Slot) - sizeof(TYPE));
+    usage.slack = (slots.capacity() - nodeCount) * sizeof(Slot);
+    if (slots.capacity() != 0) {
+      usage.overhead += allocationFootprint(slots.capacity() * sizeof(Slot)) -
+                        slots.capacity() * sizeof(Slot);
+    } // if
+    return usage;
+  } // memoryUsage()
+
+  // Description: The element 'handle' refers to.
+  // Runtime: O(1)
+  const TYPE &getElt(Handle handle) const { return slots[handle.idx].elt; }
+
+  // Description: Updates the priority of an element already in the heap by
+  //              replacing the element 'handle' refers to with 'new_value'.
+  //
+  // PRECONDITION: The new priority, given by 'new_value' must be more
+  //              extreme (as defined by comp) than the old priority.
+  //
+  // Runtime: O(number of siblings of the node), amortized O(log(n)).
+  void updateElt(Handle handle, const TYPE &new_value) {
+    Index node = handle.idx;
+    slots[node].elt = new_value;
+    if (node == root) {
+      return;
+    } // if
+    Index parent = slots[node].parent;
+    if (slots[parent].child == node) {
+      slots[parent].child = slots[node].sibling;
+    } else {
+      Index leftMost = slots[parent].child;
+      while (slots[leftMost].sibling != node) {
+        leftMost = slots[leftMost].sibling;
+      } // while
+      slots[leftMost].sibling = slots[node].sibling;
+    } // if
+    slots[node].parent = kNone;
+    slots[node].sibling = kNone;
+    root = meld(root, node);
+  } // updateElt()
+
+  // Description: Add a new element to the heap, and return a Handle for
+  //              it.  Throws std::length_error if the heap already holds
+  //              the most elements 32-bit links can address.
+  // Runtime: O(1), amortized for the growth of the array.
+  Handle addNode(const TYPE &val) {
+    Index node = allocateSlot(val);
+    root = meld(root, node);
+    ++nodeCount;
+    return Handle{node};
+  } // addNode()
+
+private:
+  // One node of the heap: the element and its links, as array indices.
+  struct Slot {
+    TYPE elt;
+    Index child;
+    Index sibling; // the next free slot, while on the free list
+    Index parent;
+  }; // Slot
+
+  using SlotAllocator =
+      typename std::allocator_traits<ALLOCATOR>::template rebind_alloc<Slot>;
+  using Slots = std::vector<Slot, SlotAllocator>;
+
+  // Description: Throw std::length_error if 'count' slots cannot all be
+  //              addressed; kNone is not a valid index.
+  static void checkCapacity(std::size_t count) {
+    if (count > kNone) {
+      throw std::length_error("CompactPairingPQ holds at most 2^32 - 1 "
+                              "elements");
+    } // if
+  }   // checkCapacity()
+
+  // Description: Take a slot from the free list, or a new one at the end
+  //              of the array, and put 'val' in it.
+  // Runtime: O(1), amortized for the growth of the array.
+  Index allocateSlot(const TYPE &val) {
+    if (freeHead != kNone) {
+      Index node = freeHead;
+      Slot &slot = slots[node];
+      slot.elt = val;
+      freeHead = slot.sibling;
+      slot.sibling = kNone;
+      slot.child = kNone;
+      slot.parent = kNone;
+      return node;
+    } // if
+    checkCapacity(slots.size() + 1);
+    // The Slot is built first, in case 'val' lives in the array that
+    // push_back() may reallocate.
+    slots.push_back(Slot{val, kNone, kNone, kNone});
+    return static_cast<Index>(slots.size() - 1);
+  } // allocateSlot()
+
+  // Description: Release the resources of a slot's element and put the
+  //              slot on the free list.
+  // Runtime: O(1)
+  void freeSlot(Index node) {
+    Slot &slot = slots[node];
+    if constexpr (!std::is_trivially_destructible_v<TYPE>) {
+      [[maybe_unused]] TYPE released = std::move(slot.elt);
+    } // if
+    slot.sibling = freeHead;
+    freeHead = node;
+  } // freeSlot()
+
+  // Description: Combine a list of sibling subtrees into one tree with the
+  //              standard two-pass pairing, as PairingPQ::mergePairs()
+  //              does, chaining the pending results through their sibling
+  //              links.
+  // Runtime: O(number of siblings)
+  Index mergePairs(Index first) {
+    Index pending = kNone;
+    while (first != kNone) {
+      Index a = first;
+      Index b = slots[a].sibling;
+      first = (b == kNone) ? kNone : slots[b].sibling;
+      slots[a].parent = kNone;
+      slots[a].sibling = kNone;
+      if (b != kNone) {
+        slots[b].parent = kNone;
+        slots[b].sibling = kNone;
+        a = meld(a, b);
+      } // if
+      slots[a].sibling = pending;
+      pending = a;
+    } // while
+
+    Index result = pending;
+    if (result != kNone) {
+      pending = slots[result].sibling;
+      slots[result].sibling = kNone;
+    } // if
+    while (pending != kNone) {
+      Index next = slots[pending].sibling;
+      slots[pending].sibling = kNone;
+      result = meld(result, pending);
+      pending = next;
+    } // while
+    return result;
+  } // mergePairs()
+
+  // Description: Meld two trees: the root that is less extreme becomes the
+  //              first child of the other.  On a tie 'a' stays the root.
+  // Runtime: O(1)
+  Index meld(Index a, Index b) {
+    if (a == kNone) {
+      return b;
+    } // if
+    if (b == kNone) {
+      return a;
+    } // if
+    if (this->compare(slots[a].elt, slots[b].elt)) {
+      std::swap(a, b);
+    } // if
+    slots[b].parent = a;
+    slots[b].sibling = slots[a].child;
+    slots[a].child = b;
+    return a;
+  } // meld()
+
+  Slots slots;
+  Index root = kNone;
+  Index freeHead = kNone;
+  std::size_t nodeCount = 0;
+}; // CompactPairingPQ
+
+namespace pmr {
+// A CompactPairingPQ whose node array comes from a
+// std::pmr::memory_resource.
+template <typename TYPE, typename COMP_FUNCTOR = std::less<TYPE>>
+using CompactPairingPQ =
+    ::CompactPairingPQ<TYPE, COMP_FUNCTOR,
+                       std::pmr::polymorphic_allocator<TYPE>>;
+} // namespace pmr
+
+#endif // COMPACTPAIRINGPQ_H
@@ -7,6 +7,22 @@
 #include <iterator>
 #include <vector>
 
+// PQ_CONSTEXPR marks the members of the vector-backed PQs (BinaryPQ and
+// SortedPQ) that can also run in a constant expression, e.g. to build a
+// table at compile time.  That needs a constexpr std::vector and constexpr
+// virtual functions, i.e. C++20 (make CXXSTD=c++20); in C++17 builds it
+// expands to nothing, and PQ_HAS_CONSTEXPR is 0.  libstdc++'s checked
+// containers (_GLIBCXX_DEBUG, as in make debug) are not constexpr, so
+// those builds test the runtime path only.
+#if defined(__cpp_lib_constexpr_vector) && __cpp_constexpr >= 201907L && \
+    !defined(_GLIBCXX_DEBUG)
+#define PQ_HAS_CONSTEXPR 1
+#define PQ_CONSTEXPR constexpr
+#else
+#define PQ_HAS_CONSTEXPR 0
+#define PQ_CONSTEXPR
+#endif
+
 // A simple interface that implements a generic priority queue.
 // Runtime specifications assume constant time comparison and copying.
 template<typename TYPE, typename COMP_FUNCTOR = std::less<TYPE>>
@@ -32,6 +48,28 @@ public:
     //              the priority queue.
     virtual const TYPE &top() const = 0;
 
+    // Description: Remove the most extreme element and add 'val', as one
+    //              operation.  The PQ must not be empty.  This default is a
+    //              pop() followed by a push(); derived PQs restore their
+    //              invariant once instead.
+    PQ_CONSTEXPR virtual void replaceTop(const TYPE &val) {
+        pop();
+        push(val);
+    }  // replaceTop()
+
+    // Description: Add 'val', then remove and return the most extreme
+    //              element.  When 'val' would itself be the most extreme
+    //              (or the PQ is empty) it is returned right away and the PQ
+    //              is not touched.
+    PQ_CONSTEXPR virtual TYPE pushPop(const TYPE &val) {
+        if (empty() || !compare(val, top())) {
+            return val;
+        }  // if
+        TYPE result = top();
+        replaceTop(val);
+        return result;
+    }  // pushPop()
+
     // Description: Get the number of elements in the priority queue.
     [[nodiscard]] virtual std::size_t size() const = 0;
 
@@ -50,7 +88,7 @@ protected:
     Eecs281PQ(const Eecs281PQ &) = default;
     Eecs281PQ(Eecs281PQ &&) noexcept = default;
 
-    explicit Eecs281PQ(const COMP_FUNCTOR &comp)
+    PQ_CONSTEXPR explicit Eecs281PQ(const COMP_FUNCTOR &comp)
         : compare { comp } {}
 
     // Note: These data members *must* be used in all of your priority queue
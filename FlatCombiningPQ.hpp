@@ -0,0 +1,257 @@
+// Project identifier: 43DE0E0C4C76BFAA6D8C2F5AEAE0518A9C42CF4E
+
+#ifndef FLATCOMBININGPQ_H
+#define FLATCOMBININGPQ_H
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "Eecs281PQ.hpp"
+#include "RecordingPQ.hpp"
+
+// True when PQ can add a range of elements as one batch (BinaryPQ).
+template <typename PQ, typename = void>
+struct HasPushRange : std::false_type {};
+
+template <typename PQ>
+struct HasPushRange<
+    PQ, std::void_t<decltype(std::declval<PQ &>().pushRange(
+            std::declval<typename PQTypes<PQ>::Type *>(),
+            std::declval<typename PQTypes<PQ>::Type *>()))>>
+    : std::true_type {};
+
+// A PQ of type PQ shared by any number of threads, in exact priority
+// order, by flat combining (Hendler, Incze, Shavit and Tzafrir):
+//
+//   - A thread does not lock the PQ to push or pop.  It claims one of a
+//     fixed set of publication slots, writes its request there, and waits
+//     for the request to be done.
+//   - Whichever waiting thread gets the lock becomes the combiner: it
+//     collects every request published so far and applies the whole batch
+//     to the PQ, while the others keep waiting on their own slot's cache
+//     line instead of on the lock.
+//
+// The requests of a batch are all pending at once, so any order of them
+// is a valid linearization; the combiner picks a cheap one.  Each pop is
+// paired with a push and applied with pushPop(), which hands the pushed
+// element straight back, without touching the PQ, when it would be on top.
+// The pushes left over go in with pushRange() when PQ has it, and the pops
+// left over take the top.  Every pop still gets the most extreme element
+// at its point in that order, as with a single lock.
+//
+// An exception thrown by PQ while combining (out of memory) terminates the
+// program, since other threads' requests of the batch cannot be undone.
+template <typename PQ> class FlatCombiningPQ {
+  using TYPE = typename PQTypes<PQ>::Type;
+
+public:
+  using value_type = TYPE;
+
+  // Passes the combiner makes over the slots while it finds new requests.
+  static constexpr std::size_t kCombinePasses = 4;
+
+  // Description: Share 'inner', with room for 'slots' requests at once.
+  //              More threads than slots is fine: they wait for a free
+  //              one.
+  // Runtime: O(slots)
+  explicit FlatCombiningPQ(PQ inner = PQ(), std::size_t slots = defaultSlots())
+      : pq{std::move(inner)}, publication(std::max<std::size_t>(slots, 1)),
+        count{pq.size()} {
+    pushes.reserve(publication.size());
+    pops.reserve(publication.size());
+    batch.reserve(publication.size());
+  } // FlatCombiningPQ()
+
+  // Description: Waiting threads hold on to the slots, so no copies.
+  FlatCombiningPQ(const FlatCombiningPQ &) = delete;
+  FlatCombiningPQ &operator=(const FlatCombiningPQ &) = delete;
+
+  // Description: Add 'val'.  Safe to call from any thread.
+  // Runtime: O(log(n)) amortized over the batch, plus the wait for it.
+  void push(const TYPE &val) { request(kPush, val); } // push()
+
+  // Description: Remove and return the most extreme element, or nothing if
+  //              the PQ is empty.  Safe to call from any thread.
+  // Runtime: O(log(n)) amortized over the batch, plus the wait for it.
+  std::optional<TYPE> tryPop() {
+    return request(kPop, std::nullopt);
+  } // tryPop()
+
+  // Description: The size after the last batch applied.
+  [[nodiscard]] std::size_t size() const {
+    return count.load(std::memory_order_relaxed);
+  } // size()
+
+  [[nodiscard]] bool empty() const { return size() == 0; } // empty()
+
+  // Description: The shared PQ, for use while no thread is calling push()
+  //              or tryPop().
+  const PQ &inner() const { return pq; }
+
+private:
+  // The states of a slot.  The owner moves it from kFree to kClaimed, and
+  // to kPush or kPop once the request is written; the combiner moves it to
+  // kDone once the result is written; the owner frees it again.
+  enum : std::uint32_t { kFree, kClaimed, kPush, kPop, kDone };
+
+  // Checks of the own slot before a waiting thread yields its time slice.
+  static constexpr unsigned kSpins = 32;
+
+  // A request and its result, on a cache line of its own, so that waiting
+  // threads spin without disturbing each other.
+  struct alignas(64) Slot {
+    std::atomic<std::uint32_t> state{kFree};
+    std::optional<TYPE> value;
+  }; // Slot
+
+  PQ pq;
+  std::vector<Slot> publication;
+  std::atomic<std::size_t> count;
+  std::mutex combining;
+
+  // The combiner's scratch space, used under 'combining' only.
+  std::vector<Slot *> pushes;
+  std::vector<Slot *> pops;
+  std::vector<TYPE> batch;
+
+  // Description: Two slots per hardware thread, and at least 8.
+  static std::size_t defaultSlots() {
+    return std::max<std::size_t>(8, 2 * std::size_t{
+                                        std::thread::hardware_concurrency()});
+  } // defaultSlots()
+
+  // Description: A number per thread, where its search for a free slot
+  //              starts, so that threads rarely compete for one.
+  static std::size_t threadIndex() {
+    static std::atomic<std::size_t> next{0};
+    thread_local std::size_t index =
+        next.fetch_add(1, std::memory_order_relaxed);
+    return index;
+  } // threadIndex()
+
+  // Description: Claim a free slot, starting at this thread's own.
+  Slot &claim() {
+    std::size_t start = threadIndex() % publication.size();
+    while (true) {
+      for (std::size_t i = 0; i < publication.size(); ++i) {
+        Slot &slot = publication[(start + i) % publication.size()];
+        std::uint32_t expected = kFree;
+        if (slot.state.load(std::memory_order_relaxed) == kFree &&
+            slot.state.compare_exchange_strong(expected, kClaimed,
+                                               std::memory_order_acquire,
+                                               std::memory_order_relaxed)) {
+          return slot;
+        } // if
+      }   // for ..i
+      std::this_thread::yield();
+    } // while
+  }   // claim()
+
+  // Description: Apply a request right away if the lock is free, or else
+  //              publish it, combine or wait until it is done, and return
+  //              its result.
+  std::optional<TYPE> request(std::uint32_t op, std::optional<TYPE> value) {
+    if (combining.try_lock()) {
+      // Uncontended: no slot round trip, but still serve the requests
+      // published meanwhile, as a combiner would.
+      if (op == kPush) {
+        pq.push(*value);
+        value.reset();
+      } else if (pq.empty()) {
+        value.reset();
+      } else {
+        value = pq.top();
+        pq.pop();
+      } // if
+      count.store(pq.size(), std::memory_order_relaxed);
+      combine();
+      combining.unlock();
+      return value;
+    } // if
+
+    Slot &slot = claim();
+    slot.value = std::move(value);
+    slot.state.store(op, std::memory_order_release);
+    for (unsigned spins = 0;
+         slot.state.load(std::memory_order_acquire) != kDone; ++spins) {
+      // A combiner scans the slots after taking the lock, so ours, which
+      // was published before, is done when combine() returns.
+      if (combining.try_lock()) {
+        combine();
+        combining.unlock();
+      } else if (spins >= kSpins) {
+        std::this_thread::yield();
+      } // if
+    }   // for ..spins
+    std::optional<TYPE> result = std::move(slot.value);
+    slot.state.store(kFree, std::memory_order_release);
+    return result;
+  } // request()
+
+  // Description: Apply the published requests, batch by batch, until a
+  //              pass finds none or kCombinePasses were made.
+  void combine() noexcept {
+    for (std::size_t pass = 0; pass < kCombinePasses; ++pass) {
+      pushes.clear();
+      pops.clear();
+      for (auto &slot : publication) {
+        std::uint32_t state = slot.state.load(std::memory_order_acquire);
+        if (state == kPush) {
+          pushes.push_back(&slot);
+        } else if (state == kPop) {
+          pops.push_back(&slot);
+        } // if
+      }   // for ..slot
+      if (pushes.empty() && pops.empty()) {
+        return;
+      } // if
+
+      // Linearize each pop right after a push of the batch.
+      std::size_t pairs = std::min(pushes.size(), pops.size());
+      for (std::size_t i = 0; i < pairs; ++i) {
+        pops[i]->value = pq.pushPop(*pushes[i]->value);
+      } // for ..i
+      if (pushes.size() - pairs == 1) {
+        pq.push(*pushes[pairs]->value);
+      } else if (pushes.size() > pairs) {
+        if constexpr (HasPushRange<PQ>::value) {
+          batch.clear();
+          for (std::size_t i = pairs; i < pushes.size(); ++i) {
+            batch.push_back(std::move(*pushes[i]->value));
+          } // for ..i
+          pq.pushRange(batch.begin(), batch.end());
+        } else {
+          for (std::size_t i = pairs; i < pushes.size(); ++i) {
+            pq.push(*pushes[i]->value);
+          } // for ..i
+        }   // if
+      }     // if
+      for (std::size_t i = pairs; i < pops.size(); ++i) {
+        if (pq.empty()) {
+          pops[i]->value.reset();
+        } else {
+          pops[i]->value = pq.top();
+          pq.pop();
+        } // if
+      }   // for ..i
+      count.store(pq.size(), std::memory_order_relaxed);
+
+      for (Slot *slot : pushes) {
+        slot->state.store(kDone, std::memory_order_release);
+      } // for ..slot
+      for (Slot *slot : pops) {
+        slot->state.store(kDone, std::memory_order_release);
+      } // for ..slot
+    }   // for ..pass
+  }     // combine()
+};      // FlatCombiningPQ
+
+#endif // FLATCOMBININGPQ_H
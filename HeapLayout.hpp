@@ -0,0 +1,135 @@
+// Project identifier: 43DE0E0C4C76BFAA6D8C2F5AEAE0518A9C42CF4E
+
+#ifndef HEAPLAYOUT_H
+#define HEAPLAYOUT_H
+
+#include <cstddef>
+
+// Storage layouts for the implicit tree of BinaryPQ.  A layout maps the
+// tree onto positions ("slots") of the data vector.  Each layout provides,
+// through its nested Index<TYPE> template, these static constexpr
+// functions on slot positions:
+//
+//   root                    slot of the root
+//   firstChild, secondChild slots of a node's children (they may be past
+//                           the end of the heap)
+//   parent                  slot of a non-root node's parent
+//   slots(n)                size of the data vector holding n elements
+//   count(slots)            number of elements in a data vector of that size
+//   isPadding(pos)          true for slots that hold no element
+//   heapifyFrom(slots)      slot to start a bottom-up heapify from
+//
+// Elements always occupy the slots in the same order as they are added, so
+// the first n elements (and any padding between them) are slots(n).
+
+// The classic layout: the tree in breadth-first order, children of i at
+// 2i + 1 and 2i + 2.
+struct FlatLayout {
+  template <typename TYPE> struct Index {
+    static constexpr bool padded = false;
+    static constexpr std::size_t root = 0;
+
+    static constexpr std::size_t firstChild(std::size_t pos) {
+      return 2 * pos + 1;
+    }
+    static constexpr std::size_t secondChild(std::size_t pos) {
+      return 2 * pos + 2;
+    }
+    static constexpr std::size_t parent(std::size_t pos) {
+      return (pos - 1) / 2;
+    }
+    static constexpr std::size_t slots(std::size_t n) { return n; }
+    static constexpr std::size_t count(std::size_t slots) { return slots; }
+    static constexpr bool isPadding(std::size_t /*pos*/) { return false; }
+    static constexpr std::size_t heapifyFrom(std::size_t slots) {
+      return slots / 2;
+    }
+  }; // Index
+};   // FlatLayout
+
+// A B-heap (Kamp): the tree is cut into subtrees of h levels, and each
+// subtree is stored in its own page of 2^h slots, breadth first from slot 1
+// (slot 0 of every page is padding).  A sift therefore covers h levels per
+// page instead of touching a new page at almost every level once the heap
+// is much larger than the TLB reach.  The 2^(h-1) leaves of a page have
+// 2^h child pages, so the pages themselves form a 2^h-ary heap and are
+// filled in order; all but the last page are full, and the height stays
+// within h levels of the flat layout's.
+//
+// PAGE_BYTES is the size of the memory page to fit (default 4 KiB); a page
+// holds the largest power of two elements of TYPE that fits, at least two.
+// Pages only line up with memory pages as well as the allocator aligns the
+// data vector; with malloc that is off by a few bytes, so a path leaves its
+// page only through the last few slots.
+//
+// Filling pages in order leaves the tree less balanced than the flat
+// layout, so sifts take a few more levels.  That only pays off once TLB
+// misses dominate; compare with benchDES --pq binary,bheap on the target
+// machine before choosing this layout.
+template <std::size_t PAGE_BYTES = 4096> // NOLINT: 4 KiB pages
+struct BHeapLayout {
+  template <typename TYPE> struct Index {
+    static constexpr bool padded = true;
+    static constexpr std::size_t root = 1;
+
+    // Slots per page (2^h) and the first leaf slot within a page.
+    static constexpr std::size_t pageSlots() {
+      std::size_t slots = 2;
+      while (slots * 2 * sizeof(TYPE) <= PAGE_BYTES) {
+        slots *= 2;
+      } // while
+      return slots;
+    } // pageSlots()
+    static constexpr std::size_t B = pageSlots();
+    static constexpr std::size_t firstLeaf = B / 2;
+
+    // Description: Below a leaf are the roots of two child pages; leaf l
+    //              of page q leads to pages qB + 1 + 2(l - B/2) and the one
+    //              after it.
+    static constexpr std::size_t firstChild(std::size_t pos) {
+      std::size_t local = pos % B;
+      if (local < firstLeaf) {
+        return pos + local;
+      } // if
+      std::size_t page = pos / B;
+      return (page * B + 1 + 2 * (local - firstLeaf)) * B + 1;
+    } // firstChild()
+
+    static constexpr std::size_t secondChild(std::size_t pos) {
+      std::size_t local = pos % B;
+      if (local < firstLeaf) {
+        return pos + local + 1;
+      } // if
+      std::size_t page = pos / B;
+      return (page * B + 2 + 2 * (local - firstLeaf)) * B + 1;
+    } // secondChild()
+
+    static constexpr std::size_t parent(std::size_t pos) {
+      std::size_t local = pos % B;
+      if (local > 1) {
+        return pos - local + local / 2;
+      } // if
+      std::size_t childPage = pos / B - 1;
+      return (childPage / B) * B + firstLeaf + (childPage % B) / 2;
+    } // parent()
+
+    static constexpr std::size_t slots(std::size_t n) {
+      std::size_t rest = n % (B - 1);
+      return n / (B - 1) * B + (rest == 0 ? 0 : rest + 1);
+    } // slots()
+
+    static constexpr std::size_t count(std::size_t slots) {
+      return slots - (slots + B - 1) / B;
+    } // count()
+
+    static constexpr bool isPadding(std::size_t pos) { return pos % B == 0; }
+
+    // Child slots are always after their parent, but the last parent is
+    // not necessarily near the middle, so heapify looks at every slot.
+    static constexpr std::size_t heapifyFrom(std::size_t slots) {
+      return slots;
+    }
+  }; // Index
+};   // BHeapLayout
+
+#endif // HEAPLAYOUT_H
@@ -0,0 +1,278 @@
+// Project identifier: 43DE0E0C4C76BFAA6D8C2F5AEAE0518A9C42CF4E
+
+#ifndef LOSERTREE_H
+#define LOSERTREE_H
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <iterator>
+#include <limits>
+#include <memory>
+#include <optional>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "TopK.hpp"
+
+// A tournament tree of losers (Knuth, TAOCP 5.4.1) over a fixed number k of
+// sources, e.g. the heads of k sorted runs being merged.  Each source holds
+// at most one element; the most extreme (defined by 'compare') of them is
+// the winner.  Every internal node remembers the player that lost the match
+// played there, so when the winner's source gets its next element, only
+// the matches on the path from that leaf to the root are replayed: one
+// comparison per level, ceil(log2(k)) at most.  A binary heap needs about
+// 2 log2(k) for the same replaceTop(), plus a fixUp() if it is done as
+// pop() + push().
+//
+// A source that runs dry is exhausted and loses every match.  Equal
+// elements win in no particular order.
+template <typename TYPE, typename COMP_FUNCTOR = std::less<TYPE>,
+          typename ALLOCATOR = std::allocator<TYPE>>
+class LoserTree {
+  using Index = std::uint32_t;
+
+  // The top bit of a player's source marks it exhausted.
+  static constexpr Index kExhausted = Index{1} << 31;
+
+  // A source's current element and its number.  Nodes keep the loser's
+  // element next to its number, so replaying a path reads only the nodes
+  // on it.  An exhausted player keeps an element it no longer uses.
+  struct Player {
+    TYPE elt;
+    Index source;
+  }; // Player
+
+  using PlayerAllocator =
+      typename std::allocator_traits<ALLOCATOR>::template rebind_alloc<Player>;
+  using Start = std::optional<TYPE>;
+  using StartAllocator =
+      typename std::allocator_traits<ALLOCATOR>::template rebind_alloc<Start>;
+
+public:
+  using allocator_type = ALLOCATOR;
+
+  // Description: Construct a tree of 'k' sources, all exhausted, with an
+  //              optional comparison functor and allocator.  Throws
+  //              std::length_error if 'k' does not fit in 31 bits.
+  // Runtime: O(k)
+  explicit LoserTree(std::size_t k, COMP_FUNCTOR comp = COMP_FUNCTOR(),
+                     const ALLOCATOR &alloc = ALLOCATOR())
+      : compare{comp}, starts(StartAllocator(alloc)),
+        nodes(PlayerAllocator(alloc)), sourceCount{k} {
+    if (k >= kExhausted) {
+      throw std::length_error("LoserTree holds at most 2^31 - 1 sources");
+    } // if
+    starts.resize(k);
+  } // LoserTree()
+
+  // Description: Give 'source' the element 'val', e.g. the first element of
+  //              its run.  Call build() after setting the sources, before
+  //              the first top().
+  // Runtime: O(1)
+  void setSource(std::size_t source, const TYPE &val) {
+    if (!starts[source]) {
+      ++activeCount;
+    } // if
+    starts[source] = val;
+  } // setSource()
+
+  // Description: Play the whole tournament, after setSource() calls.
+  // Runtime: O(k), with k - 1 comparisons at most.
+  void build() {
+    const std::size_t k = sourceCount;
+    if (activeCount == 0) {
+      starts.clear();
+      return;
+    } // if
+    // Winners and losers of the matches at internal nodes 1 .. k - 1; the
+    // leaves are nodes k .. 2k - 1, so node n plays the winners of 2n and
+    // 2n + 1.
+    std::vector<Index> winners(2 * k);
+    std::vector<Index> losers(k);
+    for (std::size_t i = 0; i < k; ++i) {
+      winners[k + i] = static_cast<Index>(i);
+    } // for ..i
+    auto startBeats = [this](Index a, Index b) {
+      return starts[a] && (!starts[b] || compare(*starts[b], *starts[a]));
+    };
+    for (std::size_t node = k - 1; node > 0; --node) {
+      Index a = winners[2 * node];
+      Index b = winners[2 * node + 1];
+      if (startBeats(b, a)) {
+        std::swap(a, b);
+      } // if
+      winners[node] = a;
+      losers[node] = b;
+    } // for ..node
+
+    // Exhausted players need some element, and the winner's will do.
+    Index winner = k == 1 ? 0 : winners[1];
+    const TYPE filler = *starts[winner];
+    auto player = [&](Index source) {
+      return starts[source] ? Player{*starts[source], source}
+                            : Player{filler, source | kExhausted};
+    };
+    nodes.assign(k, Player{filler, kExhausted});
+    nodes[0] = player(winner);
+    for (std::size_t node = 1; node < k; ++node) {
+      nodes[node] = player(losers[node]);
+    } // for ..node
+    starts.clear();
+    starts.shrink_to_fit();
+  } // build()
+
+  // Description: Return the most extreme element of all sources.  The tree
+  //              must not be empty().
+  // Runtime: O(1)
+  const TYPE &top() const { return nodes[0].elt; } // top()
+
+  // Description: Return the source that top() came from.
+  // Runtime: O(1)
+  [[nodiscard]] std::size_t topSource() const { return nodes[0].source; }
+
+  // Description: Replace the winner with 'val', the next element of the
+  //              same source, and replay its path.
+  // Runtime: O(log(k)), with at most ceil(log2(k)) comparisons.
+  void replaceTop(const TYPE &val) {
+    nodes[0].elt = val;
+    replay();
+  } // replaceTop()
+
+  // Description: Mark the winner's source exhausted and replay its path.
+  // Runtime: O(log(k)), with at most ceil(log2(k)) comparisons.
+  void pop() {
+    nodes[0].source |= kExhausted;
+    --activeCount;
+    replay();
+  } // pop()
+
+  // Description: Return the number of sources that are not exhausted.
+  // Runtime: O(1)
+  [[nodiscard]] std::size_t size() const { return activeCount; }
+
+  // Description: Return true if every source is exhausted.
+  // Runtime: O(1)
+  [[nodiscard]] bool empty() const { return activeCount == 0; }
+
+  // Description: Return the number of sources, k.
+  // Runtime: O(1)
+  [[nodiscard]] std::size_t sources() const { return sourceCount; }
+
+  // Description: Return a copy of the allocator used for the tree.
+  // Runtime: O(1)
+  allocator_type get_allocator() const {
+    return allocator_type(nodes.get_allocator());
+  } // get_allocator()
+
+private:
+  COMP_FUNCTOR compare;
+  // The starting element of each source, until build().
+  std::vector<Start, StartAllocator> starts;
+  // nodes[n] is the loser of the match at internal node n; nodes[0] is the
+  // overall winner.
+  std::vector<Player, PlayerAllocator> nodes;
+  std::size_t sourceCount;
+  std::size_t activeCount = 0;
+
+  // Description: Return true if 'a' wins a match against 'b'.
+  // Runtime: O(1), with at most one comparison.
+  bool beats(const Player &a, const Player &b) const {
+    if constexpr (std::is_trivially_copyable_v<Player>) {
+      // Cheap elements are compared even if a player is exhausted, so
+      // that the result is computed without branches.
+      return ((a.source & kExhausted) == 0) &
+             (((b.source & kExhausted) != 0) | compare(b.elt, a.elt));
+    } else {
+      return (a.source & kExhausted) == 0 &&
+             ((b.source & kExhausted) != 0 || compare(b.elt, a.elt));
+    } // if
+  }   // beats()
+
+  // Description: Replay the matches from the leaf of the winner's source
+  //              up to the root: at each node the stored loser plays the
+  //              current winner, and the one that loses stays behind.
+  // Runtime: O(log(k))
+  void replay() {
+    Player winner = std::move(nodes[0]);
+    for (std::size_t node = (sourceCount + (winner.source & ~kExhausted)) / 2;
+         node > 0; node /= 2) {
+      if constexpr (std::is_trivially_copyable_v<Player>) {
+        // The two players are picked by index, not by a branch that would
+        // be mispredicted about half the time.
+        const Player pair[2] = {winner, nodes[node]}; // NOLINT: C array
+        const bool otherWins = beats(pair[1], pair[0]);
+        nodes[node] = pair[!otherWins];
+        winner = pair[otherWins];
+      } else {
+        if (beats(nodes[node], winner)) {
+          std::swap(nodes[node], winner);
+        } // if
+      }   // if
+    }     // for ..node
+    nodes[0] = std::move(winner);
+  } // replay()
+};  // LoserTree
+
+// Description: Merge the sorted runs [first, last) given as iterator
+//              pairs in 'runs' into 'out', in the order of 'comp', with a
+//              LoserTree over the run heads.  Like std::merge, every run
+//              must be sorted by 'comp' (std::less for ascending order).
+//              Returns the output iterator one past the last element
+//              written.
+// Runtime: O(n log(k)) for n elements in k runs, with at most
+//          ceil(log2(k)) comparisons per element after the first k - 1.
+template <typename InputIterator, typename OutputIterator,
+          typename COMP_FUNCTOR = std::less<>>
+OutputIterator
+kWayMerge(std::vector<std::pair<InputIterator, InputIterator>> runs,
+          OutputIterator out, COMP_FUNCTOR comp = COMP_FUNCTOR()) {
+  using Value = typename std::iterator_traits<InputIterator>::value_type;
+  // The tree's winner is the most extreme element, i.e. the greatest under
+  // its comparator, so it gets 'comp' inverted to hand out the least.
+  LoserTree<Value, InvertedComp<COMP_FUNCTOR>> tree{
+      runs.size(), InvertedComp<COMP_FUNCTOR>{comp}};
+  for (std::size_t i = 0; i < runs.size(); ++i) {
+    auto &[first, last] = runs[i];
+    if (first != last) {
+      tree.setSource(i, *first);
+      ++first;
+    } // if
+  }   // for ..i
+  tree.build();
+
+  while (!tree.empty()) {
+    *out = tree.top();
+    ++out;
+    auto &[first, last] = runs[tree.topSource()];
+    if (first != last) {
+      tree.replaceTop(*first);
+      ++first;
+    } else {
+      tree.pop();
+    } // if
+  }   // while
+  return out;
+} // kWayMerge()
+
+// Description: kWayMerge() for a container of sorted ranges, such as a
+//              std::vector<std::vector<int>>.
+// Runtime: O(n log(k)) for n elements in k runs.
+template <typename RANGES, typename OutputIterator,
+          typename COMP_FUNCTOR = std::less<>>
+OutputIterator kWayMerge(const RANGES &ranges, OutputIterator out,
+                         COMP_FUNCTOR comp = COMP_FUNCTOR()) {
+  using std::begin;
+  using std::end;
+  using Iterator = decltype(begin(*begin(ranges)));
+  std::vector<std::pair<Iterator, Iterator>> runs;
+  for (const auto &range : ranges) {
+    runs.emplace_back(begin(range), end(range));
+  } // for ..range
+  return kWayMerge(std::move(runs), out, comp);
+} // kWayMerge()
+
+#endif // LOSERTREE_H
@@ -0,0 +1,122 @@
+// Project identifier: 43DE0E0C4C76BFAA6D8C2F5AEAE0518A9C42CF4E
+
+#ifndef MEMORYUSAGE_H
+#define MEMORYUSAGE_H
+
+#include <algorithm>
+#include <cstddef>
+#include <iterator>
+
+// Bytes of heap memory held by a PQ, as returned by memoryUsage():
+//
+//   payload   the elements themselves, size() * sizeof(TYPE)
+//   overhead  everything else the structure needs: node links and counts,
+//             padding slots, and the allocator's own per-block headers
+//   slack     capacity that is allocated but holds no element yet
+//
+// The PQ object itself (its sizeof) is not included, and neither is memory
+// owned by the elements.
+struct MemoryUsage {
+  std::size_t payload = 0;
+  std::size_t overhead = 0;
+  std::size_t slack = 0;
+
+  [[nodiscard]] std::size_t total() const {
+    return payload + overhead + slack;
+  } // total()
+
+  // Description: Add the usage of another part of the same structure.
+  MemoryUsage &operator+=(const MemoryUsage &other) {
+    payload += other.payload;
+    overhead += other.overhead;
+    slack += other.slack;
+    return *this;
+  } // operator+=()
+};  // MemoryUsage
+
+// Description: Estimate the bytes a general-purpose malloc really takes for
+//              a block of 'bytes': a size header, rounded up to the
+//              alignment granule, with a minimum block size.  The constants
+//              are glibc's on 64-bit targets (8-byte header, 16-byte
+//              granule, 32-byte minimum).  Other allocators, such as a
+//              monotonic pmr resource, spend less; this is an estimate.
+// Runtime: O(1)
+inline std::size_t allocationFootprint(std::size_t bytes) {
+  constexpr std::size_t header = sizeof(std::size_t);
+  constexpr std::size_t granule = 2 * sizeof(std::size_t);
+  std::size_t block = (bytes + header + granule - 1) / granule * granule;
+  return std::max(block, 2 * granule);
+} // allocationFootprint()
+
+// Description: Memory used by a vector holding 'elements' elements in its
+//              slots.  Slots that hold no element (padding) are overhead.
+// Runtime: O(1)
+template <typename VECTOR>
+MemoryUsage vectorMemoryUsage(const VECTOR &data, std::size_t elements) {
+  constexpr std::size_t eltSize = sizeof(typename VECTOR::value_type);
+  MemoryUsage usage;
+  usage.payload = elements * eltSize;
+  usage.overhead = (data.size() - elements) * eltSize;
+  usage.slack = (data.capacity() - data.size()) * eltSize;
+  if (data.capacity() != 0) {
+    usage.overhead += allocationFootprint(data.capacity() * eltSize) -
+                      data.capacity() * eltSize;
+  } // if
+  return usage;
+} // vectorMemoryUsage()
+
+// Description: Memory used by 'nodes' separately allocated NODEs that each
+//              hold one TYPE.  Links, counters and the allocator's block
+//              header are overhead; nodes have no slack.
+// Runtime: O(1)
+template <typename NODE, typename TYPE>
+MemoryUsage nodeMemoryUsage(std::size_t nodes) {
+  MemoryUsage usage;
+  usage.payload = nodes * sizeof(TYPE);
+  usage.overhead = nodes * (allocationFootprint(sizeof(NODE)) - sizeof(TYPE));
+  return usage;
+} // nodeMemoryUsage()
+
+// Shrink policies, for the SHRINK template parameter of the vector-backed
+// PQs: when pop() and eraseIf() give capacity back.  A policy provides
+//
+//   apply(data)   static; reallocate the vector smaller if it should, and
+//                 return true if it did
+//
+// The vector's elements keep their order, so a PQ's invariant survives.
+
+// The default: never give capacity back, so a drained PQ keeps it for the
+// next burst.  The check compiles away.
+struct NeverShrink {
+  template <typename VECTOR>
+  static constexpr bool apply(VECTOR & /*data*/) {
+    return false;
+  } // apply()
+};  // NeverShrink
+
+// Once size() drops below capacity / DIVISOR, reallocate with room for twice
+// the size, which at least halves the capacity, but never to less than
+// MIN_CAPACITY elements.  The gap between the two is the hysteresis: after
+// a shrink the PQ has to lose half its elements again before the next
+// shrink, or double before the vector grows, so pushes and pops around a
+// threshold cannot make it reallocate back and forth, and the O(n)
+// reallocation stays amortized O(1) per operation.
+template <std::size_t DIVISOR = 4, std::size_t MIN_CAPACITY = 64> // NOLINT
+struct ShrinkBelow {
+  static_assert(DIVISOR > 2, "shrinking below half full would ping-pong");
+
+  template <typename VECTOR> static bool apply(VECTOR &data) {
+    if (data.capacity() <= MIN_CAPACITY ||
+        data.size() >= data.capacity() / DIVISOR) {
+      return false;
+    } // if
+    VECTOR smaller(data.get_allocator());
+    smaller.reserve(std::max(2 * data.size(), MIN_CAPACITY));
+    smaller.insert(smaller.end(), std::make_move_iterator(data.begin()),
+                   std::make_move_iterator(data.end()));
+    data.swap(smaller);
+    return true;
+  } // apply()
+};  // ShrinkBelow
+
+#endif // MEMORYUSAGE_H
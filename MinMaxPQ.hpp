@@ -0,0 +1,317 @@
+// Project identifier: 43DE0E0C4C76BFAA6D8C2F5AEAE0518A9C42CF4E
+
+#ifndef MINMAXPQ_H
+#define MINMAXPQ_H
+
+#include <algorithm>
+#include <cstddef>
+#include <memory>
+#include <memory_resource>
+
+#include "Eecs281PQ.hpp"
+#include "MemoryUsage.hpp"
+
+// A double-ended priority queue implemented as a min-max heap.  Like
+// BinaryPQ it is an implicit tree stored in a vector, but the levels
+// alternate: nodes on even levels (the root is level 0) are more extreme
+// than all of their descendants, nodes on odd levels are less extreme than
+// all of their descendants.  This makes both the most extreme element
+// (top) and the least extreme element (bottom) available in O(1).
+// The optional ALLOCATOR is used for the underlying data vector, and the
+// optional SHRINK policy (see MemoryUsage.hpp) decides when removals give
+// its capacity back.
+template <typename TYPE, typename COMP_FUNCTOR = std::less<TYPE>,
+          typename ALLOCATOR = std::allocator<TYPE>,
+          typename SHRINK = NeverShrink>
+class MinMaxPQ : public Eecs281PQ<TYPE, COMP_FUNCTOR> {
+  // This is a way to refer to the base class object.
+  using BaseClass = Eecs281PQ<TYPE, COMP_FUNCTOR>;
+
+public:
+  using allocator_type = ALLOCATOR;
+
+  // Description: Construct an empty PQ with an optional comparison functor
+  //              and allocator.
+  // Runtime: O(1)
+  explicit MinMaxPQ(COMP_FUNCTOR comp = COMP_FUNCTOR(),
+                    const ALLOCATOR &alloc = ALLOCATOR())
+      : BaseClass{comp}, data(alloc) {} // MinMaxPQ()
+
+  // Description: Construct a PQ out of an iterator range with an optional
+  //              comparison functor and allocator.
+  // Runtime: O(n) where n is number of elements in range.
+  template <typename InputIterator>
+  MinMaxPQ(InputIterator start, InputIterator end,
+           COMP_FUNCTOR comp = COMP_FUNCTOR(),
+           const ALLOCATOR &alloc = ALLOCATOR())
+      : BaseClass{comp}, data(start, end, alloc) {
+    updatePriorities();
+  } // MinMaxPQ()
+
+  // Description: Destructor doesn't need any code, the data vector will
+  //              be destroyed automatically.
+  virtual ~MinMaxPQ() = default;
+
+  // Description: Copy constructors don't need any code, the data vector
+  //              will be copied automatically.
+  MinMaxPQ(const MinMaxPQ &) = default;
+  MinMaxPQ(MinMaxPQ &&) noexcept = default;
+
+  // Description: Copy assignment operators don't need any code, the data
+  //              vector will be copied automatically.
+  MinMaxPQ &operator=(const MinMaxPQ &) = default;
+  MinMaxPQ &operator=(MinMaxPQ &&) noexcept = default;
+
+  // Description: Assumes that all elements inside the heap are out of order
+  //              and 'rebuilds' the heap by fixing the min-max invariant
+  //              bottom-up, as BinaryPQ does.
+  // Runtime: O(n)
+  virtual void updatePriorities() {
+    for (size_t i = data.size() / 2; i-- > 0;) {
+      fixDown(i);
+    } // for ..i
+  }   // updatePriorities()
+
+  // Description: Add a new element to the PQ.
+  // Runtime: O(log(n))
+  virtual void push(const TYPE &val) {
+    data.push_back(val);
+    fixUp(data.size() - 1);
+  } // push()
+
+  // Description: Remove the most extreme (defined by 'compare') element
+  //              from the PQ.
+  // Runtime: O(log(n))
+  virtual void pop() { removeAt(0); } // pop()
+
+  // Description: Replace the most extreme element with 'val' and restore
+  //              the invariant with a single fixDown from the root.
+  // Runtime: O(log(n))
+  virtual void replaceTop(const TYPE &val) {
+    data[0] = val;
+    fixDown(0);
+  } // replaceTop()
+
+  // Description: Add 'val', then remove and return the most extreme
+  //              element, with one fixDown, or none when 'val' would be the
+  //              most extreme.
+  // Runtime: O(1) if 'val' would be the most extreme, O(log(n)) otherwise.
+  virtual TYPE pushPop(const TYPE &val) {
+    if (data.empty() || !this->compare(val, data[0])) {
+      return val;
+    } // if
+    TYPE result = std::move(data[0]);
+    data[0] = val;
+    fixDown(0);
+    return result;
+  } // pushPop()
+
+  // Description: Remove the least extreme (defined by 'compare') element
+  //              from the PQ.
+  // Runtime: O(log(n))
+  void popBottom() { removeAt(bottomIndex()); } // popBottom()
+
+  // Description: Empty the PQ and hand back its elements, in no particular
+  //              order, e.g. to bulk-build another PQ from them.
+  // Runtime: O(1)
+  std::vector<TYPE, ALLOCATOR> extractAll() {
+    std::vector<TYPE, ALLOCATOR> result{std::move(data)};
+    data.clear();
+    return result;
+  } // extractAll()
+
+  // Description: Remove every element for which 'pred' returns true, in
+  //              one pass over the data, then rebuild the heap.  Returns
+  //              the number removed.
+  // Runtime: O(n)
+  template <typename PREDICATE> std::size_t eraseIf(PREDICATE pred) {
+    auto newEnd = std::remove_if(data.begin(), data.end(), pred);
+    auto erased = static_cast<std::size_t>(data.end() - newEnd);
+    if (erased != 0) {
+      data.erase(newEnd, data.end());
+      updatePriorities();
+      SHRINK::apply(data);
+    } // if
+    return erased;
+  } // eraseIf()
+
+  // Description: Empty the PQ, writing its elements to 'out' with the most
+  //              extreme first.  Returns the output iterator one past the
+  //              last element written.
+  // Runtime: O(n log(n))
+  template <typename OutputIterator>
+  OutputIterator drainSorted(OutputIterator out) {
+    std::sort(data.begin(), data.end(), this->compare);
+    out = std::move(data.rbegin(), data.rend(), out);
+    data.clear();
+    return out;
+  } // drainSorted()
+
+  // Description: Return the most extreme (defined by 'compare') element of
+  //              the PQ.
+  // Runtime: O(1)
+  virtual const TYPE &top() const { return data.front(); } // top()
+
+  // Description: Return the least extreme (defined by 'compare') element of
+  //              the PQ.
+  // Runtime: O(1)
+  const TYPE &bottom() const { return data[bottomIndex()]; } // bottom()
+
+  // Description: Get the number of elements in the PQ.
+  // Runtime: O(1)
+  [[nodiscard]] virtual std::size_t size() const { return data.size(); }
+
+  // Description: Return true if the PQ is empty.
+  // Runtime: O(1)
+  [[nodiscard]] virtual bool empty() const { return data.empty(); }
+
+  // Description: Return a copy of the allocator used by the data vector.
+  // Runtime: O(1)
+  allocator_type get_allocator() const { return data.get_allocator(); }
+
+  // Description: Return the bytes held for elements, for the vector's
+  //              allocation itself, and in unused capacity.
+  // Runtime: O(1)
+  [[nodiscard]] MemoryUsage memoryUsage() const {
+    return vectorMemoryUsage(data, data.size());
+  } // memoryUsage()
+
+private:
+  std::vector<TYPE, ALLOCATOR> data;
+
+  // Description: Return true if index 'i' is on a level whose nodes are
+  //              more extreme than their descendants (an even level).
+  static bool isTopLevel(size_t i) {
+    size_t level = 0;
+    for (++i; i > 1; i >>= 1) {
+      ++level;
+    } // for ..i
+    return level % 2 == 0;
+  } // isTopLevel()
+
+  // Description: Return true if 'a' belongs above 'b' on a level of the
+  //              given kind: more extreme on top levels, less extreme on
+  //              bottom levels.
+  template <bool TOP> bool above(const TYPE &a, const TYPE &b) const {
+    return TOP ? this->compare(b, a) : this->compare(a, b);
+  } // above()
+
+  // Description: Index of the least extreme element; one of the root's
+  //              children unless the heap is that small.
+  size_t bottomIndex() const {
+    if (data.size() < 3) {
+      return data.size() - 1;
+    } // if
+    return this->compare(data[2], data[1]) ? 2 : 1;
+  } // bottomIndex()
+
+  // Description: Replace the element at 'k' by the last element and
+  //              restore the invariant below 'k'.
+  void removeAt(size_t k) {
+    if (k != data.size() - 1) {
+      data[k] = std::move(data.back());
+    } // if
+    data.pop_back();
+    if (k < data.size()) {
+      fixDown(k);
+    } // if
+    SHRINK::apply(data);
+  }   // removeAt()
+
+  void fixDown(size_t k) {
+    if (isTopLevel(k)) {
+      fixDownLevel<true>(k);
+    } else {
+      fixDownLevel<false>(k);
+    } // if
+  }   // fixDown()
+
+  // Description: Sift the element at 'k' down along levels of the given
+  //              kind, comparing against children and grandchildren.
+  template <bool TOP> void fixDownLevel(size_t k) {
+    size_t current = k;
+    while (true) {
+      size_t firstChild = 2 * current + 1;
+      if (firstChild >= data.size()) {
+        break;
+      } // if
+
+      // Find the best of the (up to) two children and four grandchildren.
+      size_t best = firstChild;
+      if (firstChild + 1 < data.size() &&
+          above<TOP>(data[firstChild + 1], data[best])) {
+        best = firstChild + 1;
+      } // if
+      size_t firstGrandchild = 2 * firstChild + 1;
+      size_t lastGrandchild =
+          std::min(firstGrandchild + 4, data.size()); // one past the end
+      for (size_t g = firstGrandchild; g < lastGrandchild; ++g) {
+        if (above<TOP>(data[g], data[best])) {
+          best = g;
+        } // if
+      }   // for ..g
+
+      if (!above<TOP>(data[best], data[current])) {
+        break;
+      } // if
+      std::swap(data[current], data[best]);
+      if (best < firstGrandchild) {
+        break;
+      } // if
+
+      // The element moved down two levels; it may now violate the
+      // opposite-kind ordering with its new parent.
+      size_t parent = (best - 1) / 2;
+      if (above<TOP>(data[parent], data[best])) {
+        std::swap(data[parent], data[best]);
+      } // if
+      current = best;
+    } // while
+  }   // fixDownLevel()
+
+  void fixUp(size_t k) {
+    if (k == 0) {
+      return;
+    } // if
+    size_t parent = (k - 1) / 2;
+    if (isTopLevel(k)) {
+      if (above<false>(data[k], data[parent])) {
+        std::swap(data[k], data[parent]);
+        fixUpLevel<false>(parent);
+      } else {
+        fixUpLevel<true>(k);
+      } // if
+    } else {
+      if (above<true>(data[k], data[parent])) {
+        std::swap(data[k], data[parent]);
+        fixUpLevel<true>(parent);
+      } else {
+        fixUpLevel<false>(k);
+      } // if
+    }   // if
+  }     // fixUp()
+
+  // Description: Sift the element at 'k' up through its grandparents,
+  //              which are on levels of the same kind.
+  template <bool TOP> void fixUpLevel(size_t k) {
+    size_t current = k;
+    while (current > 2) {
+      size_t grandparent = ((current - 1) / 2 - 1) / 2;
+      if (!above<TOP>(data[current], data[grandparent])) {
+        break;
+      } // if
+      std::swap(data[current], data[grandparent]);
+      current = grandparent;
+    } // while
+  }   // fixUpLevel()
+};    // MinMaxPQ
+
+namespace pmr {
+// A MinMaxPQ whose storage comes from a std::pmr::memory_resource.
+template <typename TYPE, typename COMP_FUNCTOR = std::less<TYPE>,
+          typename SHRINK = NeverShrink>
+using MinMaxPQ = ::MinMaxPQ<TYPE, COMP_FUNCTOR,
+                            std::pmr::polymorphic_allocator<TYPE>, SHRINK>;
+} // namespace pmr
+
+#endif // MINMAXPQ_H
@@ -4,18 +4,26 @@
 #define PAIRINGPQ_H
 
 #include <deque>
+#include <memory>
+#include <memory_resource>
 #include <utility>
+#include <vector>
 
 #include "Eecs281PQ.hpp"
+#include "MemoryUsage.hpp"
 
 // A specialized version of the priority queue ADT implemented as a pairing
 // heap.
-template <typename TYPE, typename COMP_FUNCTOR = std::less<TYPE>>
+// Nodes are obtained from the optional ALLOCATOR, rebound to Node.
+template <typename TYPE, typename COMP_FUNCTOR = std::less<TYPE>,
+          typename ALLOCATOR = std::allocator<TYPE>>
 class PairingPQ : public Eecs281PQ<TYPE, COMP_FUNCTOR> {
   // This is a way to refer to the base class object.
   using BaseClass = Eecs281PQ<TYPE, COMP_FUNCTOR>;
 
 public:
+  using allocator_type = ALLOCATOR;
+
   // Each node within the pairing heap
   class Node {
   public:
@@ -47,21 +55,24 @@ public:
   }; // Node
 
   // Description: Construct an empty pairing heap with an optional
-  //              comparison functor.
+  //              comparison functor and allocator.
   // Runtime: O(1)
-  explicit PairingPQ(COMP_FUNCTOR comp = COMP_FUNCTOR()) : BaseClass{comp} {
+  explicit PairingPQ(COMP_FUNCTOR comp = COMP_FUNCTOR(),
+                     const ALLOCATOR &alloc = ALLOCATOR())
+      : BaseClass{comp}, nodeAlloc{alloc} {
     // TODO: Implement this function.
     this->root = nullptr;
     this->nodeCount = 0;
   } // PairingPQ()
 
   // Description: Construct a pairing heap out of an iterator range with an
-  //              optional comparison functor.
+  //              optional comparison functor and allocator.
   // Runtime: O(n) where n is number of elements in range.
   template <typename InputIterator>
   PairingPQ(InputIterator start, InputIterator end,
-            COMP_FUNCTOR comp = COMP_FUNCTOR())
-      : BaseClass{comp} {
+            COMP_FUNCTOR comp = COMP_FUNCTOR(),
+            const ALLOCATOR &alloc = ALLOCATOR())
+      : BaseClass{comp}, nodeAlloc{alloc} {
     // TODO: Implement this function.
     this->root = nullptr;
     this->nodeCount = 0;
@@ -70,9 +81,17 @@ public:
     }
   } // PairingPQ()
 
-  // Description: Copy constructor.
+  // Description: Copy constructor.  The copy's allocator is chosen the way
+  //              the standard containers choose it.
+  // Runtime: O(n)
+  PairingPQ(const PairingPQ &other)
+      : PairingPQ{other, NodeTraits::select_on_container_copy_construction(
+                             other.nodeAlloc)} {} // PairingPQ()
+
+  // Description: Copy constructor that places the copy's nodes in 'alloc'.
   // Runtime: O(n)
-  PairingPQ(const PairingPQ &other) : BaseClass{other.compare} {
+  PairingPQ(const PairingPQ &other, const ALLOCATOR &alloc)
+      : BaseClass{other.compare}, nodeAlloc{alloc} {
     // TODO: Implement this function.
     // NOTE: The structure does not have to be identical to the original,
     //       but it must still be a valid pairing heap.
@@ -102,9 +121,12 @@ public:
     // TODO: Implement this function.
     // HINT: Use the copy-swap method from the "Arrays and Containers"
     // lecture.
-    PairingPQ temp(rhs);
+    // Build the copy with our own allocator, so the nodes we take over are
+    // later released to the same place they came from.
+    PairingPQ temp(rhs, get_allocator());
     std::swap(nodeCount, temp.nodeCount);
     std::swap(root, temp.root);
+    this->compare = rhs.compare;
     return *this;
   } // operator=()
 
@@ -126,14 +148,41 @@ public:
       if (current->child != nullptr) {
         deq.push_back(current->child);
       }
-      delete current;
+      destroyNode(current);
     }
   } // ~PairingPQ()
 
-  // Description: Move constructor and assignment operators don't need any
-  //              code, the members will be reused automatically.
-  PairingPQ(PairingPQ &&) noexcept = default;
-  PairingPQ &operator=(PairingPQ &&) noexcept = default;
+  // Description: Move constructor.  Takes over the other heap's nodes and
+  //              leaves it empty, so that only one destructor frees them.
+  // Runtime: O(1)
+  PairingPQ(PairingPQ &&other) noexcept
+      : BaseClass{std::move(other)}, root{other.root},
+        nodeCount{other.nodeCount}, nodeAlloc{other.nodeAlloc} {
+    other.root = nullptr;
+    other.nodeCount = 0;
+  } // PairingPQ()
+
+  // Description: Move assignment operator.  As with the standard
+  //              containers, the nodes are taken over when the allocator
+  //              propagates or both allocators compare equal; otherwise
+  //              (e.g. pmr allocators on different resources) the elements
+  //              are copied into nodes from our own allocator.
+  // Runtime: O(1), or O(n) for unequal non-propagating allocators.
+  PairingPQ &operator=(PairingPQ &&rhs) noexcept(
+      NodeTraits::propagate_on_container_move_assignment::value ||
+      NodeTraits::is_always_equal::value) {
+    if constexpr (NodeTraits::propagate_on_container_move_assignment::value) {
+      std::swap(nodeAlloc, rhs.nodeAlloc);
+    } else {
+      if (!(nodeAlloc == rhs.nodeAlloc)) {
+        return *this = static_cast<const PairingPQ &>(rhs);
+      } // if
+    }   // if
+    std::swap(root, rhs.root);
+    std::swap(nodeCount, rhs.nodeCount);
+    std::swap(this->compare, rhs.compare);
+    return *this;
+  } // operator=()
 
   // Description: Assumes that all elements inside the pairing heap are out
   //              of order and 'rebuilds' the pairing heap by fixing the
@@ -142,11 +191,12 @@ public:
   // Runtime: O(n)
   virtual void updatePriorities() {
     // TODO: Implement this function.
-    if (empty()) {
+    if (empty() || root->child == nullptr) {
       return;
     }
     std::deque<Node *> deq;
     deq.push_back(root->child);
+    root->child = nullptr;
     while (!deq.empty()) {
       Node *current = deq.front();
       deq.pop_front();
@@ -179,38 +229,169 @@ public:
   // Runtime: Amortized O(log(n))
   virtual void pop() {
     // TODO: Implement this function.
-    if (nodeCount == 1) {
-      root = nullptr;
-      nodeCount = 0;
-      delete root;
-      return;
-    }
-    std::deque<Node *> temp;
-    Node *current = root->child;
-    delete root;
-    while (current != nullptr) {
-      temp.push_back(current);
-      if (current->sibling != nullptr) {
-        current = current->sibling;
-      } else {
-        break;
-      }
-    }
-    while (temp.size() > 1) {
-      Node *first = temp.front();
-      temp.pop_front();
-      Node *second = temp.front();
-      temp.pop_front();
-      first->parent = nullptr;
-      first->sibling = nullptr;
-      second->parent = nullptr;
-      second->sibling = nullptr;
-      temp.push_back(meld(first, second));
-    }
-    this->root = temp.front();
+    Node *oldRoot = root;
+    root = mergePairs(root->child);
+    destroyNode(oldRoot);
     this->nodeCount--;
   } // pop()
 
+  // Description: Remove the most extreme element and add 'val', reusing
+  //              the root's node for 'val' instead of freeing it and
+  //              allocating a new one.  A Node* for the old top now refers
+  //              to 'val'.
+  // Runtime: Amortized O(log(n))
+  virtual void replaceTop(const TYPE &val) {
+    Node *node = root;
+    root = mergePairs(node->child);
+    node->elt = val;
+    node->child = nullptr;
+    root = meld(root, node);
+  } // replaceTop()
+
+  // Description: Add 'val', then remove and return the most extreme
+  //              element, reusing the root's node as replaceTop() does.
+  // Runtime: O(1) if 'val' would be the most extreme, amortized O(log(n))
+  //          otherwise.
+  virtual TYPE pushPop(const TYPE &val) {
+    if (root == nullptr || !this->compare(val, root->elt)) {
+      return val;
+    } // if
+    TYPE result = std::move(root->elt);
+    replaceTop(val);
+    return result;
+  } // pushPop()
+
+  // Description: Empty the pairing heap, writing its elements to 'out' with
+  //              the most extreme first.  Each element is moved out of its
+  //              node, and no memory is allocated while draining.  Returns
+  //              the output iterator one past the last element written.
+  // Runtime: O(n log(n)) amortized
+  template <typename OutputIterator>
+  OutputIterator drainSorted(OutputIterator out) {
+    while (root != nullptr) {
+      *out = std::move(root->elt);
+      ++out;
+      Node *oldRoot = root;
+      root = mergePairs(root->child);
+      destroyNode(oldRoot);
+    } // while
+    nodeCount = 0;
+    return out;
+  } // drainSorted()
+
+  // Description: Empty the pairing heap and hand back its elements, in no
+  //              particular order, e.g. to bulk-build another PQ from them.
+  //              The tree is walked by rotating children into the sibling
+  //              chain, so nothing but the result is allocated.
+  // Runtime: O(n)
+  std::vector<TYPE, ALLOCATOR> extractAll() {
+    std::vector<TYPE, ALLOCATOR> result(get_allocator());
+    result.reserve(nodeCount);
+    Node *current = root;
+    while (current != nullptr) {
+      if (current->child != nullptr) {
+        current = rotateChild(current);
+      } else {
+        result.push_back(std::move(current->elt));
+        Node *next = current->sibling;
+        destroyNode(current);
+        current = next;
+      } // if
+    }   // while
+    root = nullptr;
+    nodeCount = 0;
+    return result;
+  } // extractAll()
+
+  // Description: Move every element of 'other' into this pairing heap,
+  //              leaving 'other' empty.  If the allocators compare equal
+  //              the nodes change owner with a single meld; otherwise (e.g.
+  //              pmr allocators on different resources) the elements are
+  //              moved into nodes from our own allocator, as the standard
+  //              containers' splice() would have to.
+  // Runtime: O(1), or O(m) when the allocators differ.
+  void merge(PairingPQ &other) {
+    if (&other == this || other.root == nullptr) {
+      return;
+    } // if
+    if (nodeAlloc == other.nodeAlloc) {
+      root = meld(root, other.root);
+      nodeCount += other.nodeCount;
+      other.root = nullptr;
+      other.nodeCount = 0;
+    } else {
+      for (const auto &val : other.extractAll()) {
+        push(val);
+      } // for ..val
+    }   // if
+  } // merge()
+
+  // Description: Remove every element for which 'pred' returns true.  Each
+  //              matching node is unlinked from its parent's child list
+  //              and freed, and its children are detached as separate
+  //              trees; all surviving trees are then combined with one
+  //              two-pass pairing.  Nodes returned by addNode() for removed
+  //              elements become invalid.  Returns the number removed.
+  // Runtime: O(n)
+  template <typename PREDICATE> std::size_t eraseIf(PREDICATE pred) {
+    std::size_t erased = 0;
+    // Trees cut loose from the heap, their roots not yet checked.
+    std::vector<Node *> detached;
+    // Surviving nodes whose child lists have not been checked yet.
+    std::vector<Node *> kept;
+    // Surviving detached trees, chained through their sibling pointers.
+    Node *survivors = nullptr;
+
+    // Cut the children of a removed node loose and free it.
+    auto removeNode = [&](Node *node) {
+      for (Node *child = node->child; child != nullptr;) {
+        Node *next = child->sibling;
+        child->parent = nullptr;
+        child->sibling = nullptr;
+        detached.push_back(child);
+        child = next;
+      } // for ..child
+      destroyNode(node);
+      ++erased;
+    };
+
+    if (root != nullptr) {
+      detached.push_back(root);
+    } // if
+    while (!detached.empty() || !kept.empty()) {
+      if (!detached.empty()) {
+        Node *tree = detached.back();
+        detached.pop_back();
+        if (pred(tree->elt)) {
+          removeNode(tree);
+        } else {
+          tree->sibling = survivors;
+          survivors = tree;
+          kept.push_back(tree);
+        } // if
+        continue;
+      } // if
+
+      Node *parent = kept.back();
+      kept.pop_back();
+      Node **link = &parent->child;
+      while (*link != nullptr) {
+        Node *child = *link;
+        if (pred(child->elt)) {
+          *link = child->sibling;
+          removeNode(child);
+        } else {
+          kept.push_back(child);
+          link = &child->sibling;
+        } // if
+      }   // while
+    }     // while
+
+    root = mergePairs(survivors);
+    nodeCount -= erased;
+    return erased;
+  } // eraseIf()
+
   // Description: Return the most extreme (defined by 'compare') element of
   //              the pairing heap. This should be a reference for speed.
   //              It MUST be const because we cannot allow it to be
@@ -236,6 +417,18 @@ public:
     return root == nullptr; // TODO: Delete or change this line
   }                         // empty()
 
+  // Description: Return a copy of the allocator used for the nodes.
+  // Runtime: O(1)
+  allocator_type get_allocator() const { return allocator_type(nodeAlloc); }
+
+  // Description: Return the bytes held for elements and for the nodes
+  //              around them, including an estimate of the allocator's
+  //              per-node overhead.
+  // Runtime: O(1)
+  [[nodiscard]] MemoryUsage memoryUsage() const {
+    return nodeMemoryUsage<Node, TYPE>(nodeCount);
+  } // memoryUsage()
+
   // Description: Updates the priority of an element already in the pairing
   //              heap by replacing the element refered to by the Node with
   //              new_value.  Must maintain pairing heap invariants.
@@ -275,7 +468,7 @@ public:
   //       when you implement updateElt() and updatePriorities().
   Node *addNode(const TYPE &val) {
     // TODO: Implement this function
-    Node *newNode = new Node(val);
+    Node *newNode = createNode(val);
     if (root == nullptr) {
       this->root = newNode;
     } else {
@@ -286,6 +479,80 @@ public:
   } // addNode()
 
 private:
+  using NodeAllocator =
+      typename std::allocator_traits<ALLOCATOR>::template rebind_alloc<Node>;
+  using NodeTraits = std::allocator_traits<NodeAllocator>;
+
+  // Description: Allocate and construct a node holding 'val'.
+  Node *createNode(const TYPE &val) {
+    Node *node = NodeTraits::allocate(nodeAlloc, 1);
+    try {
+      NodeTraits::construct(nodeAlloc, node, val);
+    } catch (...) {
+      NodeTraits::deallocate(nodeAlloc, node, 1);
+      throw;
+    }
+    return node;
+  } // createNode()
+
+  // Description: Destroy a node and give its memory back to the allocator.
+  void destroyNode(Node *node) {
+    NodeTraits::destroy(nodeAlloc, node);
+    NodeTraits::deallocate(nodeAlloc, node, 1);
+  } // destroyNode()
+
+  // Description: Viewing child as 'left' and sibling as 'right', rotate
+  //              the first child of 'node' up into node's place: the child
+  //              becomes the head of the chain with node as its next
+  //              sibling, and node adopts the child's former siblings as
+  //              its children.  Returns the new head.  Repeating this
+  //              flattens a tree into one sibling chain with no extra
+  //              memory.
+  // Runtime: O(1)
+  static Node *rotateChild(Node *node) {
+    Node *first = node->child;
+    node->child = first->sibling;
+    first->sibling = node;
+    return first;
+  } // rotateChild()
+
+  // Description: Combine a list of sibling subtrees (a former root's
+  //              children) into one tree with the standard two-pass
+  //              pairing: meld pairs left to right, then meld the results
+  //              right to left.  The pending results are chained through
+  //              their sibling pointers, so no container is needed.
+  // Runtime: O(number of siblings)
+  Node *mergePairs(Node *first) {
+    Node *pending = nullptr;
+    while (first != nullptr) {
+      Node *a = first;
+      Node *b = a->sibling;
+      first = (b == nullptr) ? nullptr : b->sibling;
+      a->parent = nullptr;
+      a->sibling = nullptr;
+      if (b != nullptr) {
+        b->parent = nullptr;
+        b->sibling = nullptr;
+        a = meld(a, b);
+      } // if
+      a->sibling = pending;
+      pending = a;
+    } // while
+
+    Node *result = pending;
+    if (result != nullptr) {
+      pending = result->sibling;
+      result->sibling = nullptr;
+    } // if
+    while (pending != nullptr) {
+      Node *next = pending->sibling;
+      pending->sibling = nullptr;
+      result = meld(result, pending);
+      pending = next;
+    } // while
+    return result;
+  } // mergePairs()
+
   // TODO: Add any additional member variables or member functions you
   // require here.
   // TODO: We recommend creating a 'meld' function (see the Pairing Heap
@@ -299,17 +566,13 @@ private:
     }
     if (this->compare(root->getElt(), newNode->getElt())) {
       root->parent = newNode;
-      if (newNode->child != nullptr) {
-        root->sibling = newNode->child;
-      }
+      root->sibling = newNode->child;
       newNode->child = root;
 
       return newNode;
     } else {
       newNode->parent = root;
-      if (root->child != nullptr && root->child != newNode) {
-        newNode->sibling = root->child;
-      }
+      newNode->sibling = root->child;
       root->child = newNode;
     }
     return root;
@@ -321,6 +584,14 @@ private:
   //       as needed.
   Node *root;
   size_t nodeCount;
+  NodeAllocator nodeAlloc;
 };
 
+namespace pmr {
+// A PairingPQ whose nodes come from a std::pmr::memory_resource.
+template <typename TYPE, typename COMP_FUNCTOR = std::less<TYPE>>
+using PairingPQ =
+    ::PairingPQ<TYPE, COMP_FUNCTOR, std::pmr::polymorphic_allocator<TYPE>>;
+} // namespace pmr
+
 #endif // PAIRINGPQ_H
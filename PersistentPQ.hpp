@@ -0,0 +1,428 @@
+// Project identifier: 43DE0E0C4C76BFAA6D8C2F5AEAE0518A9C42CF4E
+
+#ifndef PERSISTENTPQ_H
+#define PERSISTENTPQ_H
+
+#include <cstddef>
+#include <memory>
+#include <memory_resource>
+#include <utility>
+#include <vector>
+
+#include "Eecs281PQ.hpp"
+#include "MemoryUsage.hpp"
+
+// A persistent leftist heap: copies share their nodes, so copying a PQ is
+// O(1) however large it is.  Nodes are reference counted and never changed
+// while shared; push() and pop() meld along the right spines, which are
+// O(log(n)) long, and copy only the shared nodes on that path.  Nodes that
+// are not shared (e.g. once a copy has diverged) are updated in place.
+//
+// The reference counts are not atomic: PQs that share nodes must be used
+// from one thread at a time.  Copies share the original's allocator, since
+// a shared node may be released by either of them.
+// Nodes are obtained from the optional ALLOCATOR, rebound to Node.
+template <typename TYPE, typename COMP_FUNCTOR = std::less<TYPE>,
+          typename ALLOCATOR = std::allocator<TYPE>>
+class PersistentPQ : public Eecs281PQ<TYPE, COMP_FUNCTOR> {
+  // This is a way to refer to the base class object.
+  using BaseClass = Eecs281PQ<TYPE, COMP_FUNCTOR>;
+
+public:
+  using allocator_type = ALLOCATOR;
+
+  // Description: Construct an empty PQ with an optional comparison functor
+  //              and allocator.
+  // Runtime: O(1)
+  explicit PersistentPQ(COMP_FUNCTOR comp = COMP_FUNCTOR(),
+                        const ALLOCATOR &alloc = ALLOCATOR())
+      : BaseClass{comp}, nodeAlloc{alloc} {} // PersistentPQ()
+
+  // Description: Construct a PQ out of an iterator range with an optional
+  //              comparison functor and allocator.
+  // Runtime: O(n) where n is number of elements in range.
+  template <typename InputIterator>
+  PersistentPQ(InputIterator start, InputIterator end,
+               COMP_FUNCTOR comp = COMP_FUNCTOR(),
+               const ALLOCATOR &alloc = ALLOCATOR())
+      : BaseClass{comp}, nodeAlloc{alloc} {
+    std::vector<Node *> singles;
+    for (InputIterator it = start; it != end; ++it) {
+      singles.push_back(createNode(*it, nullptr, nullptr));
+    } // for ..it
+    nodeCount = singles.size();
+    root = meldAll(singles);
+  } // PersistentPQ()
+
+  // Description: Copy constructor.  The copy shares every node (and the
+  //              allocator) with 'other'.
+  // Runtime: O(1)
+  PersistentPQ(const PersistentPQ &other)
+      : BaseClass{other.compare}, root{retain(other.root)},
+        nodeCount{other.nodeCount}, nodeAlloc{other.nodeAlloc} {
+  } // PersistentPQ()
+
+  // Description: Move constructor.
+  // Runtime: O(1)
+  PersistentPQ(PersistentPQ &&other) noexcept
+      : BaseClass{std::move(other)}, root{other.root},
+        nodeCount{other.nodeCount}, nodeAlloc{other.nodeAlloc} {
+    other.root = nullptr;
+    other.nodeCount = 0;
+  } // PersistentPQ()
+
+  // Description: Copy assignment operator.  Nodes are shared when the
+  //              allocators compare equal or the allocator propagates;
+  //              otherwise (e.g. pmr allocators on different resources)
+  //              the elements are copied into nodes from our allocator.
+  // Runtime: O(1), or O(n) for unequal non-propagating allocators.
+  PersistentPQ &operator=(const PersistentPQ &rhs) {
+    if (this == &rhs) {
+      return *this;
+    } // if
+    Node *shared = nullptr;
+    if (!(nodeAlloc == rhs.nodeAlloc) &&
+        !NodeTraits::propagate_on_container_copy_assignment::value) {
+      std::vector<Node *> singles;
+      forEachNode(rhs.root, [&](const Node *node) {
+        singles.push_back(createNode(node->elt, nullptr, nullptr));
+      });
+      shared = meldAll(singles);
+    } else {
+      shared = retain(rhs.root);
+    } // if
+    release(root);
+    if constexpr (NodeTraits::propagate_on_container_copy_assignment::value) {
+      nodeAlloc = rhs.nodeAlloc;
+    } // if
+    root = shared;
+    nodeCount = rhs.nodeCount;
+    this->compare = rhs.compare;
+    return *this;
+  } // operator=()
+
+  // Description: Move assignment operator, with the same rules for the
+  //              allocator as PairingPQ.
+  // Runtime: O(1), or O(n) for unequal non-propagating allocators.
+  PersistentPQ &operator=(PersistentPQ &&rhs) noexcept(
+      NodeTraits::propagate_on_container_move_assignment::value ||
+      NodeTraits::is_always_equal::value) {
+    if constexpr (NodeTraits::propagate_on_container_move_assignment::value) {
+      std::swap(nodeAlloc, rhs.nodeAlloc);
+    } else {
+      if (!(nodeAlloc == rhs.nodeAlloc)) {
+        return *this = static_cast<const PersistentPQ &>(rhs);
+      } // if
+    }   // if
+    std::swap(root, rhs.root);
+    std::swap(nodeCount, rhs.nodeCount);
+    std::swap(this->compare, rhs.compare);
+    return *this;
+  } // operator=()
+
+  // Description: Destructor.  Frees the nodes no other copy still uses.
+  // Runtime: O(number of unshared nodes)
+  ~PersistentPQ() { release(root); } // ~PersistentPQ()
+
+  // Description: Assumes that all elements inside the PQ are out of order
+  //              and 'rebuilds' it.  The elements are copied into new
+  //              nodes, so that other copies still sharing the old nodes
+  //              are not affected.
+  // Runtime: O(n)
+  virtual void updatePriorities() {
+    std::vector<Node *> singles;
+    singles.reserve(nodeCount);
+    forEachNode(root, [&](const Node *node) {
+      singles.push_back(createNode(node->elt, nullptr, nullptr));
+    });
+    release(root);
+    root = meldAll(singles);
+  } // updatePriorities()
+
+  // Description: Add a new element to the PQ.
+  // Runtime: O(log(n))
+  virtual void push(const TYPE &val) {
+    root = meld(root, createNode(val, nullptr, nullptr));
+    ++nodeCount;
+  } // push()
+
+  // Description: Remove the most extreme (defined by 'compare') element
+  //              from the PQ.
+  // Runtime: O(log(n))
+  virtual void pop() {
+    Node *left = root->left;
+    Node *right = root->right;
+    if (root->refs == 1) {
+      destroyNode(root);
+    } else {
+      retain(left);
+      retain(right);
+      --root->refs;
+    } // if
+    root = meld(left, right);
+    --nodeCount;
+  } // pop()
+
+  // Description: Remove the most extreme element and add 'val'.  When no
+  //              copy shares the root, its node is reused for 'val';
+  //              otherwise this is a pop() and a push().
+  // Runtime: O(log(n))
+  virtual void replaceTop(const TYPE &val) {
+    if (root->refs != 1) {
+      pop();
+      push(val);
+      return;
+    } // if
+    Node *node = root;
+    Node *rest = meld(node->left, node->right);
+    node->elt = val;
+    node->left = nullptr;
+    node->right = nullptr;
+    node->rank = 1;
+    root = meld(rest, node);
+  } // replaceTop()
+
+  // Description: Meld a copy of every element of 'other' into this PQ.
+  //              'other' is not changed; the two PQs share its nodes.
+  // Runtime: O(log(n) + log(m)), or O(m log(n + m)) when the allocators
+  //          differ.
+  void merge(const PersistentPQ &other) {
+    if (nodeAlloc == other.nodeAlloc) {
+      // A self-merge is fine: the extra reference keeps the nodes shared.
+      Node *shared = retain(other.root);
+      nodeCount += other.nodeCount;
+      root = meld(root, shared);
+    } else {
+      forEachNode(other.root, [&](const Node *node) { push(node->elt); });
+    } // if
+  } // merge()
+
+  // Description: Remove every element for which 'pred' returns true.  The
+  //              survivors are rebuilt into fresh nodes, leaving copies
+  //              that share the old ones alone; if nothing matches, the
+  //              heap is not touched.  Returns the number removed.
+  // Runtime: O(n)
+  template <typename PREDICATE> std::size_t eraseIf(PREDICATE pred) {
+    std::vector<const Node *> survivors;
+    survivors.reserve(nodeCount);
+    forEachNode(root, [&](const Node *node) {
+      if (!pred(node->elt)) {
+        survivors.push_back(node);
+      } // if
+    });
+    std::size_t erased = nodeCount - survivors.size();
+    if (erased == 0) {
+      return 0;
+    } // if
+
+    std::vector<Node *> singles;
+    singles.reserve(survivors.size());
+    for (const Node *node : survivors) {
+      singles.push_back(createNode(node->elt, nullptr, nullptr));
+    } // for ..node
+    release(root);
+    root = meldAll(singles);
+    nodeCount = survivors.size();
+    return erased;
+  } // eraseIf()
+
+  // Description: Empty the PQ, writing its elements to 'out' with the most
+  //              extreme first.  Returns the output iterator one past the
+  //              last element written.
+  // Runtime: O(n log(n))
+  template <typename OutputIterator>
+  OutputIterator drainSorted(OutputIterator out) {
+    while (root != nullptr) {
+      *out = root->elt;
+      ++out;
+      pop();
+    } // while
+    return out;
+  } // drainSorted()
+
+  // Description: Empty the PQ and hand back its elements, in no particular
+  //              order, e.g. to bulk-build another PQ from them.
+  // Runtime: O(n)
+  std::vector<TYPE, ALLOCATOR> extractAll() {
+    std::vector<TYPE, ALLOCATOR> result(get_allocator());
+    result.reserve(nodeCount);
+    forEachNode(root, [&](const Node *node) { result.push_back(node->elt); });
+    release(root);
+    root = nullptr;
+    nodeCount = 0;
+    return result;
+  } // extractAll()
+
+  // Description: Return the most extreme (defined by 'compare') element of
+  //              the PQ.
+  // Runtime: O(1)
+  virtual const TYPE &top() const { return root->elt; } // top()
+
+  // Description: Get the number of elements in the PQ.
+  // Runtime: O(1)
+  [[nodiscard]] virtual std::size_t size() const { return nodeCount; }
+
+  // Description: Return true if the PQ is empty.
+  // Runtime: O(1)
+  [[nodiscard]] virtual bool empty() const { return root == nullptr; }
+
+  // Description: Return a copy of the allocator used for the nodes.
+  // Runtime: O(1)
+  allocator_type get_allocator() const { return allocator_type(nodeAlloc); }
+
+  // Description: Return the bytes held for elements and for the nodes
+  //              around them, including an estimate of the allocator's
+  //              per-node overhead.  Nodes shared with copies are counted
+  //              in full by each of them.
+  // Runtime: O(1)
+  [[nodiscard]] MemoryUsage memoryUsage() const {
+    return nodeMemoryUsage<Node, TYPE>(nodeCount);
+  } // memoryUsage()
+
+private:
+  // A leftist heap node.  'rank' is the length of the right spine below
+  // and including the node; the left child never has the smaller rank.
+  struct Node {
+    Node(const TYPE &val, Node *left, Node *right)
+        : elt{val}, left{left}, right{right} {}
+
+    TYPE elt;
+    Node *left;
+    Node *right;
+    std::size_t rank = 1;
+    std::size_t refs = 1;
+  }; // Node
+
+  using NodeAllocator =
+      typename std::allocator_traits<ALLOCATOR>::template rebind_alloc<Node>;
+  using NodeTraits = std::allocator_traits<NodeAllocator>;
+
+  Node *root = nullptr;
+  std::size_t nodeCount = 0;
+  NodeAllocator nodeAlloc;
+
+  // Description: Allocate and construct a node, with one reference.
+  Node *createNode(const TYPE &val, Node *left, Node *right) {
+    Node *node = NodeTraits::allocate(nodeAlloc, 1);
+    try {
+      NodeTraits::construct(nodeAlloc, node, val, left, right);
+    } catch (...) {
+      NodeTraits::deallocate(nodeAlloc, node, 1);
+      throw;
+    }
+    return node;
+  } // createNode()
+
+  // Description: Destroy a node and give its memory back to the allocator.
+  //              Its children are not touched.
+  void destroyNode(Node *node) {
+    NodeTraits::destroy(nodeAlloc, node);
+    NodeTraits::deallocate(nodeAlloc, node, 1);
+  } // destroyNode()
+
+  static std::size_t rankOf(const Node *node) {
+    return node == nullptr ? 0 : node->rank;
+  } // rankOf()
+
+  // Description: Add a reference to 'node' (which may be null) and
+  //              return it.
+  static Node *retain(Node *node) {
+    if (node != nullptr) {
+      ++node->refs;
+    } // if
+    return node;
+  } // retain()
+
+  // Description: Drop a reference to 'node', freeing it and then every
+  //              descendant that is no longer referenced.  The walk uses
+  //              an explicit stack: left spines can be O(n) long.
+  void release(Node *node) {
+    if (node == nullptr || --node->refs != 0) {
+      return;
+    } // if
+    std::vector<Node *> pending{node};
+    while (!pending.empty()) {
+      Node *current = pending.back();
+      pending.pop_back();
+      for (Node *child : {current->left, current->right}) {
+        if (child != nullptr && --child->refs == 0) {
+          pending.push_back(child);
+        } // if
+      }   // for ..child
+      destroyNode(current);
+    } // while
+  }   // release()
+
+  // Description: Call 'func' on every node below and including 'node'.
+  template <typename FUNC> static void forEachNode(const Node *node,
+                                                   FUNC &&func) {
+    if (node == nullptr) {
+      return;
+    } // if
+    std::vector<const Node *> pending{node};
+    while (!pending.empty()) {
+      const Node *current = pending.back();
+      pending.pop_back();
+      func(current);
+      if (current->left != nullptr) {
+        pending.push_back(current->left);
+      } // if
+      if (current->right != nullptr) {
+        pending.push_back(current->right);
+      } // if
+    }   // while
+  }     // forEachNode()
+
+  // Description: Meld two heaps, taking over one reference to each, and
+  //              return a reference to the result.  The more extreme root
+  //              keeps its left subtree and melds the other heap into its
+  //              right one; a shared root is copied first (path copying).
+  //              The recursion follows right spines only, so its depth is
+  //              O(log(n)).
+  // Runtime: O(log(n))
+  Node *meld(Node *a, Node *b) {
+    if (a == nullptr) {
+      return b;
+    } // if
+    if (b == nullptr) {
+      return a;
+    } // if
+    if (this->compare(a->elt, b->elt)) {
+      std::swap(a, b);
+    } // if
+
+    Node *result = a;
+    if (a->refs != 1) {
+      result = createNode(a->elt, retain(a->left), retain(a->right));
+      --a->refs;
+    } // if
+    result->right = meld(result->right, b);
+    if (rankOf(result->left) < rankOf(result->right)) {
+      std::swap(result->left, result->right);
+    } // if
+    result->rank = rankOf(result->right) + 1;
+    return result;
+  } // meld()
+
+  // Description: Meld a list of single-node heaps into one by repeatedly
+  //              melding neighbours in a queue.
+  // Runtime: O(n)
+  Node *meldAll(std::vector<Node *> &heaps) {
+    if (heaps.empty()) {
+      return nullptr;
+    } // if
+    for (std::size_t front = 0; front + 1 < heaps.size(); front += 2) {
+      heaps.push_back(meld(heaps[front], heaps[front + 1]));
+    } // for ..front
+    return heaps.back();
+  } // meldAll()
+};  // PersistentPQ
+
+namespace pmr {
+// A PersistentPQ whose nodes come from a std::pmr::memory_resource.
+template <typename TYPE, typename COMP_FUNCTOR = std::less<TYPE>>
+using PersistentPQ =
+    ::PersistentPQ<TYPE, COMP_FUNCTOR, std::pmr::polymorphic_allocator<TYPE>>;
+} // namespace pmr
+
+#endif // PERSISTENTPQ_H
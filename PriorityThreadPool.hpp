@@ -0,0 +1,480 @@
+// Project identifier: 43DE0E0C4C76BFAA6D8C2F5AEAE0518A9C42CF4E
+
+#ifndef PRIORITYTHREADPOOL_H
+#define PRIORITYTHREADPOOL_H
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <future>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "BinaryPQ.hpp"
+
+// A job queued in a PriorityThreadPool; run() runs it once.
+class PoolJob {
+public:
+  virtual ~PoolJob() = default;
+  virtual void run() = 0;
+}; // PoolJob
+
+// A PoolJob that calls a function object.
+template <typename FUNC> class PoolJobFor : public PoolJob {
+public:
+  explicit PoolJobFor(FUNC f) : func{std::move(f)} {}
+  void run() override { func(); }
+
+private:
+  FUNC func;
+}; // PoolJobFor
+
+// The element of a pool's queues: a job and its priority.  'seq' numbers
+// the submissions, so that jobs of equal priority run first come, first
+// served.  It is trivially copyable, so the queues move pointers around,
+// not the jobs.
+template <typename PRIORITY> struct PoolTask {
+  PRIORITY priority;
+  std::uint64_t seq;
+  PoolJob *job;
+}; // PoolTask
+
+// Orders PoolTasks for a PQ: the more extreme priority (defined by
+// 'compare') is on top, and then the earlier submission.
+template <typename PRIORITY, typename COMP_FUNCTOR = std::less<PRIORITY>>
+struct PoolTaskComp {
+  COMP_FUNCTOR compare;
+
+  bool operator()(const PoolTask<PRIORITY> &a,
+                  const PoolTask<PRIORITY> &b) const {
+    if (compare(a.priority, b.priority)) {
+      return true;
+    } // if
+    return !compare(b.priority, a.priority) && a.seq > b.seq;
+  } // operator()()
+};  // PoolTaskComp
+
+// A fixed set of worker threads that run jobs most extreme priority first.
+// Instead of one shared queue behind one lock, every worker owns a local
+// queue of type QUEUE, any PQ of PoolTask<PRIORITY> ordered by
+// PoolTaskComp, and its own lock:
+//
+//   - A job submitted by a job running in the pool goes into that worker's
+//     own queue.
+//   - A job submitted from outside goes into the workers' queues in turn,
+//     so outside submitters contend on one lock in 'threads' rather than on
+//     a single one.
+//   - A worker runs the best job of its own queue.  When that is empty it
+//     looks at the best job of every peer and steals a batch of the best
+//     ones from the peer whose top is best: half its queue, up to
+//     kStealBatch jobs.
+//   - Idle workers sleep on a condition variable, which submitters only
+//     touch when someone is asleep.
+//
+// Priorities are only ordered within a queue, so a worker busy with its
+// own queue can run a job while a better one waits in a peer's queue; the
+// peers that are idle take it.
+//
+// submit() and post() block while 'capacity' jobs are queued; trySubmit()
+// and tryPost() fail instead.  Jobs submitted by a running job never block,
+// since every worker could be the one waiting.  wait() blocks until every
+// job submitted so far has finished, and must not be called by a job.  The
+// destructor runs the jobs still queued, then joins the workers.
+template <typename PRIORITY = int, typename COMP_FUNCTOR = std::less<PRIORITY>,
+          typename QUEUE = BinaryPQ<PoolTask<PRIORITY>,
+                                    PoolTaskComp<PRIORITY, COMP_FUNCTOR>>>
+class PriorityThreadPool {
+  using Task = PoolTask<PRIORITY>;
+
+public:
+  // The most jobs a worker steals at once.
+  static constexpr std::size_t kStealBatch = 32;
+
+  // Description: Start 'threads' workers (at least one), with at most
+  //              'capacity' jobs queued, and an optional comparison functor
+  //              for the priorities.
+  // Runtime: O(threads)
+  explicit PriorityThreadPool(
+      std::size_t threads = std::max(1U, std::thread::hardware_concurrency()),
+      std::size_t capacity = std::numeric_limits<std::size_t>::max(),
+      COMP_FUNCTOR comp = COMP_FUNCTOR())
+      : taskComp{comp}, limit{capacity} {
+    threads = std::max<std::size_t>(threads, 1);
+    workers.reserve(threads);
+    for (std::size_t i = 0; i < threads; ++i) {
+      workers.push_back(std::make_unique<Worker>(
+          QUEUE{taskComp}, 0x9E3779B97F4A7C15ULL * (i + 1))); // NOLINT
+    } // for ..i
+    for (std::size_t i = 0; i < threads; ++i) {
+      workers[i]->thread = std::thread{[this, i] { workerLoop(i); }};
+    } // for ..i
+  }   // PriorityThreadPool()
+
+  PriorityThreadPool(const PriorityThreadPool &) = delete;
+  PriorityThreadPool &operator=(const PriorityThreadPool &) = delete;
+
+  // Description: Run the jobs still queued, then stop the workers.
+  ~PriorityThreadPool() {
+    stopping.store(true);
+    {
+      std::lock_guard<std::mutex> lock{sleepMutex};
+      sleepCv.notify_all();
+    }
+    for (auto &worker : workers) {
+      worker->thread.join();
+    } // for ..worker
+  }   // ~PriorityThreadPool()
+
+  // Description: Queue 'func' with 'priority', blocking while the pool is
+  //              full.  Returns a future for its result, or for the
+  //              exception it throws.
+  // Runtime: O(log(n)) for a heap QUEUE.
+  template <typename FUNC>
+  auto submit(const PRIORITY &priority, FUNC &&func)
+      -> std::future<std::invoke_result_t<std::decay_t<FUNC>>> {
+    reserve(true);
+    return enqueueTask(priority, std::forward<FUNC>(func));
+  } // submit()
+
+  // Description: submit() that does not block: returns an empty optional
+  //              if the pool is full.
+  // Runtime: O(log(n)) for a heap QUEUE.
+  template <typename FUNC>
+  auto trySubmit(const PRIORITY &priority, FUNC &&func)
+      -> std::optional<std::future<std::invoke_result_t<std::decay_t<FUNC>>>> {
+    if (!reserve(false)) {
+      return std::nullopt;
+    } // if
+    return enqueueTask(priority, std::forward<FUNC>(func));
+  } // trySubmit()
+
+  // Description: Queue 'func' with 'priority', blocking while the pool is
+  //              full, without a future: the cheapest way to submit.  An
+  //              exception escaping 'func' calls std::terminate().
+  // Runtime: O(log(n)) for a heap QUEUE.
+  template <typename FUNC> void post(const PRIORITY &priority, FUNC &&func) {
+    reserve(true);
+    enqueue(priority, std::forward<FUNC>(func));
+  } // post()
+
+  // Description: post() that does not block: returns false if the pool is
+  //              full.
+  // Runtime: O(log(n)) for a heap QUEUE.
+  template <typename FUNC> bool tryPost(const PRIORITY &priority, FUNC &&func) {
+    if (!reserve(false)) {
+      return false;
+    } // if
+    enqueue(priority, std::forward<FUNC>(func));
+    return true;
+  } // tryPost()
+
+  // Description: Block until every job submitted so far has finished.
+  void wait() {
+    idleWaiters.fetch_add(1);
+    {
+      std::unique_lock<std::mutex> lock{waitMutex};
+      waitCv.wait(lock, [this] { return unfinished.load() == 0; });
+    }
+    idleWaiters.fetch_sub(1);
+  } // wait()
+
+  // Description: wait() for at most 'timeout'.  Returns true if every job
+  //              has finished.
+  template <typename REP, typename PERIOD>
+  bool waitFor(const std::chrono::duration<REP, PERIOD> &timeout) {
+    idleWaiters.fetch_add(1);
+    bool done = false;
+    {
+      std::unique_lock<std::mutex> lock{waitMutex};
+      done = waitCv.wait_for(lock, timeout,
+                             [this] { return unfinished.load() == 0; });
+    }
+    idleWaiters.fetch_sub(1);
+    return done;
+  } // waitFor()
+
+  // Description: Return true if every job submitted so far has finished.
+  // Runtime: O(1)
+  [[nodiscard]] bool idle() const { return unfinished.load() == 0; }
+
+  // Description: Return the number of jobs queued and not started yet.
+  // Runtime: O(1)
+  [[nodiscard]] std::size_t queued() const { return queuedCount.load(); }
+
+  // Description: Return the number of workers.
+  // Runtime: O(1)
+  [[nodiscard]] std::size_t threads() const { return workers.size(); }
+
+private:
+  // A worker's queue and lock, on cache lines of their own.
+  struct alignas(64) Worker {
+    Worker(QUEUE q, std::uint64_t seed) : queue{std::move(q)}, random{seed} {}
+
+    std::mutex lock;
+    QUEUE queue;
+    std::thread thread;
+    std::uint64_t random; // picks the peer takeLocal() looks at
+  }; // Worker
+
+  PoolTaskComp<PRIORITY, COMP_FUNCTOR> taskComp;
+  std::vector<std::unique_ptr<Worker>> workers;
+  const std::size_t limit;
+  // Jobs queued and not taken by a worker yet, including reservations.
+  std::atomic<std::size_t> queuedCount{0};
+  // Jobs submitted and not finished yet.
+  std::atomic<std::size_t> unfinished{0};
+  std::atomic<std::uint64_t> nextSeq{0};
+  std::atomic<std::size_t> nextWorker{0};
+  std::atomic<bool> stopping{false};
+
+  // Idle workers sleep here.  'sleepers' counts them, so submitters only
+  // lock sleepMutex when someone may need waking.
+  std::mutex sleepMutex;
+  std::condition_variable sleepCv;
+  std::atomic<std::size_t> sleepers{0};
+
+  // wait() and blocked submitters sleep here.  They are counted apart, so
+  // that workers only lock waitMutex when the last job finishes while
+  // someone waits for that, or a job is taken while a submitter waits for
+  // room.
+  std::mutex waitMutex;
+  std::condition_variable waitCv;
+  std::atomic<std::size_t> idleWaiters{0};
+  std::atomic<std::size_t> blockedSubmitters{0};
+
+  // The pool and worker the current thread runs for, if any.
+  static inline thread_local const PriorityThreadPool *currentPool = nullptr;
+  static inline thread_local std::size_t currentWorker = 0;
+
+  // Description: Return true if the current thread is one of the workers.
+  bool inWorker() const { return currentPool == this; }
+
+  // Description: Reserve room for one job.  Waits for room if 'block',
+  //              unless called from a worker, which never waits.  Returns
+  //              false if there was no room and it did not wait.
+  bool reserve(bool block) {
+    if (inWorker()) {
+      queuedCount.fetch_add(1);
+      return true;
+    } // if
+    std::size_t count = queuedCount.load();
+    while (true) {
+      if (count < limit) {
+        if (queuedCount.compare_exchange_weak(count, count + 1)) {
+          return true;
+        } // if
+        continue;
+      } // if
+      if (!block) {
+        return false;
+      } // if
+      blockedSubmitters.fetch_add(1);
+      {
+        std::unique_lock<std::mutex> lock{waitMutex};
+        waitCv.wait(lock, [this] { return queuedCount.load() < limit; });
+      }
+      blockedSubmitters.fetch_sub(1);
+      count = queuedCount.load();
+    } // while
+  }   // reserve()
+
+  // Description: enqueue() a job that sets a future.
+  template <typename FUNC>
+  auto enqueueTask(const PRIORITY &priority, FUNC &&func)
+      -> std::future<std::invoke_result_t<std::decay_t<FUNC>>> {
+    using Result = std::invoke_result_t<std::decay_t<FUNC>>;
+    std::packaged_task<Result()> task;
+    std::future<Result> result;
+    try {
+      task = std::packaged_task<Result()>{std::forward<FUNC>(func)};
+      result = task.get_future();
+    } catch (...) {
+      unreserve();
+      throw;
+    } // try
+    enqueue(priority, std::move(task));
+    return result;
+  } // enqueueTask()
+
+  // Description: Queue 'func' in the slot reserve() made for it: in the
+  //              current worker's own queue if called from a job, otherwise
+  //              in the next worker's queue in turn.  Wakes a worker if any
+  //              is asleep.
+  template <typename FUNC> void enqueue(const PRIORITY &priority, FUNC &&func) {
+    unfinished.fetch_add(1);
+    std::size_t target =
+        inWorker() ? currentWorker
+                   : nextWorker.fetch_add(1, std::memory_order_relaxed) %
+                         workers.size();
+    try {
+      auto job = std::make_unique<PoolJobFor<std::decay_t<FUNC>>>(
+          std::forward<FUNC>(func));
+      Worker &worker = *workers[target];
+      std::lock_guard<std::mutex> lock{worker.lock};
+      worker.queue.push(Task{priority, nextSeq.fetch_add(1), job.get()});
+      job.release(); // NOLINT: the queue owns it now
+    } catch (...) {
+      if (unfinished.fetch_sub(1) == 1) {
+        notifyWaiters(idleWaiters);
+      } // if
+      unreserve();
+      throw;
+    } // try
+    if (sleepers.load() > 0) {
+      std::lock_guard<std::mutex> lock{sleepMutex};
+      sleepCv.notify_one();
+    } // if
+  }   // enqueue()
+
+  // Description: Give back a reservation that was not used.
+  void unreserve() {
+    queuedCount.fetch_sub(1);
+    notifyWaiters(blockedSubmitters);
+  } // unreserve()
+
+  // Description: Wake everyone waiting on waitCv if 'count' of them are
+  //              waiting for the change just made.
+  void notifyWaiters(const std::atomic<std::size_t> &count) {
+    if (count.load() > 0) {
+      std::lock_guard<std::mutex> lock{waitMutex};
+      waitCv.notify_all();
+    } // if
+  }   // notifyWaiters()
+
+  // Description: Take the best job of worker 'self''s own queue into
+  //              'task', unless a random peer's queue, if its lock is free,
+  //              has a better one: then take that.  Returns false if both
+  //              are empty.
+  bool takeLocal(std::size_t self, Task &task) {
+    Worker &worker = *workers[self];
+    std::lock_guard<std::mutex> lock{worker.lock};
+    if (workers.size() > 1) {
+      // xorshift64
+      worker.random ^= worker.random << 13; // NOLINT
+      worker.random ^= worker.random >> 7;  // NOLINT
+      worker.random ^= worker.random << 17; // NOLINT
+      std::size_t offset = 1 + worker.random % (workers.size() - 1);
+      Worker &peer = *workers[(self + offset) % workers.size()];
+      std::unique_lock<std::mutex> peerLock{peer.lock, std::try_to_lock};
+      if (peerLock && !peer.queue.empty() &&
+          (worker.queue.empty() ||
+           taskComp(worker.queue.top(), peer.queue.top()))) {
+        task = peer.queue.top();
+        peer.queue.pop();
+        return true;
+      } // if
+    }   // if
+    if (worker.queue.empty()) {
+      return false;
+    } // if
+    task = worker.queue.top();
+    worker.queue.pop();
+    return true;
+  } // takeLocal()
+
+  // Description: Steal a batch of the best jobs from the peer whose best
+  //              job is best, run the first (into 'task') and queue the
+  //              rest in worker 'self''s own queue.  Returns false if no
+  //              peer had a job.
+  bool steal(std::size_t self, Task &task) {
+    const std::size_t count = workers.size();
+    std::optional<Task> best;
+    std::size_t victim = self;
+    for (std::size_t offset = 1; offset < count; ++offset) {
+      std::size_t peer = (self + offset) % count;
+      Worker &worker = *workers[peer];
+      std::lock_guard<std::mutex> lock{worker.lock};
+      if (!worker.queue.empty() &&
+          (!best || taskComp(*best, worker.queue.top()))) {
+        best = worker.queue.top();
+        victim = peer;
+      } // if
+    }   // for ..offset
+    if (!best) {
+      return false;
+    } // if
+
+    std::vector<Task> batch;
+    {
+      Worker &worker = *workers[victim];
+      std::lock_guard<std::mutex> lock{worker.lock};
+      std::size_t size = worker.queue.size();
+      std::size_t take = std::min(kStealBatch, (size + 1) / 2);
+      batch.reserve(take);
+      for (std::size_t i = 0; i < take; ++i) {
+        batch.push_back(worker.queue.top());
+        worker.queue.pop();
+      } // for ..i
+    }
+    if (batch.empty()) {
+      return false; // another worker got there first
+    }               // if
+    task = batch.front();
+    if (batch.size() > 1) {
+      Worker &worker = *workers[self];
+      std::lock_guard<std::mutex> lock{worker.lock};
+      for (std::size_t i = 1; i < batch.size(); ++i) {
+        worker.queue.push(batch[i]);
+      } // for ..i
+    }   // if
+    return true;
+  } // steal()
+
+  // Description: Run a job taken from a queue and account for it.
+  void run(const Task &task) {
+    queuedCount.fetch_sub(1);
+    notifyWaiters(blockedSubmitters);
+    std::unique_ptr<PoolJob> job{task.job};
+    job->run();
+    job.reset();
+    if (unfinished.fetch_sub(1) == 1) {
+      notifyWaiters(idleWaiters);
+    } // if
+  } // run()
+
+  // Description: The loop of worker 'self': run jobs, stealing when its
+  //              own queue is empty and sleeping when every queue is.
+  void workerLoop(std::size_t self) {
+    currentPool = this;
+    currentWorker = self;
+    Task task{};
+    while (true) {
+      if (takeLocal(self, task) || steal(self, task)) {
+        run(task);
+        continue;
+      } // if
+      std::unique_lock<std::mutex> lock{sleepMutex};
+      // Announce the sleeper before checking for jobs: a submitter either
+      // sees it and wakes us, or we see its job.
+      sleepers.fetch_add(1);
+      sleepCv.wait(lock, [this] {
+        return queuedCount.load() > 0 || stopping.load();
+      });
+      sleepers.fetch_sub(1);
+      if (stopping.load() && queuedCount.load() == 0) {
+        return;
+      } // if
+    }   // while
+  }     // workerLoop()
+};      // PriorityThreadPool
+
+// A PriorityThreadPool whose workers' queues are PQ, e.g.
+// PriorityThreadPoolOf<PairingPQ>.
+template <template <typename...> typename PQ, typename PRIORITY = int,
+          typename COMP_FUNCTOR = std::less<PRIORITY>>
+using PriorityThreadPoolOf =
+    PriorityThreadPool<PRIORITY, COMP_FUNCTOR,
+                       PQ<PoolTask<PRIORITY>,
+                          PoolTaskComp<PRIORITY, COMP_FUNCTOR>>>;
+
+#endif // PRIORITYTHREADPOOL_H
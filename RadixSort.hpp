@@ -0,0 +1,188 @@
+// Project identifier: 43DE0E0C4C76BFAA6D8C2F5AEAE0518A9C42CF4E
+
+#ifndef RADIXSORT_H
+#define RADIXSORT_H
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <limits>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "Eecs281PQ.hpp"
+
+// How radixSort() reads the sort key of a TYPE.  Arithmetic types (but
+// bool) are their own key.  A struct whose operator< compares a single
+// arithmetic member can opt in by specializing RadixKey with a static
+// key() that returns that member, e.g.
+//
+//   template <> struct RadixKey<Job> {
+//     static std::uint32_t key(const Job &job) { return job.deadline; }
+//   };
+//
+// radixSort() then orders Jobs by key() alone, so the specialization must
+// agree with operator< (and operator>), or std::less<Job> and radixSort()
+// would sort differently.
+template <typename TYPE, typename = void> struct RadixKey {};
+
+template <typename TYPE>
+struct RadixKey<TYPE, std::enable_if_t<std::is_arithmetic_v<TYPE> &&
+                                       !std::is_same_v<TYPE, bool>>> {
+  static TYPE key(const TYPE &val) { return val; }
+}; // RadixKey
+
+// The unsigned integer the bits of a key of type KEY are ordered as.
+// Floating-point keys need IEEE 754 single or double precision.
+template <typename KEY, typename = void> struct RadixBits {};
+
+template <typename KEY>
+struct RadixBits<KEY, std::enable_if_t<std::is_integral_v<KEY>>> {
+  using Type = std::make_unsigned_t<KEY>;
+};
+
+template <typename KEY>
+struct RadixBits<KEY, std::enable_if_t<std::is_floating_point_v<KEY> &&
+                                       std::numeric_limits<KEY>::is_iec559 &&
+                                       sizeof(KEY) == sizeof(std::uint32_t)>> {
+  using Type = std::uint32_t;
+};
+
+template <typename KEY>
+struct RadixBits<KEY, std::enable_if_t<std::is_floating_point_v<KEY> &&
+                                       std::numeric_limits<KEY>::is_iec559 &&
+                                       sizeof(KEY) == sizeof(std::uint64_t)>> {
+  using Type = std::uint64_t;
+};
+
+// True when TYPE has a RadixKey whose key has RadixBits.
+template <typename TYPE, typename = void>
+struct HasRadixKey : std::false_type {};
+
+template <typename TYPE>
+struct HasRadixKey<
+    TYPE,
+    std::void_t<typename RadixBits<std::decay_t<decltype(RadixKey<TYPE>::key(
+        std::declval<const TYPE &>()))>>::Type>> : std::true_type {};
+
+// Whether radixSort() can put elements of TYPE in the order COMP_FUNCTOR
+// sorts them ascending in, and which way: std::less sorts by increasing
+// key, std::greater by decreasing key.  Any other comparator cannot be
+// told apart from a custom one, so it is not sortable.
+template <typename TYPE, typename COMP_FUNCTOR> struct RadixOrder {
+  static constexpr bool descending =
+      std::is_same_v<COMP_FUNCTOR, std::greater<TYPE>> ||
+      std::is_same_v<COMP_FUNCTOR, std::greater<>>;
+  static constexpr bool sortable =
+      HasRadixKey<TYPE>::value && std::is_default_constructible_v<TYPE> &&
+      (descending || std::is_same_v<COMP_FUNCTOR, std::less<TYPE>> ||
+       std::is_same_v<COMP_FUNCTOR, std::less<>>);
+}; // RadixOrder
+
+// Below this many elements, std::sort is as fast as the passes over the
+// counts, so sortByCompare() leaves them to it.
+constexpr std::size_t kRadixMinSize = 256;
+
+// Description: Map 'key' to an unsigned integer with the same order.
+//              Signed integers get their sign bit flipped.  Non-negative
+//              floats get their sign bit set, and negative ones all their
+//              bits flipped, so that more negative ones come first; -0.0
+//              comes right before +0.0, and NaNs beyond the infinities of
+//              their sign.
+template <typename KEY>
+typename RadixBits<KEY>::Type radixBitsOf(const KEY &key) {
+  using Bits = typename RadixBits<KEY>::Type;
+  constexpr Bits kSign = Bits{1} << (std::numeric_limits<Bits>::digits - 1);
+  if constexpr (std::is_floating_point_v<KEY>) {
+    Bits bits = 0;
+    std::memcpy(&bits, &key, sizeof(bits));
+    return (bits & kSign) != 0 ? static_cast<Bits>(~bits)
+                               : static_cast<Bits>(bits | kSign);
+  } else if constexpr (std::is_signed_v<KEY>) {
+    return static_cast<Bits>(static_cast<Bits>(key) ^ kSign);
+  } else {
+    return key;
+  } // if
+} // radixBitsOf()
+
+// Description: Sort 'data' by RadixKey<TYPE>::key(), increasing, or
+//              decreasing if 'descending', with a least significant digit
+//              first radix sort of one byte per pass.  The counts of every
+//              pass are taken in one read of the data, and passes whose
+//              byte is the same in all keys are skipped.  The sort is
+//              stable.  The scratch vector uses the data's allocator.
+// Runtime: O(n sizeof(key)), with 2 n moves per pass made.
+template <typename TYPE, typename ALLOCATOR>
+void radixSort(std::vector<TYPE, ALLOCATOR> &data, bool descending) {
+  using Bits = typename RadixBits<std::decay_t<decltype(RadixKey<TYPE>::key(
+      std::declval<const TYPE &>()))>>::Type;
+  constexpr std::size_t kDigitBits = 8;
+  constexpr std::size_t kBuckets = std::size_t{1} << kDigitBits;
+  constexpr std::size_t kDigits = sizeof(Bits);
+
+  // Decreasing keys sort as increasing complements.
+  auto bitsOf = [descending](const TYPE &val) {
+    Bits bits = radixBitsOf(RadixKey<TYPE>::key(val));
+    return descending ? static_cast<Bits>(~bits) : bits;
+  };
+  auto digitOf = [](Bits bits, std::size_t digit) {
+    return static_cast<std::size_t>(
+        (bits >> (digit * kDigitBits)) & (kBuckets - 1));
+  };
+
+  std::vector<std::array<std::size_t, kBuckets>> counts(kDigits);
+  for (const auto &val : data) {
+    Bits bits = bitsOf(val);
+    for (std::size_t digit = 0; digit < kDigits; ++digit) {
+      ++counts[digit][digitOf(bits, digit)];
+    } // for ..digit
+  }   // for ..val
+
+  std::vector<TYPE, ALLOCATOR> scratch(data.get_allocator());
+  for (std::size_t digit = 0; digit < kDigits; ++digit) {
+    auto &offsets = counts[digit];
+    if (std::find(offsets.begin(), offsets.end(), data.size()) !=
+        offsets.end()) {
+      continue;
+    } // if
+    if (scratch.empty()) {
+      scratch.resize(data.size());
+    } // if
+    std::size_t offset = 0;
+    for (auto &count : offsets) {
+      offset += std::exchange(count, offset);
+    } // for ..count
+    for (auto &val : data) {
+      scratch[offsets[digitOf(bitsOf(val), digit)]++] = std::move(val);
+    } // for ..val
+    data.swap(scratch);
+  } // for ..digit
+} // radixSort()
+
+// Description: Sort 'data' so that 'compare' finds it ascending: with
+//              radixSort() if RadixOrder allows it and there are at least
+//              kRadixMinSize elements, or else with std::sort, which is
+//              also what runs in a constant expression.
+// Runtime: O(n) for radix-sortable elements, O(n log(n)) otherwise.
+template <typename TYPE, typename ALLOCATOR, typename COMP_FUNCTOR>
+PQ_CONSTEXPR void sortByCompare(std::vector<TYPE, ALLOCATOR> &data,
+                                const COMP_FUNCTOR &compare) {
+  using Order = RadixOrder<TYPE, COMP_FUNCTOR>;
+  if constexpr (Order::sortable) {
+#if PQ_HAS_CONSTEXPR
+    if (!std::is_constant_evaluated() && data.size() >= kRadixMinSize) {
+#else
+    if (data.size() >= kRadixMinSize) {
+#endif
+      radixSort(data, Order::descending);
+      return;
+    } // if
+  }   // if
+  std::sort(data.begin(), data.end(), compare);
+} // sortByCompare()
+
+#endif // RADIXSORT_H
@@ -0,0 +1,328 @@
+// Project identifier: 43DE0E0C4C76BFAA6D8C2F5AEAE0518A9C42CF4E
+
+#ifndef RECORDINGPQ_H
+#define RECORDINGPQ_H
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <functional>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <typeinfo>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "Eecs281PQ.hpp"
+
+// Binary PQ operation traces, written by RecordingPQ and replayed by
+// replayTrace() (TraceReplay.hpp).  A trace is a TraceHeader followed by
+// records, each an opcode byte and its operands in native byte order, with
+// no alignment padding:
+//
+//   Push              value
+//   Pop
+//   Top               value returned
+//   UpdatePriorities
+//   ReplaceTop        value
+//   PushPop           value pushed, value returned
+//   UpdateElt         uint64 push number of the node, old value, new value
+//   Phase             uint16 name length, name bytes
+//
+// Pushes are numbered from 0 in trace order, which is how UpdateElt names
+// the element it changes.  Values are the raw bytes of the element, so the
+// element type must be trivially copyable; the header records which
+// arithmetic type and standard comparator it was, so that a replay tool
+// can pick the same ones.  It also records a hash of the recorded PQ's
+// type: push numbers name the same nodes only in a PQ of the same type.
+enum class TraceOp : std::uint8_t {
+  Push = 1,
+  Pop,
+  Top,
+  UpdatePriorities,
+  ReplaceTop,
+  PushPop,
+  UpdateElt,
+  Phase,
+}; // TraceOp
+
+// Element types a replay tool knows; Other can be recorded, but only
+// replayed by code that knows the type itself.
+enum class TraceType : std::uint8_t { Other, Int32, Int64, UInt64, Double };
+
+// Comparators a replay tool knows.
+enum class TraceComp : std::uint8_t { Other, Less, Greater };
+
+template <typename TYPE> constexpr TraceType traceTypeOf() {
+  if constexpr (std::is_same_v<TYPE, std::int32_t>) {
+    return TraceType::Int32;
+  } else if constexpr (std::is_same_v<TYPE, std::int64_t>) {
+    return TraceType::Int64;
+  } else if constexpr (std::is_same_v<TYPE, std::uint64_t>) {
+    return TraceType::UInt64;
+  } else if constexpr (std::is_same_v<TYPE, double>) {
+    return TraceType::Double;
+  } else {
+    return TraceType::Other;
+  } // if
+} // traceTypeOf()
+
+template <typename TYPE, typename COMP_FUNCTOR>
+constexpr TraceComp traceCompOf() {
+  if constexpr (std::is_same_v<COMP_FUNCTOR, std::less<TYPE>>) {
+    return TraceComp::Less;
+  } else if constexpr (std::is_same_v<COMP_FUNCTOR, std::greater<TYPE>>) {
+    return TraceComp::Greater;
+  } else {
+    return TraceComp::Other;
+  } // if
+} // traceCompOf()
+
+// Description: A hash (FNV-1a) of the type name of PQ, which is the same
+//              for the same PQ type in every program built by the same
+//              compiler.
+template <typename PQ> std::uint64_t tracePQTypeOf() {
+  std::uint64_t hash = 14695981039346656037ULL; // NOLINT: FNV offset basis
+  for (const char *name = typeid(PQ).name(); *name != '\0'; ++name) {
+    hash = (hash ^ static_cast<unsigned char>(*name)) *
+           1099511628211ULL; // NOLINT: FNV prime
+  } // for ..name
+  return hash;
+} // tracePQTypeOf()
+
+// The fixed-size start of every trace.  'records' and 'hasUpdates' are
+// filled in when the trace is closed.
+struct TraceHeader {
+  char magic[8];                    // NOLINT: "PQTRACE" and a NUL
+  std::uint16_t version;
+  TraceType type;
+  TraceComp comp;
+  std::uint32_t elementSize;
+  std::uint64_t records;
+  std::uint64_t hasUpdates; // nonzero if any UpdateElt was recorded
+  std::uint64_t pqType;     // tracePQTypeOf() the recorded PQ
+};                          // TraceHeader
+
+constexpr char kTraceMagic[8] = {'P', 'Q', 'T', 'R', 'A', 'C', 'E', '\0'};
+constexpr std::uint16_t kTraceVersion = 2;
+
+// Writes trace records to a file through a buffer of its own, so that
+// recording costs about a memcpy per operation.  Throws std::runtime_error
+// if the file cannot be written.
+class TraceWriter {
+public:
+  TraceWriter(const std::string &path, TraceType type, TraceComp comp,
+              std::uint32_t elementSize, std::uint64_t pqType)
+      : file{std::fopen(path.c_str(), "wb")} {
+    if (file == nullptr) {
+      throw std::runtime_error("cannot open trace file " + path);
+    } // if
+    std::memcpy(header.magic, kTraceMagic, sizeof(kTraceMagic));
+    header.version = kTraceVersion;
+    header.type = type;
+    header.comp = comp;
+    header.elementSize = elementSize;
+    header.pqType = pqType;
+    buffer.reserve(kBufferBytes);
+    append(&header, sizeof(header));
+  } // TraceWriter()
+
+  TraceWriter(const TraceWriter &) = delete;
+  TraceWriter &operator=(const TraceWriter &) = delete;
+
+  ~TraceWriter() {
+    try {
+      close();
+    } catch (...) { // NOLINT: a destructor must not throw
+    }               // try
+  }                 // ~TraceWriter()
+
+  // Description: Append one record: an opcode and its operands.
+  template <typename... OPERANDS>
+  void record(TraceOp op, const OPERANDS &...operands) {
+    append(&op, sizeof(op));
+    (append(&operands, sizeof(operands)), ...);
+    ++header.records;
+    if (op == TraceOp::UpdateElt) {
+      header.hasUpdates = 1;
+    } // if
+  }   // record()
+
+  // Description: Append a Phase record.
+  void recordPhase(const std::string &name) {
+    auto length = static_cast<std::uint16_t>(
+        std::min<std::size_t>(name.size(), UINT16_MAX));
+    record(TraceOp::Phase, length);
+    append(name.data(), length);
+  } // recordPhase()
+
+  // Description: Write out the buffer and the final header, and close the
+  //              file.  Later records are ignored.
+  void close() {
+    if (file == nullptr) {
+      return;
+    } // if
+    flush();
+    bool ok = std::fseek(file, 0, SEEK_SET) == 0 &&
+              std::fwrite(&header, sizeof(header), 1, file) == 1;
+    ok = std::fclose(file) == 0 && ok;
+    file = nullptr;
+    if (!ok) {
+      throw std::runtime_error("cannot write trace file");
+    } // if
+  }   // close()
+
+private:
+  static constexpr std::size_t kBufferBytes = std::size_t{1} << 16;
+
+  std::FILE *file;
+  TraceHeader header{};
+  std::vector<char> buffer;
+
+  void append(const void *bytes, std::size_t count) {
+    if (buffer.size() + count > kBufferBytes) {
+      flush();
+    } // if
+    const char *first = static_cast<const char *>(bytes);
+    buffer.insert(buffer.end(), first, first + count);
+  } // append()
+
+  void flush() {
+    if (file == nullptr || buffer.empty()) {
+      return;
+    } // if
+    if (std::fwrite(buffer.data(), 1, buffer.size(), file) != buffer.size()) {
+      throw std::runtime_error("cannot write trace file");
+    } // if
+    buffer.clear();
+  } // flush()
+};  // TraceWriter
+
+// The element type and comparator of a PQ, read off its Eecs281PQ base.
+template <typename PQ> struct PQTypes {
+  template <typename TYPE, typename COMP_FUNCTOR>
+  static std::pair<TYPE, COMP_FUNCTOR>
+  deduce(const Eecs281PQ<TYPE, COMP_FUNCTOR> *);
+
+  using Pair = decltype(deduce(std::declval<const PQ *>()));
+  using Type = typename Pair::first_type;
+  using Comp = typename Pair::second_type;
+}; // PQTypes
+
+// A PQ that forwards every operation to a PQ of type PQ and records it in
+// a trace file.  Use it in place of the PQ in a real program, then replay
+// the trace against other implementations with benchReplay.  addNode()
+// and updateElt() are available when PQ has them (PairingPQ).
+template <typename PQ>
+class RecordingPQ : public Eecs281PQ<typename PQTypes<PQ>::Type,
+                                     typename PQTypes<PQ>::Comp> {
+  using TYPE = typename PQTypes<PQ>::Type;
+  using COMP_FUNCTOR = typename PQTypes<PQ>::Comp;
+  using BaseClass = Eecs281PQ<TYPE, COMP_FUNCTOR>;
+
+  static_assert(std::is_trivially_copyable_v<TYPE>,
+                "trace values are the raw bytes of the elements");
+
+public:
+  // Description: Record the operations on 'inner' to the file at 'path',
+  //              which is created or truncated.
+  // Runtime: O(1)
+  explicit RecordingPQ(const std::string &path, PQ inner = PQ())
+      : pq{std::move(inner)},
+        writer{path, traceTypeOf<TYPE>(), traceCompOf<TYPE, COMP_FUNCTOR>(),
+               static_cast<std::uint32_t>(sizeof(TYPE)),
+               tracePQTypeOf<PQ>()} {} // RecordingPQ()
+
+  // Description: The trace file cannot be shared, so no copies.
+  RecordingPQ(const RecordingPQ &) = delete;
+  RecordingPQ &operator=(const RecordingPQ &) = delete;
+  virtual ~RecordingPQ() = default;
+
+  virtual void push(const TYPE &val) {
+    writer.record(TraceOp::Push, val);
+    pq.push(val);
+    ++pushes;
+  } // push()
+
+  virtual void pop() {
+    writer.record(TraceOp::Pop);
+    pq.pop();
+  } // pop()
+
+  virtual const TYPE &top() const {
+    const TYPE &result = pq.top();
+    writer.record(TraceOp::Top, result);
+    return result;
+  } // top()
+
+  virtual void replaceTop(const TYPE &val) {
+    writer.record(TraceOp::ReplaceTop, val);
+    pq.replaceTop(val);
+  } // replaceTop()
+
+  virtual TYPE pushPop(const TYPE &val) {
+    TYPE result = pq.pushPop(val);
+    writer.record(TraceOp::PushPop, val, result);
+    return result;
+  } // pushPop()
+
+  virtual void updatePriorities() {
+    writer.record(TraceOp::UpdatePriorities);
+    pq.updatePriorities();
+  } // updatePriorities()
+
+  [[nodiscard]] virtual std::size_t size() const { return pq.size(); }
+
+  [[nodiscard]] virtual bool empty() const { return pq.empty(); }
+
+  // Description: push() that returns the inner PQ's handle, and remembers
+  //              which push it was for updateElt().
+  auto *addNode(const TYPE &val) {
+    writer.record(TraceOp::Push, val);
+    auto *node = pq.addNode(val);
+    pushNumbers[node] = pushes++;
+    return node;
+  } // addNode()
+
+  // Description: Change the element of a node returned by addNode().
+  template <typename NODE> void updateElt(NODE *node, const TYPE &val) {
+    TYPE old = node->getElt();
+    writer.record(TraceOp::UpdateElt, pushNumbers.at(node), old, val);
+    pq.updateElt(node, val);
+  } // updateElt()
+
+  // Description: Start a new phase of the trace; replays report the
+  //              throughput of each phase separately.
+  void markPhase(const std::string &name) { writer.recordPhase(name); }
+
+  // Description: Finish the trace file.  Throws std::runtime_error if it
+  //              cannot be written.  Operations after this are no longer
+  //              recorded.
+  void close() { writer.close(); }
+
+  // Description: The PQ being recorded, for operations that are not
+  //              recorded (e.g. memoryUsage()).
+  const PQ &inner() const { return pq; }
+
+private:
+  PQ pq;
+  mutable TraceWriter writer;
+  std::uint64_t pushes = 0;
+  std::unordered_map<const void *, std::uint64_t> pushNumbers;
+}; // RecordingPQ
+
+// Description: Start a new phase if 'pq' records a trace; does nothing for
+//              other PQs, so drivers can mark phases unconditionally.
+template <typename PQ>
+void markPhase(PQ & /*pq*/, const std::string & /*name*/) {}
+
+template <typename PQ>
+void markPhase(RecordingPQ<PQ> &pq, const std::string &name) {
+  pq.markPhase(name);
+} // markPhase()
+
+#endif // RECORDINGPQ_H
@@ -0,0 +1,508 @@
+// Project identifier: 43DE0E0C4C76BFAA6D8C2F5AEAE0518A9C42CF4E
+
+#ifndef SEQUENCEHEAPPQ_H
+#define SEQUENCEHEAPPQ_H
+
+#include <algorithm>
+#include <cstddef>
+#include <iterator>
+#include <limits>
+#include <memory>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "BinaryPQ.hpp"
+#include "Eecs281PQ.hpp"
+#include "LoserTree.hpp"
+#include "MemoryUsage.hpp"
+
+// Sizes of a SequenceHeapPQ, for its SIZES parameter.  INSERT_BYTES is the
+// room for the insertion heap and for each buffer, meant to stay in L1;
+// ARITY is the number of runs a group merges with one loser tree, whose
+// nodes and the runs' heads are meant to stay in L2.
+template <std::size_t INSERT_BYTES = 8192, std::size_t ARITY = 64> // NOLINT
+struct SequenceHeapSizes {
+  static constexpr std::size_t insertBytes = INSERT_BYTES;
+  static constexpr std::size_t arity = ARITY;
+}; // SequenceHeapSizes
+
+// A specialized version of the priority queue ADT implemented as Sanders'
+// sequence heap ("Fast Priority Queues for Cached Memory", 2000), for
+// queues too large for the caches, where a binary heap misses the cache on
+// almost every level and a pairing heap on almost every node.  Elements
+// move through it in sorted runs, which are only ever read and written
+// sequentially:
+//
+//   - New elements go into a small insertion heap of m elements.  When it
+//     is full, it is sorted into a run of group 0.
+//   - Group g holds up to k runs of up to m k^g elements.  When it is full,
+//     its runs are merged into one run of group g + 1.
+//   - Each group has a buffer of up to m of its most extreme elements,
+//     refilled by merging its runs with a LoserTree, and the deletion
+//     buffer holds up to m of the most extreme elements of all groups,
+//     refilled from the group buffers.
+//
+// top() is the more extreme of the insertion heap's top and the deletion
+// buffer's first element.  Buffers hold on to the most extreme elements,
+// so whenever new elements join a group, they are merged with its buffer
+// (and the deletion buffer), and the most extreme of them all go back to
+// the buffers.  Every element is merged about log_k(n / m) times, with
+// log2(k) comparisons each time: about log2(n) comparisons in all, like a
+// binary heap, but streaming through memory.
+//
+// m = SIZES::insertBytes / sizeof(TYPE), at least 4, and k = SIZES::arity.
+// All memory is obtained from the optional ALLOCATOR, rebound as needed.
+template <typename TYPE, typename COMP_FUNCTOR = std::less<TYPE>,
+          typename ALLOCATOR = std::allocator<TYPE>,
+          typename SIZES = SequenceHeapSizes<>>
+class SequenceHeapPQ : public Eecs281PQ<TYPE, COMP_FUNCTOR> {
+  // This is a way to refer to the base class object.
+  using BaseClass = Eecs281PQ<TYPE, COMP_FUNCTOR>;
+
+  // A run is sorted with the least extreme element first, so the most
+  // extreme one is at back() and leaves with pop_back().  Buffers are kept
+  // in the same order.
+  using Run = std::vector<TYPE, ALLOCATOR>;
+  using RunAllocator =
+      typename std::allocator_traits<ALLOCATOR>::template rebind_alloc<Run>;
+  using Runs = std::vector<Run, RunAllocator>;
+  using GroupAllocator =
+      typename std::allocator_traits<ALLOCATOR>::template rebind_alloc<Runs>;
+  using InsertHeap = BinaryPQ<TYPE, COMP_FUNCTOR, ALLOCATOR>;
+
+public:
+  using allocator_type = ALLOCATOR;
+
+  // The capacity m of the insertion heap and of each buffer.
+  static constexpr std::size_t kInsertSize =
+      std::max<std::size_t>(4, SIZES::insertBytes / sizeof(TYPE));
+  // The number k of runs in a group.
+  static constexpr std::size_t kArity = SIZES::arity;
+  static_assert(kArity >= 2, "a group merges at least two runs");
+
+  // Description: Construct an empty PQ with an optional comparison functor
+  //              and allocator.
+  // Runtime: O(1)
+  explicit SequenceHeapPQ(COMP_FUNCTOR comp = COMP_FUNCTOR(),
+                          const ALLOCATOR &alloc = ALLOCATOR())
+      : BaseClass{comp}, insertHeap{comp, alloc}, deletion(alloc),
+        buffers(RunAllocator(alloc)),
+        groups(GroupAllocator(alloc)) {} // SequenceHeapPQ()
+
+  // Description: Construct a PQ out of an iterator range with an optional
+  //              comparison functor and allocator.  More than m elements
+  //              are sorted into a single run, of the group it fits in.
+  // Runtime: O(n log(n)) where n is number of elements in range.
+  template <typename InputIterator>
+  SequenceHeapPQ(InputIterator start, InputIterator end,
+                 COMP_FUNCTOR comp = COMP_FUNCTOR(),
+                 const ALLOCATOR &alloc = ALLOCATOR())
+      : SequenceHeapPQ{comp, alloc} {
+    rebuild(Run(start, end, alloc));
+  } // SequenceHeapPQ()
+
+  // Copies copy every run and buffer as it is.  The allocator is chosen
+  // and propagated the way the standard containers do it.
+  SequenceHeapPQ(const SequenceHeapPQ &other) = default;
+  SequenceHeapPQ &operator=(const SequenceHeapPQ &rhs) = default;
+
+  // Description: Move constructor.  Takes over the other PQ's runs and
+  //              leaves it empty.
+  // Runtime: O(1)
+  SequenceHeapPQ(SequenceHeapPQ &&other) noexcept
+      : BaseClass{std::move(other)}, insertHeap{std::move(other.insertHeap)},
+        deletion{std::move(other.deletion)},
+        buffers{std::move(other.buffers)}, groups{std::move(other.groups)},
+        groupCount{std::exchange(other.groupCount, 0)} {} // SequenceHeapPQ()
+
+  // Description: Move assignment operator.  The containers are moved the
+  //              way std::vector moves them, which copies the elements for
+  //              unequal non-propagating allocators; 'rhs' is left empty
+  //              either way.
+  // Runtime: O(1), or O(n) for unequal non-propagating allocators.
+  SequenceHeapPQ &operator=(SequenceHeapPQ &&rhs) noexcept(
+      std::is_nothrow_move_assignable_v<Run>) {
+    if (&rhs == this) {
+      return *this;
+    } // if
+    BaseClass::operator=(std::move(rhs));
+    insertHeap = std::move(rhs.insertHeap);
+    deletion = std::move(rhs.deletion);
+    buffers = std::move(rhs.buffers);
+    groups = std::move(rhs.groups);
+    groupCount = std::exchange(rhs.groupCount, 0);
+    rhs.insertHeap.extractAll();
+    rhs.clearGroups();
+    return *this;
+  } // operator=()
+
+  virtual ~SequenceHeapPQ() = default;
+
+  // Description: Assumes that all elements inside the PQ are out of order
+  //              and rebuilds it from scratch, like the range constructor.
+  // Runtime: O(n log(n))
+  virtual void updatePriorities() { rebuild(extractAll()); }
+
+  // Description: Add a new element to the PQ.  Every m-th push sorts the
+  //              insertion heap into a run, which may merge full groups.
+  // Runtime: O(log(n)) amortized.
+  virtual void push(const TYPE &val) {
+    if (insertHeap.size() == kInsertSize) {
+      flushInsertHeap();
+    } // if
+    insertHeap.push(val);
+  } // push()
+
+  // Description: Remove the most extreme (defined by 'compare') element
+  //              from the PQ.
+  // Runtime: O(log(n)) amortized.
+  virtual void pop() {
+    if (!topInDeletion()) {
+      insertHeap.pop();
+      return;
+    } // if
+    deletion.pop_back();
+    if (deletion.empty()) {
+      refillDeletion();
+    } // if
+  } // pop()
+
+  // Description: Replace the most extreme element with 'val'.  When it is
+  //              the insertion heap's top, that heap does it in one sift.
+  // Runtime: O(log(n)) amortized.
+  virtual void replaceTop(const TYPE &val) {
+    if (!topInDeletion()) {
+      insertHeap.replaceTop(val);
+      return;
+    } // if
+    pop();
+    push(val);
+  } // replaceTop()
+
+  // Description: Return the most extreme (defined by 'compare') element of
+  //              the PQ.
+  // Runtime: O(1)
+  virtual const TYPE &top() const {
+    return topInDeletion() ? deletion.back() : insertHeap.top();
+  } // top()
+
+  // Description: Get the number of elements in the PQ.
+  // Runtime: O(1)
+  [[nodiscard]] virtual std::size_t size() const {
+    return insertHeap.size() + deletion.size() + groupCount;
+  } // size()
+
+  // Description: Return true if the PQ is empty.
+  // Runtime: O(1)
+  [[nodiscard]] virtual bool empty() const { return size() == 0; }
+
+  // Description: Empty the PQ and hand back its elements, in no particular
+  //              order, e.g. to bulk-build another PQ from them.
+  // Runtime: O(n)
+  std::vector<TYPE, ALLOCATOR> extractAll() {
+    std::size_t total = size();
+    Run result = insertHeap.extractAll();
+    result.reserve(total);
+    result.insert(result.end(), std::make_move_iterator(deletion.begin()),
+                  std::make_move_iterator(deletion.end()));
+    for (auto &buffer : buffers) {
+      result.insert(result.end(), std::make_move_iterator(buffer.begin()),
+                    std::make_move_iterator(buffer.end()));
+    } // for ..buffer
+    for (auto &group : groups) {
+      for (auto &run : group) {
+        result.insert(result.end(), std::make_move_iterator(run.begin()),
+                      std::make_move_iterator(run.end()));
+      } // for ..run
+    }   // for ..group
+    clearGroups();
+    return result;
+  } // extractAll()
+
+  // Description: Empty the PQ, writing its elements to 'out' with the most
+  //              extreme first.  Returns the output iterator one past the
+  //              last element written.
+  // Runtime: O(n log(n))
+  template <typename OutputIterator>
+  OutputIterator drainSorted(OutputIterator out) {
+    Run all = extractAll();
+    std::sort(all.begin(), all.end(), this->compare);
+    return std::move(all.rbegin(), all.rend(), out);
+  } // drainSorted()
+
+  // Description: Remove every element for which 'pred' returns true.  Runs
+  //              and buffers stay sorted, so nothing needs rebuilding.
+  //              Returns the number removed.
+  // Runtime: O(n)
+  template <typename PREDICATE> std::size_t eraseIf(PREDICATE pred) {
+    std::size_t erased = insertHeap.eraseIf(pred) + eraseFrom(deletion, pred);
+    for (auto &buffer : buffers) {
+      std::size_t count = eraseFrom(buffer, pred);
+      erased += count;
+      groupCount -= count;
+    } // for ..buffer
+    for (auto &group : groups) {
+      for (auto &run : group) {
+        std::size_t count = eraseFrom(run, pred);
+        erased += count;
+        groupCount -= count;
+      } // for ..run
+      dropEmptyRuns(group);
+    } // for ..group
+    if (deletion.empty()) {
+      refillDeletion();
+    } // if
+    return erased;
+  } // eraseIf()
+
+  // Description: Return a copy of the allocator used for the runs.
+  // Runtime: O(1)
+  allocator_type get_allocator() const { return insertHeap.get_allocator(); }
+
+  // Description: Return the number of groups, about log_k(n / m).
+  // Runtime: O(1)
+  [[nodiscard]] std::size_t groupsInUse() const { return groups.size(); }
+
+  // Description: Return the bytes held for elements, for the containers
+  //              that hold the runs, and in unused capacity.
+  // Runtime: O(number of runs)
+  [[nodiscard]] MemoryUsage memoryUsage() const {
+    MemoryUsage usage = insertHeap.memoryUsage();
+    usage += vectorMemoryUsage(deletion, deletion.size());
+    usage += vectorMemoryUsage(buffers, 0);
+    for (const auto &buffer : buffers) {
+      usage += vectorMemoryUsage(buffer, buffer.size());
+    } // for ..buffer
+    usage += vectorMemoryUsage(groups, 0);
+    for (const auto &group : groups) {
+      usage += vectorMemoryUsage(group, 0);
+      for (const auto &run : group) {
+        usage += vectorMemoryUsage(run, run.size());
+      } // for ..run
+    }   // for ..group
+    return usage;
+  } // memoryUsage()
+
+private:
+  InsertHeap insertHeap;
+  // Up to m of the most extreme elements of all groups.  It is only empty
+  // when the groups are.
+  Run deletion;
+  // buffers[g] holds up to m of the most extreme elements of group g.
+  Runs buffers;
+  // groups[g] holds the runs of group g; none is empty.
+  std::vector<Runs, GroupAllocator> groups;
+  // The elements in the groups' buffers and runs.
+  std::size_t groupCount = 0;
+
+  // Description: Return true if top() is in the deletion buffer rather
+  //              than the insertion heap.
+  bool topInDeletion() const {
+    return !deletion.empty() &&
+           (insertHeap.empty() ||
+            !this->compare(deletion.back(), insertHeap.top()));
+  } // topInDeletion()
+
+  // Description: Empty the buffers and groups, not the insertion heap.
+  void clearGroups() {
+    deletion.clear();
+    buffers.clear();
+    groups.clear();
+    groupCount = 0;
+  } // clearGroups()
+
+  // Description: Remove the elements of 'run' that match 'pred', keeping
+  //              the order of the others.  Returns the number removed.
+  template <typename PREDICATE>
+  static std::size_t eraseFrom(Run &run, PREDICATE &pred) {
+    auto kept = std::remove_if(run.begin(), run.end(), pred);
+    auto count = static_cast<std::size_t>(run.end() - kept);
+    run.erase(kept, run.end());
+    return count;
+  } // eraseFrom()
+
+  static void dropEmptyRuns(Runs &group) {
+    group.erase(std::remove_if(group.begin(), group.end(),
+                               [](const Run &run) { return run.empty(); }),
+                group.end());
+  } // dropEmptyRuns()
+
+  // Description: Fill the empty PQ with 'all': a heapified insertion heap
+  //              if they fit, or else one sorted run in the first group
+  //              whose runs are that long.
+  void rebuild(Run all) {
+    if (all.size() <= kInsertSize) {
+      insertHeap = InsertHeap{all.begin(), all.end(), this->compare,
+                              get_allocator()};
+      return;
+    } // if
+    std::sort(all.begin(), all.end(), this->compare);
+    std::size_t group = 0;
+    for (std::size_t length = kInsertSize;
+         length < all.size() &&
+         length <= std::numeric_limits<std::size_t>::max() / kArity;
+         length *= kArity) {
+      ++group;
+    } // for ..length
+    groups.resize(group + 1);
+    buffers.resize(group + 1);
+    groupCount = all.size();
+    groups[group].push_back(std::move(all));
+    refillDeletion();
+  } // rebuild()
+
+  // Description: Sort the full insertion heap into a new run of group 0.
+  //              Its elements may be more extreme than the buffered ones,
+  //              so it is merged with the deletion buffer and group 0's
+  //              buffer, which take back the most extreme of them all,
+  //              keeping their sizes.
+  // Runtime: O(m log(m)), plus any merges of full groups.
+  void flushInsertHeap() {
+    Run run = insertHeap.extractAll();
+    std::sort(run.begin(), run.end(), this->compare);
+    makeRoom(0);
+    Run &buffer = buffers.front();
+    if (!deletion.empty() || !buffer.empty()) {
+      Run merged(get_allocator());
+      merged.reserve(run.size() + buffer.size() + deletion.size());
+      std::merge(std::make_move_iterator(run.begin()),
+                 std::make_move_iterator(run.end()),
+                 std::make_move_iterator(buffer.begin()),
+                 std::make_move_iterator(buffer.end()),
+                 std::back_inserter(merged), this->compare);
+      run.clear();
+      run.reserve(merged.size() + deletion.size());
+      std::merge(std::make_move_iterator(merged.begin()),
+                 std::make_move_iterator(merged.end()),
+                 std::make_move_iterator(deletion.begin()),
+                 std::make_move_iterator(deletion.end()),
+                 std::back_inserter(run), this->compare);
+      auto runEnd = run.end() - static_cast<std::ptrdiff_t>(
+                                    buffer.size() + deletion.size());
+      auto bufferEnd = runEnd + static_cast<std::ptrdiff_t>(buffer.size());
+      buffer.assign(std::make_move_iterator(runEnd),
+                    std::make_move_iterator(bufferEnd));
+      deletion.assign(std::make_move_iterator(bufferEnd),
+                      std::make_move_iterator(run.end()));
+      run.erase(runEnd, run.end());
+    } // if
+    groupCount += run.size();
+    groups.front().push_back(std::move(run));
+    if (deletion.empty()) {
+      refillDeletion();
+    } // if
+  }   // flushInsertHeap()
+
+  // Description: Make sure group 'g' exists and has room for another run.
+  //              A full group's runs are merged into one run of the next
+  //              group, merged in turn with that group's buffer, which
+  //              takes back the most extreme elements, like the deletion
+  //              buffer in flushInsertHeap().
+  // Runtime: O(m k^(g+1) log(k)) when group 'g' is full, O(1) otherwise.
+  void makeRoom(std::size_t g) {
+    if (g == groups.size()) {
+      groups.emplace_back();
+      buffers.emplace_back();
+      return;
+    } // if
+    if (groups[g].size() < kArity) {
+      return;
+    } // if
+    makeRoom(g + 1);
+
+    std::size_t total = 0;
+    for (const auto &run : groups[g]) {
+      total += run.size();
+    } // for ..run
+    Run &buffer = buffers[g + 1];
+    Run merged(get_allocator());
+    merged.reserve(total + buffer.size());
+    takeMostExtreme(groups[g], merged, total);
+    std::reverse(merged.begin(), merged.end());
+    if (!buffer.empty()) {
+      Run both(get_allocator());
+      both.reserve(merged.size() + buffer.size());
+      std::merge(std::make_move_iterator(merged.begin()),
+                 std::make_move_iterator(merged.end()),
+                 std::make_move_iterator(buffer.begin()),
+                 std::make_move_iterator(buffer.end()),
+                 std::back_inserter(both), this->compare);
+      auto runEnd = both.end() - static_cast<std::ptrdiff_t>(buffer.size());
+      buffer.assign(std::make_move_iterator(runEnd),
+                    std::make_move_iterator(both.end()));
+      both.erase(runEnd, both.end());
+      merged.swap(both);
+    } // if
+    groups[g + 1].push_back(std::move(merged));
+  } // makeRoom()
+
+  // Description: Move the 'limit' most extreme elements of the runs of
+  //              'group' (all of them if there are fewer) to the end of
+  //              'out', most extreme first, with a LoserTree over the
+  //              runs' last elements, and drop the runs that run dry.
+  // Runtime: O(k + limit log(k))
+  void takeMostExtreme(Runs &group, Run &out, std::size_t limit) {
+    if (group.size() == 1) {
+      Run &run = group.front();
+      auto count = static_cast<std::ptrdiff_t>(std::min(limit, run.size()));
+      out.insert(out.end(), std::make_move_iterator(run.rbegin()),
+                 std::make_move_iterator(run.rbegin() + count));
+      run.erase(run.end() - count, run.end());
+    } else {
+      LoserTree<TYPE, COMP_FUNCTOR, ALLOCATOR> tree{
+          group.size(), this->compare, get_allocator()};
+      for (std::size_t i = 0; i < group.size(); ++i) {
+        tree.setSource(i, group[i].back());
+        group[i].pop_back();
+      } // for ..i
+      tree.build();
+      for (std::size_t taken = 0; taken < limit && !tree.empty(); ++taken) {
+        out.push_back(tree.top());
+        Run &run = group[tree.topSource()];
+        if (run.empty()) {
+          tree.pop();
+        } else {
+          tree.replaceTop(run.back());
+          run.pop_back();
+        } // if
+      }   // for ..taken
+      // Give the heads still in the tree back to their runs.
+      while (!tree.empty()) {
+        group[tree.topSource()].push_back(tree.top());
+        tree.pop();
+      } // while
+    }   // if
+    dropEmptyRuns(group);
+  } // takeMostExtreme()
+
+  // Description: Fill the empty deletion buffer with up to m of the most
+  //              extreme elements of all groups, merging the group buffers
+  //              and refilling each one that runs dry from its runs.  There
+  //              are only about log_k(n / m) groups, so the next element is
+  //              found by comparing their buffers' first elements in turn.
+  // Runtime: O(m log(n)) amortized.
+  void refillDeletion() {
+    while (deletion.size() < kInsertSize && groupCount != 0) {
+      std::size_t best = buffers.size();
+      for (std::size_t g = 0; g < buffers.size(); ++g) {
+        Run &buffer = buffers[g];
+        if (buffer.empty() && !groups[g].empty()) {
+          takeMostExtreme(groups[g], buffer, kInsertSize);
+          std::reverse(buffer.begin(), buffer.end());
+        } // if
+        if (!buffer.empty() &&
+            (best == buffers.size() ||
+             this->compare(buffers[best].back(), buffer.back()))) {
+          best = g;
+        } // if
+      }   // for ..g
+      deletion.push_back(std::move(buffers[best].back()));
+      buffers[best].pop_back();
+      --groupCount;
+    } // while
+    std::reverse(deletion.begin(), deletion.end());
+  } // refillDeletion()
+};  // SequenceHeapPQ
+
+#endif // SEQUENCEHEAPPQ_H
@@ -0,0 +1,413 @@
+// Project identifier: 43DE0E0C4C76BFAA6D8C2F5AEAE0518A9C42CF4E
+
+#ifndef SHAREDMEMORYPQ_H
+#define SHAREDMEMORYPQ_H
+
+#include <fcntl.h>
+#include <pthread.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <new>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <type_traits>
+
+#include "Eecs281PQ.hpp"
+#include "MemoryUsage.hpp"
+
+// A binary heap of fixed capacity that lives in memory shared between
+// processes, so that a producer and a consumer on the same host exchange
+// elements by writing them into and reading them out of the heap itself:
+// no pipe, no syscall and no serialization per element.  The memory is
+// either
+//
+//   - anonymous, for processes fork()ed after the PQ is made, which
+//     inherit the mapping, or
+//   - a file mapped by every process that opens the same path.  A file on
+//     a tmpfs such as /dev/shm is a POSIX shared memory segment and never
+//     touches a disk.
+//
+// A header at the start of the memory holds the size and a process-shared
+// mutex, which every operation locks, and a condition variable waitPop()
+// sleeps on.  On Linux the mutex is robust: when a process dies holding
+// it, the next one to lock it re-heapifies the data and carries on, though
+// the element the dead process was pushing or popping may be lost or
+// duplicated.
+//
+// TYPE must be trivially copyable, since its bytes are shared as they are,
+// and must not point into a process's own memory.  Every process must
+// compare with an equivalent COMP_FUNCTOR.  top() returns a reference
+// into the shared heap, which another process's push() or pop() may change
+// at any time; with more than one consumer, take elements with tryPop()
+// or waitPop(), which read and remove the top under one lock.  The mutex
+// and condition variable are never destroyed, as other processes may
+// still use them, and a file stays until remove() deletes it.  POSIX only.
+template <typename TYPE, typename COMP_FUNCTOR = std::less<TYPE>>
+class SharedMemoryPQ : public Eecs281PQ<TYPE, COMP_FUNCTOR> {
+  // This is a way to refer to the base class object.
+  using BaseClass = Eecs281PQ<TYPE, COMP_FUNCTOR>;
+
+  static_assert(std::is_trivially_copyable_v<TYPE>,
+                "shared elements are the raw bytes of TYPE");
+  static_assert(std::atomic<std::uint64_t>::is_always_lock_free,
+                "the header's ready flag is shared between processes");
+
+  // Written into 'ready' once the header is initialized.
+  static constexpr std::uint64_t kMagic = 0x5048'5153'3238'3101; // NOLINT
+
+  // How long an opener waits for another process to initialize the file.
+  static constexpr std::chrono::seconds kInitTimeout{5};
+
+  struct Header {
+    std::atomic<std::uint64_t> ready;
+    std::uint64_t eltSize;
+    std::uint64_t capacity;
+    std::uint64_t count;
+    pthread_mutex_t mutex;
+    pthread_cond_t nonEmpty;
+  }; // Header
+
+  // The elements start on the cache line after the header.
+  static constexpr std::size_t kLine = 64;
+  static constexpr std::size_t kDataOffset =
+      (sizeof(Header) + kLine - 1) / kLine * kLine;
+  static_assert(alignof(TYPE) <= kLine, "elements are cache-line aligned");
+
+public:
+  // Description: Construct an empty PQ of room for 'capacity' elements in
+  //              anonymous shared memory, with an optional comparison
+  //              functor.  Processes fork()ed from this one afterwards
+  //              share it.  Throws std::runtime_error if the memory cannot
+  //              be mapped.
+  // Runtime: O(1)
+  explicit SharedMemoryPQ(std::size_t capacity,
+                          COMP_FUNCTOR comp = COMP_FUNCTOR())
+      : BaseClass{comp}, length{bytesFor(capacity)} {
+    void *mapped = ::mmap(nullptr, length, PROT_READ | PROT_WRITE,
+                          MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+    if (mapped == MAP_FAILED) { // NOLINT: POSIX macro
+      throw std::runtime_error("cannot map shared memory for a PQ");
+    } // if
+    attach(mapped);
+    initialize(capacity);
+  } // SharedMemoryPQ()
+
+  // Description: Open the PQ in the file at 'path', with an optional
+  //              comparison functor.  If there is no file yet, it is
+  //              created, empty, with room for 'capacity' elements;
+  //              otherwise 'capacity' is ignored and the file's is used.
+  //              Throws std::runtime_error if the file cannot be opened or
+  //              mapped, or holds no PQ of elements of this size.
+  // Runtime: O(1)
+  SharedMemoryPQ(const std::string &path, std::size_t capacity,
+                 COMP_FUNCTOR comp = COMP_FUNCTOR())
+      : BaseClass{comp} {
+    // NOLINTNEXTLINE: POSIX vararg
+    int fd = ::open(path.c_str(), O_RDWR | O_CREAT | O_EXCL, 0600);
+    bool created = fd >= 0;
+    if (!created && errno == EEXIST) {
+      fd = ::open(path.c_str(), O_RDWR); // NOLINT: POSIX vararg
+    } // if
+    if (fd < 0) {
+      throw std::runtime_error("cannot open shared PQ file " + path);
+    } // if
+    try {
+      if (created) {
+        length = bytesFor(capacity);
+        if (::ftruncate(fd, static_cast<off_t>(length)) != 0) {
+          throw std::runtime_error("cannot size shared PQ file " + path);
+        } // if
+      } else {
+        length = waitForSize(fd, path);
+      } // if
+      void *mapped = ::mmap(nullptr, length, PROT_READ | PROT_WRITE,
+                            MAP_SHARED, fd, 0);
+      if (mapped == MAP_FAILED) { // NOLINT: POSIX macro
+        throw std::runtime_error("cannot map shared PQ file " + path);
+      } // if
+      attach(mapped);
+    } catch (...) {
+      ::close(fd);
+      if (created) {
+        ::unlink(path.c_str());
+      } // if
+      throw;
+    } // try
+    ::close(fd);
+
+    if (created) {
+      initialize(capacity);
+    } else if (!waitForHeader()) {
+      unmap();
+      throw std::runtime_error(path + " holds no PQ of this element size");
+    } // if
+  }   // SharedMemoryPQ()
+
+  // Description: Each object is one process's mapping, so no copies.
+  SharedMemoryPQ(const SharedMemoryPQ &) = delete;
+  SharedMemoryPQ &operator=(const SharedMemoryPQ &) = delete;
+
+  // Description: Unmap this process's view; the PQ stays for the others.
+  virtual ~SharedMemoryPQ() { unmap(); }
+
+  // Description: Delete the file at 'path'.  Processes that have it open
+  //              keep using it; new opens create a new PQ.
+  static void remove(const std::string &path) { ::unlink(path.c_str()); }
+
+  // Description: Add a new element to the PQ and wake a process waiting
+  //              in waitPop().  Throws std::length_error if the PQ is full.
+  // Runtime: O(log(n))
+  virtual void push(const TYPE &val) {
+    Lock lock{*this};
+    if (header->count == header->capacity) {
+      throw std::length_error("SharedMemoryPQ is full");
+    } // if
+    data[header->count] = val;
+    std::push_heap(data, data + header->count + 1, this->compare);
+    ++header->count;
+    ::pthread_cond_signal(&header->nonEmpty);
+  } // push()
+
+  // Description: Remove the most extreme (defined by 'compare') element
+  //              from the PQ.
+  // Runtime: O(log(n))
+  virtual void pop() {
+    Lock lock{*this};
+    std::pop_heap(data, data + header->count, this->compare);
+    --header->count;
+  } // pop()
+
+  // Description: Replace the most extreme element with 'val', under one
+  //              lock, so no other process sees the PQ in between.
+  // Runtime: O(log(n))
+  virtual void replaceTop(const TYPE &val) {
+    Lock lock{*this};
+    std::pop_heap(data, data + header->count, this->compare);
+    data[header->count - 1] = val;
+    std::push_heap(data, data + header->count, this->compare);
+  } // replaceTop()
+
+  // Description: Add 'val', then remove and return the most extreme
+  //              element, under one lock.
+  // Runtime: O(1) if 'val' would be the most extreme, O(log(n)) otherwise.
+  virtual TYPE pushPop(const TYPE &val) {
+    Lock lock{*this};
+    if (header->count == 0 || !this->compare(val, data[0])) {
+      return val;
+    } // if
+    TYPE result = data[0];
+    std::pop_heap(data, data + header->count, this->compare);
+    data[header->count - 1] = val;
+    std::push_heap(data, data + header->count, this->compare);
+    return result;
+  } // pushPop()
+
+  // Description: Remove and return the most extreme element, or nothing if
+  //              the PQ is empty.
+  // Runtime: O(log(n))
+  std::optional<TYPE> tryPop() {
+    Lock lock{*this};
+    if (header->count == 0) {
+      return std::nullopt;
+    } // if
+    return takeTop();
+  } // tryPop()
+
+  // Description: Remove and return the most extreme element, sleeping
+  //              until some process pushes one if the PQ is empty.
+  // Runtime: O(log(n)), plus the wait.
+  TYPE waitPop() {
+    Lock lock{*this};
+    while (header->count == 0) {
+      lock.wait(header->nonEmpty);
+    } // while
+    return takeTop();
+  } // waitPop()
+
+  // Description: Return the most extreme (defined by 'compare') element of
+  //              the PQ.  The reference is into shared memory; see above.
+  // Runtime: O(1)
+  virtual const TYPE &top() const { return data[0]; }
+
+  // Description: Get the number of elements in the PQ.
+  // Runtime: O(1)
+  [[nodiscard]] virtual std::size_t size() const {
+    Lock lock{*this};
+    return static_cast<std::size_t>(header->count);
+  } // size()
+
+  // Description: Return true if the PQ is empty.
+  // Runtime: O(1)
+  [[nodiscard]] virtual bool empty() const { return size() == 0; }
+
+  // Description: Return the most elements the PQ can hold.
+  // Runtime: O(1)
+  [[nodiscard]] std::size_t capacity() const {
+    return static_cast<std::size_t>(header->capacity);
+  } // capacity()
+
+  // Description: Assumes that all elements inside the PQ are out of order
+  //              and rebuilds the heap.
+  // Runtime: O(n)
+  virtual void updatePriorities() {
+    Lock lock{*this};
+    std::make_heap(data, data + header->count, this->compare);
+  } // updatePriorities()
+
+  // Description: Return the bytes of the shared mapping: the elements, the
+  //              header, and the room for more elements.
+  // Runtime: O(1)
+  [[nodiscard]] MemoryUsage memoryUsage() const {
+    std::size_t count = size();
+    MemoryUsage usage;
+    usage.payload = count * sizeof(TYPE);
+    usage.overhead = kDataOffset;
+    usage.slack = length - kDataOffset - usage.payload;
+    return usage;
+  } // memoryUsage()
+
+private:
+  Header *header = nullptr;
+  TYPE *data = nullptr;
+  std::size_t length = 0;
+
+  // Holds the header's mutex for its lifetime, and recovers the heap from
+  // a process that died holding it.
+  class Lock {
+  public:
+    explicit Lock(const SharedMemoryPQ &pq) : owner{pq} {
+      check(::pthread_mutex_lock(&owner.header->mutex));
+    } // Lock()
+
+    Lock(const Lock &) = delete;
+    Lock &operator=(const Lock &) = delete;
+    ~Lock() { ::pthread_mutex_unlock(&owner.header->mutex); }
+
+    // Description: Release the mutex while sleeping on 'cond'.
+    void wait(pthread_cond_t &cond) {
+      check(::pthread_cond_wait(&cond, &owner.header->mutex));
+    } // wait()
+
+  private:
+    const SharedMemoryPQ &owner;
+
+    void check(int status) {
+#if defined(__linux__)
+      if (status == EOWNERDEAD) {
+        ::pthread_mutex_consistent(&owner.header->mutex);
+        std::make_heap(owner.data, owner.data + owner.header->count,
+                       owner.compare);
+        return;
+      } // if
+#endif
+      if (status != 0) {
+        throw std::runtime_error("cannot lock a SharedMemoryPQ");
+      } // if
+    } // check()
+  };  // Lock
+
+  // Description: The bytes of a mapping with room for 'capacity' elements.
+  static std::size_t bytesFor(std::size_t capacity) {
+    if (capacity > (std::numeric_limits<std::size_t>::max() - kDataOffset) /
+                       sizeof(TYPE)) {
+      throw std::length_error("SharedMemoryPQ capacity is too large");
+    } // if
+    return kDataOffset + std::max<std::size_t>(capacity, 1) * sizeof(TYPE);
+  } // bytesFor()
+
+  void attach(void *mapped) {
+    header = static_cast<Header *>(mapped);
+    data = reinterpret_cast<TYPE *>( // NOLINT: the data follows the header
+        static_cast<char *>(mapped) + kDataOffset);
+  } // attach()
+
+  void unmap() {
+    if (header != nullptr) {
+      ::munmap(header, length);
+      header = nullptr;
+      data = nullptr;
+    } // if
+  }   // unmap()
+
+  // Description: Set up the header of a new mapping, with process-shared
+  //              synchronization, and mark it ready for other processes.
+  void initialize(std::size_t capacity) {
+    auto *fresh = new (header) Header{};
+    fresh->eltSize = sizeof(TYPE);
+    fresh->capacity = capacity;
+    fresh->count = 0;
+
+    pthread_mutexattr_t mutexAttr;
+    ::pthread_mutexattr_init(&mutexAttr);
+    ::pthread_mutexattr_setpshared(&mutexAttr, PTHREAD_PROCESS_SHARED);
+#if defined(__linux__)
+    ::pthread_mutexattr_setrobust(&mutexAttr, PTHREAD_MUTEX_ROBUST);
+#endif
+    ::pthread_mutex_init(&fresh->mutex, &mutexAttr);
+    ::pthread_mutexattr_destroy(&mutexAttr);
+
+    pthread_condattr_t condAttr;
+    ::pthread_condattr_init(&condAttr);
+    ::pthread_condattr_setpshared(&condAttr, PTHREAD_PROCESS_SHARED);
+    ::pthread_cond_init(&fresh->nonEmpty, &condAttr);
+    ::pthread_condattr_destroy(&condAttr);
+
+    fresh->ready.store(kMagic, std::memory_order_release);
+  } // initialize()
+
+  // Description: Wait for the process creating the file at 'fd' to size
+  //              it, and return the size.  Throws std::runtime_error if it
+  //              takes longer than kInitTimeout.
+  static std::size_t waitForSize(int fd, const std::string &path) {
+    auto deadline = std::chrono::steady_clock::now() + kInitTimeout;
+    while (true) {
+      struct stat info {};
+      if (::fstat(fd, &info) != 0) {
+        throw std::runtime_error("cannot open shared PQ file " + path);
+      } // if
+      if (static_cast<std::size_t>(info.st_size) >= kDataOffset) {
+        return static_cast<std::size_t>(info.st_size);
+      } // if
+      if (std::chrono::steady_clock::now() > deadline) {
+        throw std::runtime_error(path + " was never initialized");
+      } // if
+      std::this_thread::yield();
+    } // while
+  }   // waitForSize()
+
+  // Description: Wait for the creator to initialize the header, then check
+  //              that it describes a PQ of TYPE that fits the mapping.
+  bool waitForHeader() const {
+    auto deadline = std::chrono::steady_clock::now() + kInitTimeout;
+    while (header->ready.load(std::memory_order_acquire) != kMagic) {
+      if (std::chrono::steady_clock::now() > deadline) {
+        return false;
+      } // if
+      std::this_thread::yield();
+    } // while
+    return header->eltSize == sizeof(TYPE) &&
+           header->capacity <= (length - kDataOffset) / sizeof(TYPE);
+  } // waitForHeader()
+
+  // Description: Remove and return the top, with the lock held.
+  TYPE takeTop() {
+    TYPE result = data[0];
+    std::pop_heap(data, data + header->count, this->compare);
+    --header->count;
+    return result;
+  } // takeTop()
+};  // SharedMemoryPQ
+
+#endif // SHAREDMEMORYPQ_H
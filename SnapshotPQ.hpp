@@ -0,0 +1,179 @@
+// Project identifier: 43DE0E0C4C76BFAA6D8C2F5AEAE0518A9C42CF4E
+
+#ifndef SNAPSHOTPQ_H
+#define SNAPSHOTPQ_H
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <optional>
+#include <type_traits>
+#include <utility>
+
+#include "Eecs281PQ.hpp"
+#include "RecordingPQ.hpp"
+
+// A PQ that forwards every operation to a PQ of type PQ, owned by a single
+// writer thread, and after each change publishes the top element and the
+// size for any number of reader threads.  Readers call snapshot(), which
+// never takes a lock and never makes the writer wait.
+//
+// The two values are published under a sequence lock: the writer makes
+// the sequence number odd, stores the values, and makes it even again; a
+// reader copies the values and retries if the number was odd or changed
+// meanwhile, so it never returns a torn value.  The values are stored as
+// atomic words, so the racing copies are well defined, with release
+// stores and acquire loads, so a reader that sees a new word also sees the
+// odd number that came before it; on x86 all of them are plain moves.
+// TYPE must be trivially copyable (and default constructible, to copy it
+// back out).
+//
+// Everything but snapshot() must be called from the writer thread.
+template <typename PQ>
+class SnapshotPQ : public Eecs281PQ<typename PQTypes<PQ>::Type,
+                                    typename PQTypes<PQ>::Comp> {
+  using TYPE = typename PQTypes<PQ>::Type;
+  using COMP_FUNCTOR = typename PQTypes<PQ>::Comp;
+  using BaseClass = Eecs281PQ<TYPE, COMP_FUNCTOR>;
+
+  static_assert(std::is_trivially_copyable_v<TYPE> &&
+                    std::is_default_constructible_v<TYPE>,
+                "readers copy the top element while it may change");
+
+public:
+  // What a reader sees: the top element (none if the PQ was empty), the
+  // size, and the number of changes published before it.
+  struct Snapshot {
+    std::optional<TYPE> top;
+    std::size_t size;
+    std::uint64_t version;
+  }; // Snapshot
+
+  // Description: Publish the state of 'inner', then the state after every
+  //              change made through this wrapper.
+  // Runtime: O(1)
+  explicit SnapshotPQ(PQ inner = PQ()) : pq{std::move(inner)} {
+    publish();
+  } // SnapshotPQ()
+
+  // Description: Readers hold on to the published slot, so no copies.
+  SnapshotPQ(const SnapshotPQ &) = delete;
+  SnapshotPQ &operator=(const SnapshotPQ &) = delete;
+  virtual ~SnapshotPQ() = default;
+
+  virtual void push(const TYPE &val) {
+    pq.push(val);
+    publish();
+  } // push()
+
+  virtual void pop() {
+    pq.pop();
+    publish();
+  } // pop()
+
+  virtual const TYPE &top() const { return pq.top(); } // top()
+
+  virtual void replaceTop(const TYPE &val) {
+    pq.replaceTop(val);
+    publish();
+  } // replaceTop()
+
+  virtual TYPE pushPop(const TYPE &val) {
+    TYPE result = pq.pushPop(val);
+    publish();
+    return result;
+  } // pushPop()
+
+  virtual void updatePriorities() {
+    pq.updatePriorities();
+    publish();
+  } // updatePriorities()
+
+  [[nodiscard]] virtual std::size_t size() const { return pq.size(); }
+
+  [[nodiscard]] virtual bool empty() const { return pq.empty(); }
+
+  // Description: push() that returns the inner PQ's handle, when PQ has
+  //              handles (PairingPQ, CompactPairingPQ).
+  template <typename Q = PQ>
+  auto addNode(const TYPE &val)
+      -> decltype(std::declval<Q &>().addNode(val)) {
+    auto handle = pq.addNode(val);
+    publish();
+    return handle;
+  } // addNode()
+
+  // Description: Change the element of a handle returned by addNode().
+  template <typename HANDLE> void updateElt(HANDLE handle, const TYPE &val) {
+    pq.updateElt(handle, val);
+    publish();
+  } // updateElt()
+
+  // Description: Return the last published top element and size.  Safe to
+  //              call from any thread at any time; it retries while the
+  //              writer is publishing, and never blocks it.
+  // Runtime: O(1), unless the writer keeps publishing.
+  Snapshot snapshot() const {
+    std::array<std::uint64_t, kWords> copy{};
+    std::uint64_t before = 0;
+    while (true) {
+      before = slot.sequence.load(std::memory_order_acquire);
+      for (std::size_t i = 0; i < kWords; ++i) {
+        copy[i] = slot.words[i].load(std::memory_order_acquire);
+      } // for ..i
+      std::uint64_t after = slot.sequence.load(std::memory_order_relaxed);
+      if (before == after && before % 2 == 0) {
+        break;
+      } // if
+    }   // while
+
+    Snapshot result{std::nullopt, copy[kTopWords], before / 2};
+    if (result.size != 0) {
+      result.top.emplace();
+      std::memcpy(&*result.top, copy.data(), sizeof(TYPE));
+    } // if
+    return result;
+  } // snapshot()
+
+  // Description: The PQ being published, for the writer.
+  const PQ &inner() const { return pq; }
+
+private:
+  // The published words: the bytes of the top element, then the size.
+  static constexpr std::size_t kTopWords =
+      (sizeof(TYPE) + sizeof(std::uint64_t) - 1) / sizeof(std::uint64_t);
+  static constexpr std::size_t kWords = kTopWords + 1;
+
+  // The sequence number and the words, on cache lines of their own, away
+  // from the writer's other data.
+  struct alignas(64) Slot {
+    std::atomic<std::uint64_t> sequence{0};
+    std::array<std::atomic<std::uint64_t>, kWords> words{};
+  }; // Slot
+
+  PQ pq;
+  Slot slot;
+
+  // Description: Publish the current top element and size.  Only the
+  //              writer changes the sequence number, so it needs no
+  //              read-modify-write.
+  // Runtime: O(sizeof(TYPE))
+  void publish() {
+    std::array<std::uint64_t, kWords> copy{};
+    copy[kTopWords] = pq.size();
+    if (copy[kTopWords] != 0) {
+      std::memcpy(copy.data(), &pq.top(), sizeof(TYPE));
+    } // if
+
+    std::uint64_t sequence = slot.sequence.load(std::memory_order_relaxed);
+    slot.sequence.store(sequence + 1, std::memory_order_relaxed);
+    for (std::size_t i = 0; i < kWords; ++i) {
+      slot.words[i].store(copy[i], std::memory_order_release);
+    } // for ..i
+    slot.sequence.store(sequence + 2, std::memory_order_release);
+  } // publish()
+};  // SnapshotPQ
+
+#endif // SNAPSHOTPQ_H
@@ -5,33 +5,51 @@
 
 #include <algorithm>
 #include <iostream>
+#include <memory>
+#include <memory_resource>
 
 #include "Eecs281PQ.hpp"
+#include "MemoryUsage.hpp"
+#include "RadixSort.hpp"
 
 // A specialized version of the priority queue ADT that is implemented with an
 // underlying sorted array-based container.
 // Note: The most extreme element should be found at the end of the
 // 'data' container, such that traversing the iterators yields the elements in
 // sorted order.
-template <typename TYPE, typename COMP_FUNCTOR = std::less<TYPE>>
+// The optional ALLOCATOR is used for the underlying data vector, and the
+// optional SHRINK policy (see MemoryUsage.hpp) decides when pop() and
+// eraseIf() give its capacity back.
+// In C++20 builds the members marked PQ_CONSTEXPR (see Eecs281PQ.hpp) can
+// run at compile time, with the default SHRINK policy.
+template <typename TYPE, typename COMP_FUNCTOR = std::less<TYPE>,
+          typename ALLOCATOR = std::allocator<TYPE>,
+          typename SHRINK = NeverShrink>
 class SortedPQ : public Eecs281PQ<TYPE, COMP_FUNCTOR> {
   // This is a way to refer to the base class object.
   using BaseClass = Eecs281PQ<TYPE, COMP_FUNCTOR>;
 
 public:
-  // Description: Construct an empty PQ with an optional comparison functor.
+  using allocator_type = ALLOCATOR;
+
+  // Description: Construct an empty PQ with an optional comparison functor
+  //              and allocator.
   // Runtime: O(1)
-  explicit SortedPQ(COMP_FUNCTOR comp = COMP_FUNCTOR()) : BaseClass{comp} {
+  PQ_CONSTEXPR explicit SortedPQ(COMP_FUNCTOR comp = COMP_FUNCTOR(),
+                    const ALLOCATOR &alloc = ALLOCATOR())
+      : BaseClass{comp}, data(alloc) {
     // Implement this function, or verify that it is already done
   } // SortedPQ
 
   // Description: Construct a PQ out of an iterator range with an optional
-  //              comparison functor.
-  // Runtime: O(n log n) where n is number of elements in range.
+  //              comparison functor and allocator.
+  // Runtime: O(n log n) where n is number of elements in range, O(n) for
+  //          the radix-sortable ones of updatePriorities().
   template <typename InputIterator>
-  SortedPQ(InputIterator start, InputIterator end,
-           COMP_FUNCTOR comp = COMP_FUNCTOR())
-      : BaseClass{comp}, data{start, end} {
+  PQ_CONSTEXPR SortedPQ(InputIterator start, InputIterator end,
+           COMP_FUNCTOR comp = COMP_FUNCTOR(),
+           const ALLOCATOR &alloc = ALLOCATOR())
+      : BaseClass{comp}, data(start, end, alloc) {
     // TODO: Implement this function
     updatePriorities();
   } // SortedPQ
@@ -52,7 +70,7 @@ public:
 
   // Description: Add a new element to the PQ.
   // Runtime: O(n)
-  virtual void push(const TYPE &val) {
+  PQ_CONSTEXPR virtual void push(const TYPE &val) {
     // TODO: Implement this function
     auto pos = std::lower_bound(data.begin(), data.end(), val, this->compare);
     data.insert(pos, val);
@@ -64,17 +82,89 @@ public:
   // element when the PQ is empty. Though you are welcome to if you are
   // familiar with them, you do not need to use exceptions in this project.
   // Runtime: Amortized O(1)
-  virtual void pop() {
+  PQ_CONSTEXPR virtual void pop() {
     // TODO: Implement this function
     data.pop_back();
+    SHRINK::apply(data);
   } // pop()
 
+  // Description: Replace the most extreme element (the last one) with
+  //              'val' and move it into place with a single shift of the
+  //              elements above its position, instead of a pop_back() and
+  //              an insert().
+  // Runtime: O(1) if 'val' is still the most extreme, O(n) otherwise.
+  PQ_CONSTEXPR virtual void replaceTop(const TYPE &val) {
+    auto last = data.end() - 1;
+    if (last == data.begin() || !this->compare(val, *(last - 1))) {
+      *last = val;
+      return;
+    } // if
+    auto pos = std::lower_bound(data.begin(), last, val, this->compare);
+    std::move_backward(pos, last, data.end());
+    *pos = val;
+  } // replaceTop()
+
+  // Description: Add 'val', then remove and return the most extreme
+  //              element.
+  // Runtime: O(1) if 'val' would be the most extreme, O(n) otherwise.
+  PQ_CONSTEXPR virtual TYPE pushPop(const TYPE &val) {
+    if (data.empty() || !this->compare(val, data.back())) {
+      return val;
+    } // if
+    TYPE result = std::move(data.back());
+    replaceTop(val);
+    return result;
+  } // pushPop()
+
+  // Description: Empty the PQ and hand back its elements, in no particular
+  //              order, e.g. to bulk-build another PQ from them.
+  // Runtime: O(1)
+  PQ_CONSTEXPR std::vector<TYPE, ALLOCATOR> extractAll() {
+    std::vector<TYPE, ALLOCATOR> result{std::move(data)};
+    data.clear();
+    return result;
+  } // extractAll()
+
+  // Description: Remove every element for which 'pred' returns true, in
+  //              one pass over the data.  The compaction is stable, so the
+  //              data stays sorted.  Returns the number removed.
+  // Runtime: O(n)
+  template <typename PREDICATE>
+  PQ_CONSTEXPR std::size_t eraseIf(PREDICATE pred) {
+    auto newEnd = std::remove_if(data.begin(), data.end(), pred);
+    auto erased = static_cast<std::size_t>(data.end() - newEnd);
+    data.erase(newEnd, data.end());
+    SHRINK::apply(data);
+    return erased;
+  } // eraseIf()
+
+  // Description: Empty the PQ and hand back its data vector, which is
+  //              already in ascending order (the most extreme element last).
+  // Runtime: O(1)
+  PQ_CONSTEXPR std::vector<TYPE, ALLOCATOR> drainSorted() {
+    std::vector<TYPE, ALLOCATOR> result{std::move(data)};
+    data.clear();
+    return result;
+  } // drainSorted()
+
+  // Description: Empty the PQ, writing its elements to 'out' with the most
+  //              extreme first.  The data is already sorted, so this only
+  //              moves it out back to front, with no comparisons.  Returns
+  //              the output iterator one past the last element written.
+  // Runtime: O(n)
+  template <typename OutputIterator>
+  PQ_CONSTEXPR OutputIterator drainSorted(OutputIterator out) {
+    out = std::move(data.rbegin(), data.rend(), out);
+    data.clear();
+    return out;
+  } // drainSorted()
+
   // Description: Return the most extreme (defined by 'compare') element of
   //              the vector.  This should be a reference for speed.  It MUST
   //              be const because we cannot allow it to be modified, as that
   //              might make it no longer be the most extreme element.
   // Runtime: O(1)
-  virtual const TYPE &top() const {
+  PQ_CONSTEXPR virtual const TYPE &top() const {
     // TODO: Implement this function
     return data.back();
   } // top()
@@ -82,28 +172,55 @@ public:
   // Description: Get the number of elements in the PQ.
   //              This has been implemented for you.
   // Runtime: O(1)
-  [[nodiscard]] virtual std::size_t size() const { return data.size(); }
+  [[nodiscard]] PQ_CONSTEXPR virtual std::size_t size() const {
+    return data.size();
+  }
 
   // Description: Return true if the PQ is empty.
   //              This has been implemented for you.
   // Runtime: O(1)
-  [[nodiscard]] virtual bool empty() const { return data.empty(); }
+  [[nodiscard]] PQ_CONSTEXPR virtual bool empty() const {
+    return data.empty();
+  }
+
+  // Description: Return a copy of the allocator used by the data vector.
+  // Runtime: O(1)
+  PQ_CONSTEXPR allocator_type get_allocator() const {
+    return data.get_allocator();
+  }
+
+  // Description: Return the bytes held for elements, for the vector's
+  //              allocation itself, and in unused capacity.
+  // Runtime: O(1)
+  [[nodiscard]] MemoryUsage memoryUsage() const {
+    return vectorMemoryUsage(data, data.size());
+  } // memoryUsage()
 
   // Description: Assumes that all elements inside the PQ are out of order and
-  //              'rebuilds' the PQ by fixing the PQ invariant.
-  // Runtime: O(n log n)
-  virtual void updatePriorities() {
-    // TODO: Implement this function
-    std::sort(data.begin(), data.end(), this->compare);
+  //              'rebuilds' the PQ by fixing the PQ invariant.  Arithmetic
+  //              elements, or ones with a RadixKey (see RadixSort.hpp),
+  //              compared with std::less or std::greater are radix sorted;
+  //              any other comparator gets std::sort.
+  // Runtime: O(n log n), or O(n) when radix sorted.
+  PQ_CONSTEXPR virtual void updatePriorities() {
+    sortByCompare(data, this->compare);
   } // updatePriorities()
 
 private:
   // Note: This vector *must* be used for your PQ implementation.
-  std::vector<TYPE> data;
+  std::vector<TYPE, ALLOCATOR> data;
 
   // TODO: Add any additional member functions you require here.
   //       You are NOT allowed to add any new member variables.
 
 }; // SortedPQ
 
+namespace pmr {
+// A SortedPQ whose storage comes from a std::pmr::memory_resource.
+template <typename TYPE, typename COMP_FUNCTOR = std::less<TYPE>,
+          typename SHRINK = NeverShrink>
+using SortedPQ = ::SortedPQ<TYPE, COMP_FUNCTOR,
+                            std::pmr::polymorphic_allocator<TYPE>, SHRINK>;
+} // namespace pmr
+
 #endif // SORTEDPQ_H
@@ -0,0 +1,512 @@
+// Project identifier: 43DE0E0C4C76BFAA6D8C2F5AEAE0518A9C42CF4E
+
+#ifndef TIMINGWHEEL_H
+#define TIMINGWHEEL_H
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <memory_resource>
+#include <utility>
+#include <vector>
+
+#include "Eecs281PQ.hpp"
+#include "MemoryUsage.hpp"
+
+// The default way to get a timer's tick: the element itself, converted to
+// an unsigned 64-bit integer.
+template <typename TYPE> struct TickOf {
+  std::uint64_t operator()(const TYPE &val) const {
+    return static_cast<std::uint64_t>(val);
+  } // operator()()
+};  // TickOf
+
+// Orders timers for Eecs281PQ: the earlier tick is the more extreme one.
+template <typename TYPE, typename TICK_OF> struct LaterTick {
+  TICK_OF tickOf;
+
+  bool operator()(const TYPE &a, const TYPE &b) const {
+    return tickOf(a) > tickOf(b);
+  } // operator()()
+};  // LaterTick
+
+// A hierarchical timing wheel: a priority queue of timers keyed on integer
+// ticks, with the earliest tick on top.  There are 11 levels of 64 slots,
+// enough for any 64-bit tick.  A timer goes into the level of the highest
+// 6-bit digit in which its tick differs from the wheel's current tick
+// ('now', which never passes the earliest timer), and into the slot given
+// by its own digit there; each slot is an intrusive list, and each level
+// has a bitmap of its non-empty slots.
+//
+// Scheduling and cancelling are O(1).  The earliest timers are always on
+// level 0, where a slot holds a single tick.  When level 0 runs empty the
+// lowest non-empty slot of the next level up is cascaded: 'now' moves to
+// the start of that slot and its timers are redistributed to lower levels.
+// This happens lazily, only when the earliest timer is needed, and each
+// timer cascades at most once per level.
+//
+// schedule() returns a Node * handle for cancel() and reschedule(); like
+// PairingPQ's handles it stays valid until that timer is popped, cancelled
+// or erased.  Timers with equal ticks come out in no particular order.
+// TICK_OF extracts the (unsigned) tick from an element.
+// Nodes are obtained from the optional ALLOCATOR, rebound to Node.
+template <typename TYPE, typename TICK_OF = TickOf<TYPE>,
+          typename ALLOCATOR = std::allocator<TYPE>>
+class TimingWheel : public Eecs281PQ<TYPE, LaterTick<TYPE, TICK_OF>> {
+  // This is a way to refer to the base class object.
+  using BaseClass = Eecs281PQ<TYPE, LaterTick<TYPE, TICK_OF>>;
+
+public:
+  using allocator_type = ALLOCATOR;
+
+  // Each scheduled timer.
+  class Node {
+  public:
+    explicit Node(const TYPE &val) : elt{val} {}
+
+    // Description: Allows access to the timer's element.
+    // Runtime: O(1)
+    const TYPE &getElt() const { return elt; }
+    const TYPE &operator*() const { return elt; }
+
+    friend TimingWheel;
+
+  private:
+    TYPE elt;
+    Node *prev = nullptr;
+    Node *next = nullptr;
+  }; // Node
+
+  // Description: Construct an empty wheel with an optional tick extractor
+  //              and allocator.
+  // Runtime: O(1)
+  explicit TimingWheel(TICK_OF tickOf = TICK_OF(),
+                       const ALLOCATOR &alloc = ALLOCATOR())
+      : BaseClass{LaterTick<TYPE, TICK_OF>{tickOf}}, nodeAlloc{alloc} {
+  } // TimingWheel()
+
+  // Description: Construct a wheel out of an iterator range with an
+  //              optional tick extractor and allocator.
+  // Runtime: O(n) where n is number of elements in range.
+  template <typename InputIterator>
+  TimingWheel(InputIterator start, InputIterator end,
+              TICK_OF tickOf = TICK_OF(), const ALLOCATOR &alloc = ALLOCATOR())
+      : TimingWheel{tickOf, alloc} {
+    for (InputIterator it = start; it != end; ++it) {
+      schedule(*it);
+    } // for ..it
+  }   // TimingWheel()
+
+  // Description: Copy constructor.  Handles into 'other' do not refer to
+  //              the copy.
+  // Runtime: O(n)
+  TimingWheel(const TimingWheel &other)
+      : TimingWheel{other, NodeTraits::select_on_container_copy_construction(
+                               other.nodeAlloc)} {} // TimingWheel()
+
+  // Description: Copy constructor that places the copy's nodes in 'alloc'.
+  // Runtime: O(n)
+  TimingWheel(const TimingWheel &other, const ALLOCATOR &alloc)
+      : BaseClass{other.compare}, now{other.now}, nodeAlloc{alloc} {
+    other.forEachNode([this](Node *node) {
+      place(createNode(node->elt));
+      ++count;
+    });
+  } // TimingWheel()
+
+  // Description: Copy assignment operator, using copy-swap with our own
+  //              allocator.
+  // Runtime: O(n)
+  TimingWheel &operator=(const TimingWheel &rhs) {
+    TimingWheel temp(rhs, get_allocator());
+    swapTimers(temp);
+    return *this;
+  } // operator=()
+
+  // Description: Move constructor.  Handles stay valid and now refer to
+  //              the new wheel.
+  // Runtime: O(1)
+  TimingWheel(TimingWheel &&other) noexcept
+      : BaseClass{std::move(other)}, heads{other.heads},
+        occupied{other.occupied}, now{other.now}, count{other.count},
+        nodeAlloc{other.nodeAlloc} {
+    other.heads = {};
+    other.occupied = {};
+    other.count = 0;
+  } // TimingWheel()
+
+  // Description: Move assignment operator, with the same rules for the
+  //              allocator as PairingPQ.
+  // Runtime: O(1), or O(n) for unequal non-propagating allocators.
+  TimingWheel &operator=(TimingWheel &&rhs) noexcept(
+      NodeTraits::propagate_on_container_move_assignment::value ||
+      NodeTraits::is_always_equal::value) {
+    if constexpr (NodeTraits::propagate_on_container_move_assignment::value) {
+      std::swap(nodeAlloc, rhs.nodeAlloc);
+    } else {
+      if (!(nodeAlloc == rhs.nodeAlloc)) {
+        return *this = static_cast<const TimingWheel &>(rhs);
+      } // if
+    }   // if
+    swapTimers(rhs);
+    return *this;
+  } // operator=()
+
+  // Description: Destructor.
+  // Runtime: O(n)
+  ~TimingWheel() {
+    forEachNode([this](Node *node) { destroyNode(node); });
+  } // ~TimingWheel()
+
+  // Description: Assumes that the ticks of the elements have changed and
+  //              places every timer again.  Handles stay valid.
+  // Runtime: O(n)
+  virtual void updatePriorities() {
+    std::vector<Node *> nodes;
+    nodes.reserve(count);
+    forEachNode([&nodes](Node *node) { nodes.push_back(node); });
+    heads = {};
+    occupied = {};
+    if (!nodes.empty()) {
+      now = tickOf(nodes.front()->elt);
+    } // if
+    for (Node *node : nodes) {
+      now = std::min(now, tickOf(node->elt));
+    } // for ..node
+    for (Node *node : nodes) {
+      place(node);
+    } // for ..node
+  }   // updatePriorities()
+
+  // Description: Add a new timer.  Same as schedule(), without the handle.
+  // Runtime: O(1)
+  virtual void push(const TYPE &val) { schedule(val); } // push()
+
+  // Description: Add a new timer and return a handle to it.
+  // Runtime: O(1).  A tick before the earliest timer first moves 'now'
+  //          back, which also moves the timers near the earliest one up a
+  //          level (see rewind()).
+  Node *schedule(const TYPE &val) {
+    Node *node = createNode(val);
+    insert(node);
+    return node;
+  } // schedule()
+
+  // Description: Remove the timer with the earliest tick.
+  // Runtime: O(1) amortized
+  virtual void pop() { cancel(heads[0][lowestBit(occupied[0])]); } // pop()
+
+  // Description: Replace the earliest timer by 'val', reusing its node.
+  // Runtime: O(1) amortized, as schedule()
+  virtual void replaceTop(const TYPE &val) {
+    reschedule(heads[0][lowestBit(occupied[0])], val);
+  } // replaceTop()
+
+  // Description: Schedule 'val', then remove and return the earliest
+  //              timer, reusing its node.  'val' itself is returned right
+  //              away if no timer is earlier.
+  // Runtime: O(1) amortized
+  virtual TYPE pushPop(const TYPE &val) {
+    if (count == 0 || !this->compare(val, top())) {
+      return val;
+    } // if
+    Node *node = heads[0][lowestBit(occupied[0])];
+    TYPE result = node->elt; // reschedule() still needs the old tick
+    reschedule(node, val);
+    return result;
+  } // pushPop()
+
+  // Description: Remove a scheduled timer.
+  // Runtime: O(1) amortized
+  void cancel(Node *node) {
+    unlink(node);
+    destroyNode(node);
+    --count;
+    settle();
+  } // cancel()
+
+  // Description: Replace a scheduled timer's element (and so its tick),
+  //              keeping its handle.
+  // Runtime: O(1) amortized, as schedule()
+  void reschedule(Node *node, const TYPE &val) {
+    unlink(node);
+    --count;
+    node->elt = val;
+    insert(node);
+    settle();
+  } // reschedule()
+
+  // Description: Remove every timer whose element satisfies 'pred'.
+  //              Returns the number removed.
+  // Runtime: O(n)
+  template <typename PREDICATE> std::size_t eraseIf(PREDICATE pred) {
+    std::size_t erased = 0;
+    forEachNode([&](Node *node) {
+      if (pred(node->elt)) {
+        unlink(node);
+        destroyNode(node);
+        ++erased;
+      } // if
+    });
+    count -= erased;
+    settle();
+    return erased;
+  } // eraseIf()
+
+  // Description: Empty the wheel, writing its elements to 'out' earliest
+  //              first.  Returns the output iterator one past the last
+  //              element written.
+  // Runtime: O(n) amortized
+  template <typename OutputIterator>
+  OutputIterator drainSorted(OutputIterator out) {
+    while (!empty()) {
+      *out = top();
+      ++out;
+      pop();
+    } // while
+    return out;
+  } // drainSorted()
+
+  // Description: Empty the wheel and hand back its elements, in no
+  //              particular order.
+  // Runtime: O(n)
+  std::vector<TYPE, ALLOCATOR> extractAll() {
+    std::vector<TYPE, ALLOCATOR> result(get_allocator());
+    result.reserve(count);
+    forEachNode([&](Node *node) {
+      result.push_back(std::move(node->elt));
+      destroyNode(node);
+    });
+    heads = {};
+    occupied = {};
+    count = 0;
+    return result;
+  } // extractAll()
+
+  // Description: Return the timer with the earliest tick.
+  // Runtime: O(1)
+  virtual const TYPE &top() const {
+    return heads[0][lowestBit(occupied[0])]->elt;
+  } // top()
+
+  // Description: Get the number of timers.
+  // Runtime: O(1)
+  [[nodiscard]] virtual std::size_t size() const { return count; }
+
+  // Description: Return true if no timers are scheduled.
+  // Runtime: O(1)
+  [[nodiscard]] virtual bool empty() const { return count == 0; }
+
+  // Description: Return a copy of the allocator used for the nodes.
+  // Runtime: O(1)
+  allocator_type get_allocator() const { return allocator_type(nodeAlloc); }
+
+  // Description: Return the bytes held for timers and for the nodes around
+  //              them, including an estimate of the allocator's per-node
+  //              overhead.  The slot heads live inside the object itself.
+  // Runtime: O(1)
+  [[nodiscard]] MemoryUsage memoryUsage() const {
+    return nodeMemoryUsage<Node, TYPE>(count);
+  } // memoryUsage()
+
+private:
+  using NodeAllocator =
+      typename std::allocator_traits<ALLOCATOR>::template rebind_alloc<Node>;
+  using NodeTraits = std::allocator_traits<NodeAllocator>;
+
+  static constexpr unsigned kSlotBits = 6;
+  static constexpr std::size_t kSlots = std::size_t{1} << kSlotBits;
+  static constexpr std::size_t kLevels = (64 + kSlotBits - 1) / kSlotBits;
+
+  std::array<std::array<Node *, kSlots>, kLevels> heads{};
+  std::array<std::uint64_t, kLevels> occupied{};
+  std::uint64_t now = 0;
+  std::size_t count = 0;
+  NodeAllocator nodeAlloc;
+
+  std::uint64_t tickOf(const TYPE &val) const {
+    return this->compare.tickOf(val);
+  } // tickOf()
+
+  // Description: Index of the lowest set bit of a non-zero word.
+  static std::size_t lowestBit(std::uint64_t word) {
+#if defined(__GNUC__) || defined(__clang__)
+    return static_cast<std::size_t>(__builtin_ctzll(word));
+#else
+    std::size_t bit = 0;
+    while ((word & 1) == 0) {
+      word >>= 1;
+      ++bit;
+    } // while
+    return bit;
+#endif
+  } // lowestBit()
+
+  // Description: Level of a tick that differs from 'now' in the bits of
+  //              'diff': the index of its highest non-zero 6-bit digit.
+  static std::size_t levelOf(std::uint64_t diff) {
+    if (diff == 0) {
+      return 0;
+    } // if
+#if defined(__GNUC__) || defined(__clang__)
+    auto highBit = static_cast<std::size_t>(63 - __builtin_clzll(diff));
+#else
+    std::size_t highBit = 0;
+    while (diff >>= 1) {
+      ++highBit;
+    } // while
+#endif
+    return highBit / kSlotBits;
+  } // levelOf()
+
+  // Description: The level and slot where a timer with 'tick' belongs.
+  std::pair<std::size_t, std::size_t> position(std::uint64_t tick) const {
+    std::size_t level = levelOf(tick ^ now);
+    auto slot =
+        static_cast<std::size_t>((tick >> (level * kSlotBits)) & (kSlots - 1));
+    return {level, slot};
+  } // position()
+
+  // Description: Allocate and construct a node holding 'val'.
+  Node *createNode(const TYPE &val) {
+    Node *node = NodeTraits::allocate(nodeAlloc, 1);
+    try {
+      NodeTraits::construct(nodeAlloc, node, val);
+    } catch (...) {
+      NodeTraits::deallocate(nodeAlloc, node, 1);
+      throw;
+    }
+    return node;
+  } // createNode()
+
+  // Description: Destroy a node and give its memory back to the allocator.
+  void destroyNode(Node *node) {
+    NodeTraits::destroy(nodeAlloc, node);
+    NodeTraits::deallocate(nodeAlloc, node, 1);
+  } // destroyNode()
+
+  // Description: Call 'func' on every node.  'func' may unlink or destroy
+  //              the node it is given.
+  template <typename FUNC> void forEachNode(FUNC &&func) const {
+    for (std::size_t level = 0; level < kLevels; ++level) {
+      for (std::uint64_t bits = occupied[level]; bits != 0; bits &= bits - 1) {
+        for (Node *node = heads[level][lowestBit(bits)]; node != nullptr;) {
+          Node *next = node->next;
+          func(node);
+          node = next;
+        } // for ..node
+      }   // for ..bits
+    }     // for ..level
+  }       // forEachNode()
+
+  // Description: Link a node into the slot for its tick.
+  // Runtime: O(1)
+  void place(Node *node) {
+    auto [level, slot] = position(tickOf(node->elt));
+    Node *&head = heads[level][slot];
+    node->prev = nullptr;
+    node->next = head;
+    if (head != nullptr) {
+      head->prev = node;
+    } // if
+    head = node;
+    occupied[level] |= std::uint64_t{1} << slot;
+  } // place()
+
+  // Description: Unlink a node from its slot.
+  // Runtime: O(1)
+  void unlink(Node *node) {
+    auto [level, slot] = position(tickOf(node->elt));
+    if (node->prev != nullptr) {
+      node->prev->next = node->next;
+    } else {
+      heads[level][slot] = node->next;
+    } // if
+    if (node->next != nullptr) {
+      node->next->prev = node->prev;
+    } // if
+    if (heads[level][slot] == nullptr) {
+      occupied[level] &= ~(std::uint64_t{1} << slot);
+    } // if
+  }   // unlink()
+
+  // Description: Add an unlinked node to the wheel.  A tick before 'now'
+  //              moves 'now' back first, which keeps level 0 non-empty.
+  void insert(Node *node) {
+    std::uint64_t tick = tickOf(node->elt);
+    if (count == 0) {
+      now = tick;
+    } else if (tick < now) {
+      rewind(tick);
+    } // if
+    place(node);
+    ++count;
+  } // insert()
+
+  // Description: Move 'now' back to 'tick'.  Timers on levels above the
+  //              highest digit in which the two differ stay where they
+  //              are; those below it all move up to that level.
+  void rewind(std::uint64_t tick) {
+    std::size_t highest = levelOf(now ^ tick);
+    now = tick;
+    for (std::size_t level = 0; level < highest; ++level) {
+      for (std::uint64_t bits = occupied[level]; bits != 0; bits &= bits - 1) {
+        Node *node = std::exchange(heads[level][lowestBit(bits)], nullptr);
+        while (node != nullptr) {
+          Node *next = node->next;
+          place(node);
+          node = next;
+        } // while
+      }   // for ..bits
+      occupied[level] = 0;
+    } // for ..level
+  }   // rewind()
+
+  // Description: Restore the invariant that level 0 holds the earliest
+  //              timers, by cascading the lowest non-empty slot of the
+  //              lowest non-empty level until level 0 is reached.
+  // Runtime: O(timers cascaded)
+  void settle() {
+    while (count != 0 && occupied[0] == 0) {
+      std::size_t level = 1;
+      while (occupied[level] == 0) {
+        ++level;
+      } // while
+      std::size_t slot = lowestBit(occupied[level]);
+      Node *node = std::exchange(heads[level][slot], nullptr);
+      occupied[level] &= ~(std::uint64_t{1} << slot);
+
+      // Every timer in the slot is at or after its first tick.
+      unsigned shift = static_cast<unsigned>(level) * kSlotBits;
+      std::uint64_t above =
+          shift + kSlotBits >= 64 ? 0 : now >> (shift + kSlotBits)
+                                               << (shift + kSlotBits);
+      now = above | (static_cast<std::uint64_t>(slot) << shift);
+      while (node != nullptr) {
+        Node *next = node->next;
+        place(node);
+        node = next;
+      } // while
+    }   // while
+  }     // settle()
+
+  // Description: Exchange all timers (not the allocator) with 'other'.
+  void swapTimers(TimingWheel &other) {
+    std::swap(heads, other.heads);
+    std::swap(occupied, other.occupied);
+    std::swap(now, other.now);
+    std::swap(count, other.count);
+    std::swap(this->compare, other.compare);
+  } // swapTimers()
+};  // TimingWheel
+
+namespace pmr {
+// A TimingWheel whose nodes come from a std::pmr::memory_resource.
+template <typename TYPE, typename TICK_OF = TickOf<TYPE>>
+using TimingWheel =
+    ::TimingWheel<TYPE, TICK_OF, std::pmr::polymorphic_allocator<TYPE>>;
+} // namespace pmr
+
+#endif // TIMINGWHEEL_H
@@ -0,0 +1,111 @@
+// Project identifier: 43DE0E0C4C76BFAA6D8C2F5AEAE0518A9C42CF4E
+
+#ifndef TOPK_H
+#define TOPK_H
+
+#include <cstddef>
+#include <iterator>
+#include <memory>
+#include <vector>
+
+#include "BinaryPQ.hpp"
+
+// Reverses the sense of a comparison functor, so that a heap built with it
+// keeps the least extreme element on top.
+template <typename COMP_FUNCTOR> struct InvertedComp {
+  COMP_FUNCTOR comp;
+
+  template <typename LHS, typename RHS>
+  bool operator()(const LHS &a, const RHS &b) const {
+    return comp(b, a);
+  } // operator()()
+}; // InvertedComp
+
+// A bounded selector that keeps the K most extreme (defined by 'compare')
+// elements of a stream.  The elements are held in a BinaryPQ with the
+// comparator inverted, so the worst element kept is always on top: a
+// newcomer is rejected with a single comparison against it, or replaces it
+// with a single fixDown.
+template <typename TYPE, typename COMP_FUNCTOR = std::less<TYPE>,
+          typename ALLOCATOR = std::allocator<TYPE>>
+class TopK {
+  using Heap = BinaryPQ<TYPE, InvertedComp<COMP_FUNCTOR>, ALLOCATOR>;
+
+public:
+  // Description: Construct an empty selector that keeps at most 'k'
+  //              elements, with an optional comparison functor and
+  //              allocator.
+  // Runtime: O(1)
+  explicit TopK(std::size_t k, COMP_FUNCTOR comp = COMP_FUNCTOR(),
+                const ALLOCATOR &alloc = ALLOCATOR())
+      : compare{comp}, heap{InvertedComp<COMP_FUNCTOR>{comp}, alloc},
+        limit{k} {} // TopK()
+
+  // Description: Offer one element.  Returns true if it was kept.
+  // Runtime: O(1) if rejected, O(log(k)) otherwise.
+  bool push(const TYPE &val) {
+    if (heap.size() < limit) {
+      heap.push(val);
+      return true;
+    } // if
+    if (limit == 0 || !compare(heap.top(), val)) {
+      return false;
+    } // if
+    heap.replaceTop(val);
+    return true;
+  } // push()
+
+  // Description: Offer every element of a range.  While the selector is
+  //              empty the first k elements are heapified in one O(k)
+  //              build; the rest take the same path as push().
+  // Runtime: O(n log(k)) worst case, O(n) when most elements are rejected.
+  template <typename InputIterator>
+  void pushBatch(InputIterator start, InputIterator end) {
+    if (heap.empty() && limit > 0) {
+      std::vector<TYPE, ALLOCATOR> first(heap.get_allocator());
+      first.reserve(limit);
+      for (; start != end && first.size() < limit; ++start) {
+        first.push_back(*start);
+      } // for ..start
+      heap = Heap{first.begin(), first.end(),
+                  InvertedComp<COMP_FUNCTOR>{compare}, heap.get_allocator()};
+    } // if
+    for (; start != end; ++start) {
+      push(*start);
+    } // for ..start
+  }   // pushBatch()
+
+  // Description: Return the least extreme element that is currently kept,
+  //              which is the bar a newcomer has to beat once full().
+  // Runtime: O(1)
+  const TYPE &worst() const { return heap.top(); } // worst()
+
+  // Description: Empty the selector, returning the kept elements with the
+  //              most extreme first.  The heap is sorted in place; under the
+  //              inverted comparator its ascending order is best first.
+  // Runtime: O(k log(k))
+  std::vector<TYPE, ALLOCATOR> extractSorted() { return heap.drainSorted(); }
+
+  // Description: Get the number of elements kept.
+  // Runtime: O(1)
+  [[nodiscard]] std::size_t size() const { return heap.size(); }
+
+  // Description: Get the maximum number of elements kept.
+  // Runtime: O(1)
+  [[nodiscard]] std::size_t capacity() const { return limit; }
+
+  // Description: Return true if no elements are kept.
+  // Runtime: O(1)
+  [[nodiscard]] bool empty() const { return heap.empty(); }
+
+  // Description: Return true if newcomers now have to beat worst().
+  // Runtime: O(1)
+  [[nodiscard]] bool full() const { return heap.size() >= limit; }
+
+private:
+  COMP_FUNCTOR compare;
+  Heap heap;
+  std::size_t limit;
+}; // TopK
+
+#endif // TOPK_H
@@ -0,0 +1,246 @@
+// Project identifier: 43DE0E0C4C76BFAA6D8C2F5AEAE0518A9C42CF4E
+
+#ifndef TRACEREPLAY_H
+#define TRACEREPLAY_H
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "RecordingPQ.hpp"
+
+// A trace file written by RecordingPQ, mapped into memory read-only.
+// Throws std::runtime_error if the file cannot be mapped or is not a
+// trace.  POSIX only.
+class MappedTrace {
+public:
+  explicit MappedTrace(const std::string &path) {
+    int fd = ::open(path.c_str(), O_RDONLY); // NOLINT: POSIX vararg
+    if (fd < 0) {
+      throw std::runtime_error("cannot open trace file " + path);
+    } // if
+    struct stat info {};
+    if (::fstat(fd, &info) != 0 ||
+        static_cast<std::size_t>(info.st_size) < sizeof(TraceHeader)) {
+      ::close(fd);
+      throw std::runtime_error(path + " is not a PQ trace");
+    } // if
+    length = static_cast<std::size_t>(info.st_size);
+    void *mapped = ::mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (mapped == MAP_FAILED) { // NOLINT: POSIX macro
+      throw std::runtime_error("cannot map trace file " + path);
+    } // if
+    base = static_cast<const char *>(mapped);
+    // The records are read front to back exactly once.
+    ::madvise(mapped, length, MADV_SEQUENTIAL);
+
+    std::memcpy(&header, base, sizeof(header));
+    if (std::memcmp(header.magic, kTraceMagic, sizeof(kTraceMagic)) != 0 ||
+        header.version != kTraceVersion) {
+      unmap();
+      throw std::runtime_error(path + " is not a PQ trace");
+    } // if
+  }   // MappedTrace()
+
+  MappedTrace(const MappedTrace &) = delete;
+  MappedTrace &operator=(const MappedTrace &) = delete;
+  ~MappedTrace() { unmap(); }
+
+  const TraceHeader &info() const { return header; }
+
+  // The records, after the header.
+  const char *begin() const { return base + sizeof(TraceHeader); }
+  const char *end() const { return base + length; }
+
+private:
+  const char *base = nullptr;
+  std::size_t length = 0;
+  TraceHeader header{};
+
+  void unmap() {
+    if (base != nullptr) {
+      ::munmap(const_cast<char *>(base), length); // NOLINT: munmap's API
+      base = nullptr;
+    } // if
+  }   // unmap()
+};    // MappedTrace
+
+// Throughput of one phase of a replay.
+struct PhaseResult {
+  std::string name;
+  std::uint64_t ops = 0;
+  double seconds = 0;
+}; // PhaseResult
+
+// Results of replayTrace().
+struct ReplayResult {
+  std::vector<PhaseResult> phases;
+  // Top and PushPop results that differed from the recording.
+  std::uint64_t mismatches = 0;
+  // Index of the first record that differed, if any.
+  std::uint64_t firstMismatch = 0;
+}; // ReplayResult
+
+// Detects PQs with addNode() handles, such as PairingPQ.
+template <typename PQ, typename TYPE, typename = void>
+struct HasHandles : std::false_type {
+  using Handle = void *;
+}; // HasHandles
+
+template <typename PQ, typename TYPE>
+struct HasHandles<PQ, TYPE,
+                  std::void_t<decltype(std::declval<PQ &>().addNode(
+                      std::declval<const TYPE &>()))>> : std::true_type {
+  using Handle =
+      decltype(std::declval<PQ &>().addNode(std::declval<const TYPE &>()));
+}; // HasHandles
+
+// Description: Replay the records of 'trace' against 'pq', which should
+//              start empty, and check every Top and PushPop result against
+//              the recording; elements are equal if neither compares less
+//              than the other.  UpdateElt uses the PQ's handles if it has
+//              them and is of the recorded type, and otherwise removes one
+//              element equal to the old value and pushes the new one.  A
+//              PQ of another type may break ties differently and pop a
+//              node the trace still updates later, so its handles are not
+//              used.  Throws std::runtime_error if the records are cut
+//              short or unknown.
+// Runtime: O(number of records) operations on 'pq'.
+template <typename TYPE, typename COMP_FUNCTOR, typename PQ>
+ReplayResult replayTrace(const MappedTrace &trace, PQ &pq,
+                         COMP_FUNCTOR comp = COMP_FUNCTOR()) {
+  static_assert(std::is_trivially_copyable_v<TYPE>,
+                "trace values are the raw bytes of the elements");
+  if (trace.info().elementSize != sizeof(TYPE)) {
+    throw std::runtime_error("trace element size does not match");
+  } // if
+
+  using Clock = std::chrono::steady_clock;
+  constexpr bool kHandles = HasHandles<PQ, TYPE>::value;
+  std::vector<typename HasHandles<PQ, TYPE>::Handle> handles;
+  const bool useHandles = kHandles && trace.info().hasUpdates != 0 &&
+                          trace.info().pqType == tracePQTypeOf<PQ>();
+
+  ReplayResult result;
+  result.phases.push_back(PhaseResult{"all", 0, 0});
+  const char *cursor = trace.begin();
+  const char *const end = trace.end();
+  auto read = [&cursor, end](auto &out) {
+    if (static_cast<std::size_t>(end - cursor) < sizeof(out)) {
+      throw std::runtime_error("trace is cut short");
+    } // if
+    std::memcpy(&out, cursor, sizeof(out));
+    cursor += sizeof(out);
+  };
+  auto equal = [&comp](const TYPE &a, const TYPE &b) {
+    return !comp(a, b) && !comp(b, a);
+  };
+  auto check = [&](const TYPE &actual, const TYPE &recorded,
+                   std::uint64_t index) {
+    if (!equal(actual, recorded) && result.mismatches++ == 0) {
+      result.firstMismatch = index;
+    } // if
+  };
+
+  std::uint64_t index = 0;
+  std::uint64_t phaseOps = 0;
+  auto phaseStart = Clock::now();
+  TYPE val;
+  TYPE other;
+  for (; cursor != end; ++index) {
+    TraceOp op{};
+    read(op);
+    switch (op) {
+    case TraceOp::Push:
+      read(val);
+      if constexpr (kHandles) {
+        if (useHandles) {
+          handles.push_back(pq.addNode(val));
+          break;
+        } // if
+      }   // if
+      pq.push(val);
+      break;
+    case TraceOp::Pop:
+      pq.pop();
+      break;
+    case TraceOp::Top:
+      read(val);
+      check(pq.top(), val, index);
+      break;
+    case TraceOp::UpdatePriorities:
+      pq.updatePriorities();
+      break;
+    case TraceOp::ReplaceTop:
+      read(val);
+      pq.replaceTop(val);
+      break;
+    case TraceOp::PushPop:
+      read(val);
+      read(other);
+      check(pq.pushPop(val), other, index);
+      break;
+    case TraceOp::UpdateElt: {
+      std::uint64_t number = 0;
+      read(number);
+      read(other);
+      read(val);
+      if constexpr (kHandles) {
+        if (useHandles && number < handles.size()) {
+          pq.updateElt(handles[number], val);
+          break;
+        } // if
+      }   // if
+      bool found = false;
+      pq.eraseIf([&](const TYPE &elt) {
+        return !found && equal(elt, other) && (found = true);
+      });
+      pq.push(val);
+      break;
+    }
+    case TraceOp::Phase: {
+      std::uint16_t nameLength = 0;
+      read(nameLength);
+      if (static_cast<std::size_t>(end - cursor) < nameLength) {
+        throw std::runtime_error("trace is cut short");
+      } // if
+      auto now = Clock::now();
+      result.phases.back().ops = phaseOps;
+      result.phases.back().seconds =
+          std::chrono::duration<double>(now - phaseStart).count();
+      if (phaseOps == 0) {
+        result.phases.pop_back();
+      } // if
+      result.phases.push_back(
+          PhaseResult{std::string(cursor, nameLength), 0, 0});
+      cursor += nameLength;
+      phaseOps = 0;
+      phaseStart = Clock::now();
+      continue; // a marker, not an operation
+    }
+    default:
+      throw std::runtime_error("unknown trace record at index " +
+                               std::to_string(index));
+    } // switch
+    ++phaseOps;
+  } // for ..index
+
+  result.phases.back().ops = phaseOps;
+  result.phases.back().seconds =
+      std::chrono::duration<double>(Clock::now() - phaseStart).count();
+  return result;
+} // replayTrace()
+
+#endif // TRACEREPLAY_H
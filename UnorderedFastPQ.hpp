@@ -3,9 +3,13 @@
 #ifndef UNORDEREDFASTPQ_H
 #define UNORDEREDFASTPQ_H
 
+#include <algorithm>
 #include <limits> // needed for kUnknown
+#include <memory>
+#include <memory_resource>
 
 #include "Eecs281PQ.hpp"
+#include "MemoryUsage.hpp"
 
 static const size_t kUnknown = std::numeric_limits<size_t>::max();
 
@@ -21,24 +25,34 @@ static const size_t kUnknown = std::numeric_limits<size_t>::max();
 // Pay particular attention to how the constructors and findExtreme()
 // are written, especially the use of this->compare.
 
-template <typename TYPE, typename COMP_FUNCTOR = std::less<TYPE>>
+// The optional ALLOCATOR is used for the underlying data vector, and the
+// optional SHRINK policy (see MemoryUsage.hpp) decides when pop() and
+// eraseIf() give its capacity back.
+template <typename TYPE, typename COMP_FUNCTOR = std::less<TYPE>,
+          typename ALLOCATOR = std::allocator<TYPE>,
+          typename SHRINK = NeverShrink>
 class UnorderedFastPQ : public Eecs281PQ<TYPE, COMP_FUNCTOR> {
   // This is a way to refer to the base class object.
   using BaseClass = Eecs281PQ<TYPE, COMP_FUNCTOR>;
 
 public:
-  // Description: Construct an empty PQ with optional comparison functor.
+  using allocator_type = ALLOCATOR;
+
+  // Description: Construct an empty PQ with optional comparison functor
+  //              and allocator.
   // Runtime: O(1)
-  explicit UnorderedFastPQ(COMP_FUNCTOR comp = COMP_FUNCTOR())
-      : BaseClass{comp}, extreme{kUnknown} {} // UnorderedFastPQ()
+  explicit UnorderedFastPQ(COMP_FUNCTOR comp = COMP_FUNCTOR(),
+                           const ALLOCATOR &alloc = ALLOCATOR())
+      : BaseClass{comp}, data(alloc), extreme{kUnknown} {} // UnorderedFastPQ()
 
   // Description: Construct a PQ out of an iterator range with optional
-  //              comparison functor.
+  //              comparison functor and allocator.
   // Runtime: O(n) where n is number of elements in range.
   template <typename InputIterator>
   UnorderedFastPQ(InputIterator start, InputIterator end,
-                  COMP_FUNCTOR comp = COMP_FUNCTOR())
-      : BaseClass{comp}, data{start, end}, extreme{kUnknown} {}
+                  COMP_FUNCTOR comp = COMP_FUNCTOR(),
+                  const ALLOCATOR &alloc = ALLOCATOR())
+      : BaseClass{comp}, data(start, end, alloc), extreme{kUnknown} {}
 
   // Description: Destructor doesn't need any code, the data vector will
   //              be destroyed automatically.
@@ -88,12 +102,81 @@ public:
     // of a vector.
     data[extreme] = data.back();
     data.pop_back();
+    SHRINK::apply(data);
 
     // Since the most extreme element has been removed, we no longer know
     // where to find it.
     extreme = kUnknown;
   } // pop()
 
+  // Description: Overwrite the most extreme element with 'val'.
+  // Runtime: O(n), or O(1) if the most extreme element is already known.
+  virtual void replaceTop(const TYPE &val) {
+    if (extreme == kUnknown) {
+      findExtreme();
+    } // if ..unknown
+    data[extreme] = val;
+    extreme = kUnknown;
+  } // replaceTop()
+
+  // Description: Add 'val', then remove and return the most extreme
+  //              element, with at most one search for it.  When 'val' is
+  //              returned right away the known index stays valid.
+  // Runtime: O(n), or O(1) if the most extreme element is already known.
+  virtual TYPE pushPop(const TYPE &val) {
+    if (data.empty()) {
+      return val;
+    } // if
+    if (extreme == kUnknown) {
+      findExtreme();
+    } // if ..unknown
+    if (!this->compare(val, data[extreme])) {
+      return val;
+    } // if
+    TYPE result = std::move(data[extreme]);
+    data[extreme] = val;
+    extreme = kUnknown;
+    return result;
+  } // pushPop()
+
+  // Description: Empty the PQ and hand back its elements, in no particular
+  //              order, e.g. to bulk-build another PQ from them.
+  // Runtime: O(1)
+  std::vector<TYPE, ALLOCATOR> extractAll() {
+    std::vector<TYPE, ALLOCATOR> result{std::move(data)};
+    data.clear();
+    extreme = kUnknown;
+    return result;
+  } // extractAll()
+
+  // Description: Remove every element for which 'pred' returns true, in
+  //              one pass over the data.  Returns the number removed.
+  // Runtime: O(n)
+  template <typename PREDICATE> std::size_t eraseIf(PREDICATE pred) {
+    auto newEnd = std::remove_if(data.begin(), data.end(), pred);
+    auto erased = static_cast<std::size_t>(data.end() - newEnd);
+    data.erase(newEnd, data.end());
+    SHRINK::apply(data);
+    // The cached index may point at a removed or moved element.
+    extreme = kUnknown;
+    return erased;
+  } // eraseIf()
+
+  // Description: Empty the PQ, writing its elements to 'out' with the most
+  //              extreme first.  Returns the output iterator one past the
+  //              last element written.
+  // Runtime: O(n log(n))
+  template <typename OutputIterator>
+  OutputIterator drainSorted(OutputIterator out) {
+    // There is no order to reuse, so simply sort everything once instead
+    // of searching for the extreme element n times.
+    std::sort(data.begin(), data.end(), this->compare);
+    out = std::move(data.rbegin(), data.rend(), out);
+    data.clear();
+    extreme = kUnknown;
+    return out;
+  } // drainSorted()
+
   // Description: Return the most extreme (defined by 'compare') element of
   //              the vector.  This should be a reference for speed. It
   //              MUST be const because we cannot allow it to be modified,
@@ -118,9 +201,20 @@ public:
   // Runtime: O(1)
   virtual bool empty() const { return data.empty(); }
 
+  // Description: Return a copy of the allocator used by the data vector.
+  // Runtime: O(1)
+  allocator_type get_allocator() const { return data.get_allocator(); }
+
+  // Description: Return the bytes held for elements, for the vector's
+  //              allocation itself, and in unused capacity.
+  // Runtime: O(1)
+  [[nodiscard]] MemoryUsage memoryUsage() const {
+    return vectorMemoryUsage(data, data.size());
+  } // memoryUsage()
+
 private:
   // Note: This vector *must* be used for your PQ implementation.
-  std::vector<TYPE> data;
+  std::vector<TYPE, ALLOCATOR> data;
 
   // A member variable that can be changed by a const member function;
   // stores the index of the most extreme element, or kUnknown.
@@ -143,4 +237,13 @@ private:
   } // findExtreme()
 };  // UnorderedFastPQ
 
+namespace pmr {
+// An UnorderedFastPQ whose storage comes from a std::pmr::memory_resource.
+template <typename TYPE, typename COMP_FUNCTOR = std::less<TYPE>,
+          typename SHRINK = NeverShrink>
+using UnorderedFastPQ =
+    ::UnorderedFastPQ<TYPE, COMP_FUNCTOR, std::pmr::polymorphic_allocator<TYPE>,
+                      SHRINK>;
+} // namespace pmr
+
 #endif // UNORDEREDFASTPQ_H
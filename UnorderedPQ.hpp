@@ -4,7 +4,12 @@
 #ifndef UNORDEREDPQ_H
 #define UNORDEREDPQ_H
 
+#include <algorithm>
+#include <memory>
+#include <memory_resource>
+
 #include "Eecs281PQ.hpp"
+#include "MemoryUsage.hpp"
 
 // A specialized version of the priority queue ADT that is implemented with
 // an underlying unordered array-based container that is linearly searched
@@ -14,25 +19,36 @@
 // Pay particular attention to how the constructors and findExtreme()
 // are written, especially the use of this->compare.
 
-template<typename TYPE, typename COMP_FUNCTOR = std::less<TYPE>>
+// The optional ALLOCATOR is used for the underlying data vector, and the
+// optional SHRINK policy (see MemoryUsage.hpp) decides when pop() and
+// eraseIf() give its capacity back.
+template<typename TYPE, typename COMP_FUNCTOR = std::less<TYPE>,
+         typename ALLOCATOR = std::allocator<TYPE>,
+         typename SHRINK = NeverShrink>
 class UnorderedPQ : public Eecs281PQ<TYPE, COMP_FUNCTOR> {
     // This is a way to refer to the base class object.
     using BaseClass = Eecs281PQ<TYPE, COMP_FUNCTOR>;
 
 public:
-    // Description: Construct an empty PQ with optional comparison functor.
+    using allocator_type = ALLOCATOR;
+
+    // Description: Construct an empty PQ with optional comparison functor
+    //              and allocator.
     // Runtime: O(1)
-    explicit UnorderedPQ(COMP_FUNCTOR comp = COMP_FUNCTOR())
-        : BaseClass { comp } {}  // UnorderedPQ()
+    explicit UnorderedPQ(COMP_FUNCTOR comp = COMP_FUNCTOR(),
+                         const ALLOCATOR &alloc = ALLOCATOR())
+        : BaseClass { comp }
+        , data(alloc) {}  // UnorderedPQ()
 
 
     // Description: Construct a PQ out of an iterator range with optional
-    //              comparison functor.
+    //              comparison functor and allocator.
     // Runtime: O(n) where n is number of elements in range.
     template<typename InputIterator>
-    UnorderedPQ(InputIterator start, InputIterator end, COMP_FUNCTOR comp = COMP_FUNCTOR())
+    UnorderedPQ(InputIterator start, InputIterator end, COMP_FUNCTOR comp = COMP_FUNCTOR(),
+                const ALLOCATOR &alloc = ALLOCATOR())
         : BaseClass { comp }
-        , data { start, end } {}
+        , data(start, end, alloc) {}
 
 
     // Description: Destructor doesn't need any code, the data vector will
@@ -77,9 +93,70 @@ public:
         // of a vector.
         data[findExtreme()] = data.back();
         data.pop_back();
+        SHRINK::apply(data);
     }  // pop()
 
 
+    // Description: Overwrite the most extreme element with 'val'.
+    // Runtime: O(n)
+    virtual void replaceTop(const TYPE &val) { data[findExtreme()] = val; }
+
+
+    // Description: Add 'val', then remove and return the most extreme
+    //              element, with a single search for it.
+    // Runtime: O(n)
+    virtual TYPE pushPop(const TYPE &val) {
+        if (data.empty()) {
+            return val;
+        }  // if
+        size_t index = findExtreme();
+        if (!this->compare(val, data[index])) {
+            return val;
+        }  // if
+        TYPE result = std::move(data[index]);
+        data[index] = val;
+        return result;
+    }  // pushPop()
+
+
+    // Description: Empty the PQ and hand back its elements, in no
+    //              particular order, e.g. to bulk-build another PQ from them.
+    // Runtime: O(1)
+    std::vector<TYPE, ALLOCATOR> extractAll() {
+        std::vector<TYPE, ALLOCATOR> result { std::move(data) };
+        data.clear();
+        return result;
+    }  // extractAll()
+
+
+    // Description: Remove every element for which 'pred' returns true, in
+    //              one pass over the data.  Returns the number removed.
+    // Runtime: O(n)
+    template<typename PREDICATE>
+    std::size_t eraseIf(PREDICATE pred) {
+        auto newEnd = std::remove_if(data.begin(), data.end(), pred);
+        auto erased = static_cast<std::size_t>(data.end() - newEnd);
+        data.erase(newEnd, data.end());
+        SHRINK::apply(data);
+        return erased;
+    }  // eraseIf()
+
+
+    // Description: Empty the PQ, writing its elements to 'out' with the most
+    //              extreme first.  Returns the output iterator one past the
+    //              last element written.
+    // Runtime: O(n log(n))
+    template<typename OutputIterator>
+    OutputIterator drainSorted(OutputIterator out) {
+        // There is no order to reuse, so simply sort everything once
+        // instead of searching for the extreme element n times.
+        std::sort(data.begin(), data.end(), this->compare);
+        out = std::move(data.rbegin(), data.rend(), out);
+        data.clear();
+        return out;
+    }  // drainSorted()
+
+
     // Description: Return the most extreme (defined by 'compare') element of
     //              the vector.  This should be a reference for speed.  It
     //              MUST be const because we cannot allow it to be modified,
@@ -100,9 +177,20 @@ public:
     // Runtime: O(1)
     [[nodiscard]] virtual bool empty() const { return data.empty(); }
 
+    // Description: Return a copy of the allocator used by the data vector.
+    // Runtime: O(1)
+    allocator_type get_allocator() const { return data.get_allocator(); }
+
+    // Description: Return the bytes held for elements, for the vector's
+    //              allocation itself, and in unused capacity.
+    // Runtime: O(1)
+    [[nodiscard]] MemoryUsage memoryUsage() const {
+        return vectorMemoryUsage(data, data.size());
+    }  // memoryUsage()
+
 private:
     // Note: This vector *must* be used for your PQ implementation.
-    std::vector<TYPE> data;
+    std::vector<TYPE, ALLOCATOR> data;
 
     // Description: Find the 'most extreme' element of the data vector, using
     //              this->compare() to check if one element is 'less than'
@@ -121,4 +209,13 @@ private:
     }  // findExtreme()
 };  // UnorderedPQ
 
+namespace pmr {
+// An UnorderedPQ whose storage comes from a std::pmr::memory_resource.
+template<typename TYPE, typename COMP_FUNCTOR = std::less<TYPE>,
+         typename SHRINK = NeverShrink>
+using UnorderedPQ = ::UnorderedPQ<TYPE, COMP_FUNCTOR,
+                                  std::pmr::polymorphic_allocator<TYPE>,
+                                  SHRINK>;
+}  // namespace pmr
+
 #endif  // UNORDEREDPQ_H
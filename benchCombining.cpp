@@ -0,0 +1,239 @@
+// Project identifier: 43DE0E0C4C76BFAA6D8C2F5AEAE0518A9C42CF4E
+
+/*
+ * Exact-order concurrent PQs: a mutex around the PQ against flat
+ * combining (FlatCombiningPQ.hpp).
+ *
+ * For every (pq, threads), with threads the powers of two from
+ * --min-threads to --max-threads, the PQ is filled with --size random
+ * keys, then every thread makes --ops operations, a push of a random key
+ * or a pop with equal odds, once with each thread locking a std::mutex
+ * around the PQ and once through a FlatCombiningPQ.  Reported are the
+ * operations per second of all threads together, and the ratio.
+ *
+ * Usage: ./benchCombining [--pq binary,pairing] [--min-threads 1]
+ *                         [--max-threads 64] [--size 10000]
+ *                         [--ops 200000] [--seed 281]
+ */
+
+#include <getopt.h>
+
+#include <cstdint>
+#include <cstdlib>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <mutex>
+#include <optional>
+#include <random>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "Benchmark.hpp"
+#include "FlatCombiningPQ.hpp"
+
+namespace {
+
+// Settings from the command line.
+struct Options {
+  std::vector<std::string> pqs{"binary", "pairing"};
+  std::size_t minThreads = 1;
+  std::size_t maxThreads = 64; // NOLINT: a large machine
+  std::size_t size = 10000;    // NOLINT: 1e4
+  std::size_t ops = 200000;    // NOLINT: 2e5 per thread
+  std::uint32_t seed = 281;    // NOLINT: default seed
+};                             // Options
+
+// Results of one (pq, threads) combination.
+struct RunResult {
+  double mutexOpsPerSecond = 0;
+  double combiningOpsPerSecond = 0;
+}; // RunResult
+
+// The baseline: every operation locks one mutex around the PQ.
+template <typename PQ> class LockedPQ {
+public:
+  using value_type = typename PQTypes<PQ>::Type;
+
+  explicit LockedPQ(PQ inner) : pq{std::move(inner)} {}
+
+  void push(const value_type &val) {
+    std::lock_guard<std::mutex> lock{mutex};
+    pq.push(val);
+  } // push()
+
+  std::optional<value_type> tryPop() {
+    std::lock_guard<std::mutex> lock{mutex};
+    if (pq.empty()) {
+      return std::nullopt;
+    } // if
+    std::optional<value_type> result{pq.top()};
+    pq.pop();
+    return result;
+  } // tryPop()
+
+private:
+  std::mutex mutex;
+  PQ pq;
+}; // LockedPQ
+
+// Description: Run 'threads' threads of 'ops' random pushes and pops on
+//              'shared'.  Returns the operations per second.
+template <typename SHARED>
+double runThreads(SHARED &shared, std::size_t threads, std::size_t ops,
+                  std::uint32_t seed) {
+  std::vector<std::thread> workers;
+  auto start = BenchClock::now();
+  for (std::size_t t = 0; t < threads; ++t) {
+    workers.emplace_back([&shared, ops, seed, t] {
+      std::mt19937_64 gen{seed + t};
+      for (std::size_t i = 0; i < ops; ++i) {
+        std::uint64_t key = gen();
+        if (key % 2 == 0) {
+          shared.push(key);
+        } else {
+          shared.tryPop();
+        } // if
+      }   // for ..i
+    });
+  } // for ..t
+  for (auto &worker : workers) {
+    worker.join();
+  } // for ..worker
+  double seconds = secondsBetween(start, BenchClock::now());
+  return static_cast<double>(threads * ops) / seconds;
+} // runThreads()
+
+// Description: Measure both ways of sharing the PQ called 'name'.
+//              Returns false for an unknown name.
+bool runPQ(const Options &options, const std::string &name,
+           std::size_t threads, RunResult &result) {
+  std::mt19937_64 gen{options.seed};
+  std::vector<std::uint64_t> keys(options.size);
+  for (auto &key : keys) {
+    key = gen();
+  } // for ..key
+  return visitPQ<std::uint64_t, std::less<std::uint64_t>>(
+      name, [&](auto &pq) {
+        using Queue = std::decay_t<decltype(pq)>;
+        for (auto key : keys) {
+          pq.push(key);
+        } // for ..key
+        Queue copy{pq};
+        LockedPQ<Queue> locked{std::move(pq)};
+        result.mutexOpsPerSecond =
+            runThreads(locked, threads, options.ops, options.seed);
+        FlatCombiningPQ<Queue> combining{std::move(copy)};
+        result.combiningOpsPerSecond =
+            runThreads(combining, threads, options.ops, options.seed);
+      });
+} // runPQ()
+
+void printUsage(const char *prog) {
+  std::cout << "Usage: " << prog << " [--pq LIST] [--min-threads N]"
+            << " [--max-threads N]\n"
+            << "       [--size N] [--ops N] [--seed S]\n"
+            << "  PQs:";
+  for (const auto &name : pqNames()) {
+    std::cout << ' ' << name;
+  } // for ..name
+  std::cout << std::endl;
+} // printUsage()
+
+bool getOptions(int argc, char *argv[], Options &options) {
+  // NOLINTNEXTLINE: getopt_long requires a C array
+  static struct option longOpts[] = {
+      {"pq", required_argument, nullptr, 'p'},
+      {"min-threads", required_argument, nullptr, 't'},
+      {"max-threads", required_argument, nullptr, 'T'},
+      {"size", required_argument, nullptr, 'n'},
+      {"ops", required_argument, nullptr, 'o'},
+      {"seed", required_argument, nullptr, 's'},
+      {"help", no_argument, nullptr, 'h'},
+      {nullptr, 0, nullptr, '\0'},
+  };
+
+  int choice = 0;
+  while ((choice = getopt_long(argc, argv, "p:t:T:n:o:s:h", longOpts,
+                               nullptr)) != -1) {
+    switch (choice) {
+    case 'p':
+      options.pqs = splitList(optarg);
+      break;
+    case 't':
+      options.minThreads = std::strtoull(optarg, nullptr, 10); // NOLINT
+      break;
+    case 'T':
+      options.maxThreads = std::strtoull(optarg, nullptr, 10); // NOLINT
+      break;
+    case 'n':
+      options.size = std::strtoull(optarg, nullptr, 10); // NOLINT: base
+      break;
+    case 'o':
+      options.ops = std::strtoull(optarg, nullptr, 10); // NOLINT: base
+      break;
+    case 's':
+      options.seed = static_cast<std::uint32_t>(
+          std::strtoul(optarg, nullptr, 10)); // NOLINT: base
+      break;
+    case 'h':
+    default:
+      printUsage(argv[0]);
+      return false;
+    } // switch
+  }   // while
+
+  if (options.minThreads == 0 || options.ops == 0) {
+    std::cerr << "--min-threads and --ops must be at least 1" << std::endl;
+    return false;
+  } // if
+  return true;
+} // getOptions()
+
+} // namespace
+
+int main(int argc, char *argv[]) {
+  std::ios_base::sync_with_stdio(false);
+  Options options;
+  if (!getOptions(argc, argv, options)) {
+    return 1;
+  } // if
+
+  std::cout << options.ops << " operations per thread on " << options.size
+            << " elements\n"
+            << std::left << std::setw(16) << "pq" << std::right
+            << std::setw(8) << "threads" << std::setw(14) << "mutex op/s"
+            << std::setw(14) << "combined op/s" << std::setw(8) << "ratio"
+            << '\n';
+
+  for (std::size_t threads = options.minThreads;
+       threads <= options.maxThreads; threads *= 2) {
+    for (const auto &name : options.pqs) {
+      std::cout << std::left << std::setw(16) << name << std::right
+                << std::setw(8) << threads;
+      // NOLINTNEXTLINE: 1e4 is where O(n) operations stop being usable
+      if (isLinearPQ(name) && options.size > 10000) {
+        std::cout << "  skipped (O(n) operations)" << std::endl;
+        continue;
+      } // if
+
+      RunResult result;
+      if (!runPQ(options, name, threads, result)) {
+        std::cout << std::endl;
+        std::cerr << "Unknown PQ " << name << std::endl;
+        return 1;
+      } // if
+      std::cout << std::fixed << std::setprecision(0) << std::setw(14)
+                << result.mutexOpsPerSecond << std::setw(14)
+                << result.combiningOpsPerSecond << std::setprecision(2)
+                << std::setw(8)
+                << result.combiningOpsPerSecond / result.mutexOpsPerSecond
+                << std::endl;
+    } // for ..name
+  }   // for ..threads
+
+  return 0;
+} // main()
@@ -0,0 +1,348 @@
+// Project identifier: 43DE0E0C4C76BFAA6D8C2F5AEAE0518A9C42CF4E
+
+/*
+ * Discrete-event simulation workload for the priority queues.
+ *
+ * The PQ is used as an event calendar holding event times, with the
+ * earliest event on top.  Two classic models are available:
+ *
+ *   hold    The queue is filled to a steady-state size n, then each event
+ *           pops the earliest time t and schedules t + increment.  This is
+ *           the usual "hold model" for comparing event-set algorithms.
+ *   updown  The queue is filled to n by scheduling increments after the
+ *           current clock, then drained completely.
+ *
+ * Increments are drawn, with mean 1, from the classic distributions:
+ *   exponential  exp(1)
+ *   uniform      U[0, 2)
+ *   bimodal      U[0, 0.2) with probability 0.9, U[0, 18.2) otherwise
+ *   triangular   U[0, 1) + U[0, 1)
+ *
+ * For every (pq, distribution, n) it reports events per second, measured
+ * over an untimed loop, and then the latency percentiles of individually
+ * timed events (which include the clock's own overhead).  The final
+ * simulation clock is printed as well; for a given seed it must be the
+ * same for every implementation.
+ *
+ * With --record FILE, the first run is also recorded as an operation
+ * trace (RecordingPQ.hpp), with a phase per part of the run, which
+ * benchReplay can then replay against every implementation.
+ *
+ * Usage: ./benchDES [--pq binary,pairing] [--dist all] [--model hold]
+ *                   [--min-size 100] [--max-size 10000000]
+ *                   [--ops 1000000] [--seed 281] [--record FILE]
+ */
+
+#include <getopt.h>
+
+#include <cstdint>
+#include <cstdlib>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include "Benchmark.hpp"
+#include "RecordingPQ.hpp"
+
+namespace {
+
+// Settings from the command line.
+struct Options {
+  std::vector<std::string> pqs{"binary", "pairing"};
+  std::vector<std::string> dists{"exponential", "uniform", "bimodal",
+                                 "triangular"};
+  std::string model{"hold"};
+  std::size_t minSize = 100;      // NOLINT: 1e2
+  std::size_t maxSize = 10000000; // NOLINT: 1e7
+  std::size_t ops = 1000000;      // NOLINT: 1e6
+  std::uint32_t seed = 281;       // NOLINT: default seed
+  std::string record;             // trace file for the first run, if any
+};                                // Options
+
+// Results of one run.
+struct RunResult {
+  double eventsPerSecond = 0;
+  LatencySummary latency;
+  double finalClock = 0;
+}; // RunResult
+
+// Description: Draw 'count' increments with mean 1 from the named
+//              distribution.  They are generated up front so that the
+//              random number generator is not part of the timed loops,
+//              and every PQ sees exactly the same sequence.
+bool makeIncrements(const std::string &dist, std::size_t count,
+                    std::uint32_t seed, std::vector<double> &increments) {
+  std::mt19937_64 gen{seed};
+  std::uniform_real_distribution<double> unit{0.0, 1.0};
+  std::exponential_distribution<double> expo{1.0};
+  std::function<double()> draw;
+  if (dist == "exponential") {
+    draw = [&] { return expo(gen); };
+  } else if (dist == "uniform") {
+    draw = [&] { return 2.0 * unit(gen); };
+  } else if (dist == "bimodal") {
+    draw = [&] {
+      double scale = unit(gen) < 0.9 ? 0.2 : 18.2; // NOLINT: mean 1 mix
+      return scale * unit(gen);
+    };
+  } else if (dist == "triangular") {
+    draw = [&] { return unit(gen) + unit(gen); };
+  } else {
+    return false;
+  } // if
+
+  increments.resize(count);
+  for (auto &inc : increments) {
+    inc = draw();
+  } // for ..inc
+  return true;
+} // makeIncrements()
+
+// Description: Hold model: fill to 'n', warm up, then time 'ops' holds as
+//              a whole and 'ops' more one at a time.
+template <typename PQ>
+RunResult runHold(PQ &pq, std::size_t n, const std::vector<double> &inc) {
+  RunResult result;
+  std::size_t next = 0;
+  auto nextInc = [&]() {
+    double val = inc[next];
+    next = (next + 1 == inc.size()) ? 0 : next + 1;
+    return val;
+  };
+  auto hold = [&]() {
+    double now = pq.top();
+    pq.pop();
+    pq.push(now + nextInc());
+    return now;
+  };
+
+  markPhase(pq, "fill");
+  for (std::size_t i = 0; i < n; ++i) {
+    pq.push(nextInc());
+  } // for ..i
+  markPhase(pq, "warmup");
+  // Run until the initial events have (on average) been replaced, so
+  // the measured part sees the steady-state distribution of the queue.
+  for (std::size_t i = 0; i < n; ++i) {
+    hold();
+  } // for ..i
+
+  const std::size_t ops = inc.size();
+  markPhase(pq, "hold");
+  auto start = BenchClock::now();
+  for (std::size_t i = 0; i < ops; ++i) {
+    hold();
+  } // for ..i
+  result.eventsPerSecond =
+      static_cast<double>(ops) / secondsBetween(start, BenchClock::now());
+
+  std::vector<std::uint64_t> samples(ops);
+  markPhase(pq, "timed hold");
+  for (auto &sample : samples) {
+    auto before = BenchClock::now();
+    result.finalClock = hold();
+    sample = nanosBetween(before, BenchClock::now());
+  } // for ..sample
+  result.latency = summarizeLatencies(samples);
+  return result;
+} // runHold()
+
+// Description: Up-down model: schedule 'n' events after the current clock,
+//              then process them all; once timed as a whole and once one
+//              operation at a time.
+template <typename PQ>
+RunResult runUpDown(PQ &pq, std::size_t n, const std::vector<double> &inc) {
+  RunResult result;
+  std::size_t next = 0;
+  auto nextInc = [&]() {
+    double val = inc[next];
+    next = (next + 1 == inc.size()) ? 0 : next + 1;
+    return val;
+  };
+
+  double now = 0;
+  markPhase(pq, "up");
+  auto start = BenchClock::now();
+  for (std::size_t i = 0; i < n; ++i) {
+    pq.push(now + nextInc());
+  } // for ..i
+  markPhase(pq, "down");
+  while (!pq.empty()) {
+    now = pq.top();
+    pq.pop();
+  } // while
+  result.eventsPerSecond = static_cast<double>(2 * n) /
+                           secondsBetween(start, BenchClock::now());
+
+  std::vector<std::uint64_t> samples;
+  samples.reserve(2 * n);
+  markPhase(pq, "timed up");
+  for (std::size_t i = 0; i < n; ++i) {
+    auto before = BenchClock::now();
+    pq.push(now + nextInc());
+    samples.push_back(nanosBetween(before, BenchClock::now()));
+  } // for ..i
+  markPhase(pq, "timed down");
+  while (!pq.empty()) {
+    auto before = BenchClock::now();
+    now = pq.top();
+    pq.pop();
+    samples.push_back(nanosBetween(before, BenchClock::now()));
+  } // while
+  result.finalClock = now;
+  result.latency = summarizeLatencies(samples);
+  return result;
+} // runUpDown()
+
+void printUsage(const char *prog) {
+  std::cout << "Usage: " << prog
+            << " [--pq LIST] [--dist LIST] [--model hold|updown]\n"
+            << "       [--min-size N] [--max-size N] [--ops N] [--seed S]\n"
+            << "       [--record FILE]\n"
+            << "  LIST is comma separated, or 'all'.\n  PQs:";
+  for (const auto &name : pqNames()) {
+    std::cout << ' ' << name;
+  } // for ..name
+  std::cout << "\n  distributions: exponential uniform bimodal triangular"
+            << std::endl;
+} // printUsage()
+
+bool getOptions(int argc, char *argv[], Options &options) {
+  // NOLINTNEXTLINE: getopt_long requires a C array
+  static struct option longOpts[] = {
+      {"pq", required_argument, nullptr, 'p'},
+      {"dist", required_argument, nullptr, 'd'},
+      {"model", required_argument, nullptr, 'm'},
+      {"min-size", required_argument, nullptr, 'n'},
+      {"max-size", required_argument, nullptr, 'N'},
+      {"ops", required_argument, nullptr, 'o'},
+      {"seed", required_argument, nullptr, 's'},
+      {"record", required_argument, nullptr, 'r'},
+      {"help", no_argument, nullptr, 'h'},
+      {nullptr, 0, nullptr, '\0'},
+  };
+
+  int choice = 0;
+  while ((choice = getopt_long(argc, argv, "p:d:m:n:N:o:s:r:h", longOpts,
+                               nullptr)) != -1) {
+    switch (choice) {
+    case 'p':
+      options.pqs = std::string{optarg} == "all" ? pqNames() : splitList(optarg);
+      break;
+    case 'd':
+      if (std::string{optarg} != "all") {
+        options.dists = splitList(optarg);
+      } // if
+      break;
+    case 'm':
+      options.model = optarg;
+      break;
+    case 'n':
+      options.minSize = std::strtoull(optarg, nullptr, 10); // NOLINT: base
+      break;
+    case 'N':
+      options.maxSize = std::strtoull(optarg, nullptr, 10); // NOLINT: base
+      break;
+    case 'o':
+      options.ops = std::strtoull(optarg, nullptr, 10); // NOLINT: base
+      break;
+    case 's':
+      options.seed = static_cast<std::uint32_t>(
+          std::strtoul(optarg, nullptr, 10)); // NOLINT: base
+      break;
+    case 'r':
+      options.record = optarg;
+      break;
+    case 'h':
+    default:
+      printUsage(argv[0]);
+      return false;
+    } // switch
+  }   // while
+
+  if (options.model != "hold" && options.model != "updown") {
+    std::cerr << "Unknown model " << options.model << std::endl;
+    return false;
+  } // if
+  if (options.ops == 0 || options.minSize == 0) {
+    std::cerr << "--ops and --min-size must be positive" << std::endl;
+    return false;
+  } // if
+  return true;
+} // getOptions()
+
+} // namespace
+
+int main(int argc, char *argv[]) {
+  std::ios_base::sync_with_stdio(false);
+  Options options;
+  if (!getOptions(argc, argv, options)) {
+    return 1;
+  } // if
+
+  std::cout << "model " << options.model << ", seed " << options.seed
+            << ", " << options.ops << " timed events\n"
+            << std::left << std::setw(16) << "pq" << std::setw(12) << "dist"
+            << std::right << std::setw(10) << "size" << std::setw(14)
+            << "events/s" << std::setw(8) << "p50ns" << std::setw(8)
+            << "p99ns" << std::setw(9) << "p99.9ns" << std::setw(10)
+            << "maxns" << std::setw(16) << "final clock" << '\n';
+
+  for (const auto &dist : options.dists) {
+    std::vector<double> increments;
+    if (!makeIncrements(dist, options.ops, options.seed, increments)) {
+      std::cerr << "Unknown distribution " << dist << std::endl;
+      return 1;
+    } // if
+
+    for (const auto &name : options.pqs) {
+      for (std::size_t n : powersOfTen(options.minSize, options.maxSize)) {
+        std::cout << std::left << std::setw(16) << name << std::setw(12)
+                  << dist << std::right << std::setw(10) << n;
+        // NOLINTNEXTLINE: 1e4 is where O(n) operations stop being usable
+        if (isLinearPQ(name) && n > 10000) {
+          std::cout << "  skipped (O(n) operations)" << std::endl;
+          continue;
+        } // if
+
+        RunResult result;
+        bool known = visitPQ<double, std::greater<double>>(
+            name, [&](auto &pq) {
+              auto run = [&](auto &runPQ) {
+                result = options.model == "hold"
+                             ? runHold(runPQ, n, increments)
+                             : runUpDown(runPQ, n, increments);
+              };
+              if (options.record.empty()) {
+                run(pq);
+                return;
+              } // if
+              // Timings of the recorded run include the recording.
+              RecordingPQ<std::decay_t<decltype(pq)>> recording{
+                  options.record};
+              options.record.clear();
+              run(recording);
+              recording.close();
+            });
+        if (!known) {
+          std::cout << std::endl;
+          std::cerr << "Unknown PQ " << name << std::endl;
+          return 1;
+        } // if
+
+        std::cout << std::setw(14) << std::fixed << std::setprecision(0)
+                  << result.eventsPerSecond << std::setw(8)
+                  << result.latency.p50 << std::setw(8) << result.latency.p99
+                  << std::setw(9) << result.latency.p999 << std::setw(10)
+                  << result.latency.max << std::setw(16)
+                  << std::setprecision(3) << result.finalClock << std::endl;
+      } // for ..n
+    }   // for ..name
+  }     // for ..dist
+
+  return 0;
+} // main()
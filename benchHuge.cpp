@@ -0,0 +1,277 @@
+// Project identifier: 43DE0E0C4C76BFAA6D8C2F5AEAE0518A9C42CF4E
+
+/*
+ * Queues far larger than the caches: the sequence heap (SequenceHeapPQ.hpp)
+ * against the binary heap, with int and 16-byte elements.
+ *
+ * For every (payload, n, pq), with n the powers of ten from --min-size to
+ * --max-size, three phases are timed on a queue of the smallest key first:
+ *
+ *   fill   n pushes of random keys
+ *   hold   --ops times, pop the smallest key and push it plus a random
+ *          increment, as in a discrete event simulation
+ *   drain  pop all n elements, checking that the keys come out in order
+ *
+ * Reported are nanoseconds per operation of each phase, and the PQ's
+ * memory (memoryUsage().total()) after the fill.  Sizes whose estimated
+ * footprint exceeds three quarters of the physical memory are skipped.
+ *
+ * Usage: ./benchHuge [--pq binary,sequence] [--payload int,16]
+ *                    [--min-size 1000000] [--max-size 1000000000]
+ *                    [--ops 1000000] [--seed 281]
+ */
+
+#include <getopt.h>
+#include <unistd.h>
+
+#include <cstdint>
+#include <cstdlib>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "Benchmark.hpp"
+
+namespace {
+
+// Settings from the command line.
+struct Options {
+  std::vector<std::string> pqs{"binary", "sequence"};
+  std::vector<std::string> payloads{"int", "16"};
+  std::size_t minSize = 1000000;    // NOLINT: 1e6
+  std::size_t maxSize = 1000000000; // NOLINT: 1e9
+  std::size_t ops = 1000000;        // NOLINT: 1e6
+  std::uint32_t seed = 281;         // NOLINT: default seed
+};                                  // Options
+
+// Results of one (payload, n, pq) combination.
+struct RunResult {
+  double fillNanos = 0;
+  double holdNanos = 0;
+  double drainNanos = 0;
+  std::size_t bytes = 0;
+  bool ordered = true;
+}; // RunResult
+
+// A 16-byte element: a key and the payload that travels with it.
+struct Wide {
+  std::uint64_t key;
+  std::uint64_t payload;
+}; // Wide
+
+// Smallest key first.
+struct WideGreater {
+  bool operator()(const Wide &a, const Wide &b) const {
+    return a.key > b.key;
+  } // operator()()
+};  // WideGreater
+
+// Keys start below 2^30, and increments are below 2^20, so int keys do
+// not overflow.
+constexpr int kKeyBits = 30;
+constexpr int kIncrementBits = 20;
+
+int keyOf(int elt) { return elt; }
+std::uint64_t keyOf(const Wide &elt) { return elt.key; }
+
+int makeElt(int key, const int * /*tag*/) { return key; }
+Wide makeElt(int key, const Wide * /*tag*/) {
+  return Wide{static_cast<std::uint64_t>(key),
+              static_cast<std::uint64_t>(key) * 3}; // NOLINT: any payload
+} // makeElt()
+
+// Description: Time the three phases on the empty 'pq'.
+template <typename PQ>
+void runPhases(PQ &pq, std::size_t n, std::size_t ops, std::uint32_t seed,
+               RunResult &result) {
+  using Elt = std::decay_t<decltype(pq.top())>;
+  const Elt *tag = nullptr;
+  std::mt19937 gen{seed};
+  std::uniform_int_distribution<int> keys{0, (1 << kKeyBits) - 1};
+  std::uniform_int_distribution<int> increments{0,
+                                                (1 << kIncrementBits) - 1};
+
+  auto start = BenchClock::now();
+  for (std::size_t i = 0; i < n; ++i) {
+    pq.push(makeElt(keys(gen), tag));
+  } // for ..i
+  result.fillNanos =
+      secondsBetween(start, BenchClock::now()) * 1e9 / // NOLINT: ns per s
+      static_cast<double>(n);
+  result.bytes = pq.memoryUsage().total();
+
+  start = BenchClock::now();
+  for (std::size_t i = 0; i < ops; ++i) {
+    auto key = static_cast<int>(keyOf(pq.top()));
+    pq.pop();
+    pq.push(makeElt(key + increments(gen), tag));
+  } // for ..i
+  result.holdNanos =
+      secondsBetween(start, BenchClock::now()) * 1e9 / // NOLINT: ns per s
+      static_cast<double>(ops);
+
+  start = BenchClock::now();
+  auto last = keyOf(pq.top());
+  while (!pq.empty()) {
+    auto key = keyOf(pq.top());
+    result.ordered = result.ordered && key >= last;
+    last = key;
+    pq.pop();
+  } // while
+  result.drainNanos =
+      secondsBetween(start, BenchClock::now()) * 1e9 / // NOLINT: ns per s
+      static_cast<double>(n);
+} // runPhases()
+
+// Description: Run the phases on the PQ called 'name' with the given
+//              payload.  Returns false for an unknown name or payload.
+bool runPQ(const std::string &name, const std::string &payload,
+           std::size_t n, const Options &options, RunResult &result) {
+  auto run = [&](auto &pq) {
+    runPhases(pq, n, options.ops, options.seed, result);
+  };
+  if (payload == "int") {
+    return visitPQ<int, std::greater<int>>(name, run);
+  } // if
+  if (payload == "16") {
+    return visitPQ<Wide, WideGreater>(name, run);
+  } // if
+  return false;
+} // runPQ()
+
+std::size_t eltSize(const std::string &payload) {
+  return payload == "int" ? sizeof(int) : sizeof(Wide);
+} // eltSize()
+
+// Description: Bytes of physical memory, or 0 if unknown.
+std::size_t physicalMemory() {
+  long pages = sysconf(_SC_PHYS_PAGES);
+  long pageSize = sysconf(_SC_PAGE_SIZE);
+  if (pages <= 0 || pageSize <= 0) {
+    return 0;
+  } // if
+  return static_cast<std::size_t>(pages) * static_cast<std::size_t>(pageSize);
+} // physicalMemory()
+
+void printUsage(const char *prog) {
+  std::cout << "Usage: " << prog << " [--pq LIST] [--payload int,16]"
+            << " [--min-size N] [--max-size N]\n"
+            << "       [--ops N] [--seed S]\n"
+            << "  PQs:";
+  for (const auto &name : pqNames()) {
+    std::cout << ' ' << name;
+  } // for ..name
+  std::cout << std::endl;
+} // printUsage()
+
+bool getOptions(int argc, char *argv[], Options &options) {
+  // NOLINTNEXTLINE: getopt_long requires a C array
+  static struct option longOpts[] = {
+      {"pq", required_argument, nullptr, 'p'},
+      {"payload", required_argument, nullptr, 'P'},
+      {"min-size", required_argument, nullptr, 'n'},
+      {"max-size", required_argument, nullptr, 'N'},
+      {"ops", required_argument, nullptr, 'o'},
+      {"seed", required_argument, nullptr, 's'},
+      {"help", no_argument, nullptr, 'h'},
+      {nullptr, 0, nullptr, '\0'},
+  };
+
+  int choice = 0;
+  while ((choice = getopt_long(argc, argv, "p:P:n:N:o:s:h", longOpts,
+                               nullptr)) != -1) {
+    switch (choice) {
+    case 'p':
+      options.pqs = splitList(optarg);
+      break;
+    case 'P':
+      options.payloads = splitList(optarg);
+      break;
+    case 'n':
+      options.minSize = std::strtoull(optarg, nullptr, 10); // NOLINT: base
+      break;
+    case 'N':
+      options.maxSize = std::strtoull(optarg, nullptr, 10); // NOLINT: base
+      break;
+    case 'o':
+      options.ops = std::strtoull(optarg, nullptr, 10); // NOLINT: base
+      break;
+    case 's':
+      options.seed = static_cast<std::uint32_t>(
+          std::strtoul(optarg, nullptr, 10)); // NOLINT: base
+      break;
+    case 'h':
+    default:
+      printUsage(argv[0]);
+      return false;
+    } // switch
+  }   // while
+
+  if (options.minSize == 0 || options.ops == 0) {
+    std::cerr << "--min-size and --ops must be at least 1" << std::endl;
+    return false;
+  } // if
+  return true;
+} // getOptions()
+
+} // namespace
+
+int main(int argc, char *argv[]) {
+  std::ios_base::sync_with_stdio(false);
+  Options options;
+  if (!getOptions(argc, argv, options)) {
+    return 1;
+  } // if
+
+  std::size_t memory = physicalMemory();
+  std::cout << options.ops << " hold operations\n"
+            << std::left << std::setw(8) << "payload" << std::right
+            << std::setw(12) << "size" << "  " << std::left << std::setw(12)
+            << "pq" << std::right << std::setw(9) << "fill ns"
+            << std::setw(9) << "hold ns" << std::setw(10) << "drain ns"
+            << std::setw(10) << "MB" << '\n';
+
+  for (const auto &payload : options.payloads) {
+    for (std::size_t n : powersOfTen(options.minSize, options.maxSize)) {
+      for (const auto &name : options.pqs) {
+        std::cout << std::left << std::setw(8) << payload << std::right
+                  << std::setw(12) << n << "  " << std::left << std::setw(12)
+                  << name << std::right;
+        // NOLINTNEXTLINE: 1e4 is where O(n) operations stop being usable
+        if (isLinearPQ(name) && n > 10000) {
+          std::cout << "  skipped (O(n) operations)" << std::endl;
+          continue;
+        } // if
+        // Vector growth and merges can hold about three copies at once.
+        if (memory != 0 && 3 * n * eltSize(payload) > memory / 4 * 3) {
+          std::cout << "  skipped (not enough memory)" << std::endl;
+          continue;
+        } // if
+
+        RunResult result;
+        if (!runPQ(name, payload, n, options, result)) {
+          std::cout << std::endl;
+          std::cerr << "Unknown PQ " << name << " or payload " << payload
+                    << std::endl;
+          return 1;
+        } // if
+        if (!result.ordered) {
+          std::cout << std::endl;
+          std::cerr << name << " popped keys out of order" << std::endl;
+          return 1;
+        } // if
+        std::cout << std::fixed << std::setprecision(1) << std::setw(9)
+                  << result.fillNanos << std::setw(9) << result.holdNanos
+                  << std::setw(10) << result.drainNanos
+                  << std::setprecision(0) << std::setw(10)
+                  << static_cast<double>(result.bytes) / 1e6 // NOLINT: MB
+                  << std::endl;
+      } // for ..name
+    }   // for ..n
+  }     // for ..payload
+
+  return 0;
+} // main()
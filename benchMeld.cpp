@@ -0,0 +1,306 @@
+// Project identifier: 43DE0E0C4C76BFAA6D8C2F5AEAE0518A9C42CF4E
+
+/*
+ * Merge-heavy event calendar: where PairingPQ's O(1) meld starts to beat
+ * BinaryPQ, for AdaptivePQ's pairingEnter and pairingLeave thresholds.
+ *
+ * The hold model of benchDES, with merges mixed in: the queue is filled to
+ * size n, then each step is either a hold (pop the earliest time t,
+ * schedule t + increment) or, with some probability, a merge: a queue of
+ * the same kind is filled with --batch new events and merged in.  Two
+ * models decide what happens to the merged events:
+ *
+ *   hold  as many events are popped right after the merge, so the size
+ *         stays n and every merged event is eventually popped
+ *   grow  nothing more is popped, and the queue grows by every merge
+ *
+ * A merge is what AdaptivePQ does with each backend:
+ *
+ *   binary   extractAll() the other BinaryPQ and push its elements
+ *   pairing  meld the other PairingPQ's root in O(1)
+ *
+ * The merge fraction counts operations the way AdaptivePQ does: merges
+ * over the merges, pushes and pops on the big queue.  For every (n, batch,
+ * fraction) it reports nanoseconds per such operation for both kinds and
+ * their ratio; above 1 the pairing heap is faster.  The fill of the
+ * merged queues is timed too, as it depends on their kind.
+ *
+ * Usage: ./benchMeld [--model hold,grow] [--min-size 1000]
+ *                    [--max-size 100000] [--batch 1,8,64]
+ *                    [--fractions 0.001,0.01,0.1,0.25,0.5,0.75,0.9]
+ *                    [--ops 1000000] [--seed 281]
+ *
+ * --model, --batch and --fractions are comma separated.  Fractions that
+ * need more than a merge in every step (above 1 / (batch + 1) for hold)
+ * are skipped.
+ */
+
+#include <getopt.h>
+
+#include <cstdint>
+#include <cstdlib>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "Benchmark.hpp"
+#include "BinaryPQ.hpp"
+#include "PairingPQ.hpp"
+
+namespace {
+
+// Settings from the command line.
+struct Options {
+  std::vector<std::string> models{"hold", "grow"};
+  std::size_t minSize = 1000;                 // NOLINT: 1e3
+  std::size_t maxSize = 100000;               // NOLINT: 1e5
+  std::vector<std::size_t> batches{1, 8, 64}; // NOLINT: events per merge
+  std::vector<double> fractions{0.001, 0.01, 0.1, 0.25, // NOLINT
+                                0.5,   0.75, 0.9};
+  std::size_t ops = 1000000; // NOLINT: 1e6
+  std::uint32_t seed = 281;  // NOLINT: default seed
+};                           // Options
+
+// The earliest event time on top, as in benchDES.
+using Binary = BinaryPQ<double, std::greater<double>>;
+using Pairing = PairingPQ<double, std::greater<double>>;
+
+// Description: Move every element of 'other' into 'pq' the way each
+//              AdaptivePQ backend does.
+void mergeInto(Binary &pq, Binary &other) {
+  for (double val : other.extractAll()) {
+    pq.push(val);
+  } // for ..val
+} // mergeInto()
+
+void mergeInto(Pairing &pq, Pairing &other) { pq.merge(other); }
+
+// The random parts of a run, drawn once so that both kinds replay the same
+// one: which steps merge, and a ring of increments with mean 1.
+struct Workload {
+  std::vector<char> merges;
+  std::vector<double> increments;
+}; // Workload
+
+// Counts of the operations on the big queue.
+struct OpCounts {
+  std::uint64_t merges = 0;
+  std::uint64_t others = 0; // pushes and pops
+};                          // OpCounts
+
+// Description: Fill a PQ of type PQ to 'n' events, then run the steps of
+//              'work', popping 'batch' events after each merge if 'hold'.
+//              Returns the seconds taken by the steps; 'counts' receives
+//              the operations they did on the big queue.
+template <typename PQ>
+double run(const Workload &work, std::size_t n, std::size_t batch, bool hold,
+           OpCounts &counts) {
+  const std::size_t mask = work.increments.size() - 1;
+  std::size_t next = 0;
+  auto increment = [&work, &next, mask] {
+    return work.increments[next++ & mask];
+  };
+
+  PQ pq;
+  for (std::size_t i = 0; i < n; ++i) {
+    pq.push(increment());
+  } // for ..i
+  counts = OpCounts{};
+  double clock = 0;
+  auto start = BenchClock::now();
+  for (char merge : work.merges) {
+    if (merge != 0) {
+      PQ other;
+      for (std::size_t i = 0; i < batch; ++i) {
+        other.push(clock + increment());
+      } // for ..i
+      mergeInto(pq, other);
+      ++counts.merges;
+      if (hold) {
+        for (std::size_t i = 0; i < batch; ++i) {
+          clock = pq.top();
+          pq.pop();
+        } // for ..i
+        counts.others += batch;
+      } // if
+    } else {
+      clock = pq.top();
+      pq.pop();
+      pq.push(clock + increment());
+      counts.others += 2;
+    } // if
+  }   // for ..merge
+  double seconds = secondsBetween(start, BenchClock::now());
+  // Keep the clock observable, so the loop is not optimized away.
+  if (clock < 0) {
+    std::cerr << "negative clock" << std::endl;
+  } // if
+  return seconds;
+} // run()
+
+void printUsage(const char *prog) {
+  std::cout << "Usage: " << prog << " [--model LIST] [--min-size N]"
+            << " [--max-size N]\n"
+            << "       [--batch LIST] [--fractions LIST] [--ops N] [--seed S]\n"
+            << "  models: hold grow" << std::endl;
+} // printUsage()
+
+// Description: Parse a comma-separated list of positive integers; returns
+//              false if one is not.
+bool parseSizes(const std::string &list, std::vector<std::size_t> &sizes) {
+  sizes.clear();
+  for (const auto &item : splitList(list)) {
+    std::size_t size = std::strtoull(item.c_str(), nullptr, 10); // NOLINT
+    if (size == 0) {
+      return false;
+    } // if
+    sizes.push_back(size);
+  } // for ..item
+  return !sizes.empty();
+} // parseSizes()
+
+// Description: Parse a comma-separated list of merge fractions, each in
+//              (0, 1); returns false if one is not.
+bool parseFractions(const std::string &list, std::vector<double> &fractions) {
+  fractions.clear();
+  for (const auto &item : splitList(list)) {
+    double fraction = std::strtod(item.c_str(), nullptr);
+    if (!(fraction > 0 && fraction < 1)) {
+      return false;
+    } // if
+    fractions.push_back(fraction);
+  } // for ..item
+  return !fractions.empty();
+} // parseFractions()
+
+bool getOptions(int argc, char *argv[], Options &options) {
+  // NOLINTNEXTLINE: getopt_long requires a C array
+  static struct option longOpts[] = {
+      {"model", required_argument, nullptr, 'm'},
+      {"min-size", required_argument, nullptr, 'n'},
+      {"max-size", required_argument, nullptr, 'N'},
+      {"batch", required_argument, nullptr, 'b'},
+      {"fractions", required_argument, nullptr, 'f'},
+      {"ops", required_argument, nullptr, 'o'},
+      {"seed", required_argument, nullptr, 's'},
+      {"help", no_argument, nullptr, 'h'},
+      {nullptr, 0, nullptr, '\0'},
+  };
+
+  int choice = 0;
+  while ((choice = getopt_long(argc, argv, "m:n:N:b:f:o:s:h", longOpts,
+                               nullptr)) != -1) {
+    switch (choice) {
+    case 'm':
+      options.models = splitList(optarg);
+      break;
+    case 'n':
+      options.minSize = std::strtoull(optarg, nullptr, 10); // NOLINT: base
+      break;
+    case 'N':
+      options.maxSize = std::strtoull(optarg, nullptr, 10); // NOLINT: base
+      break;
+    case 'b':
+      if (!parseSizes(optarg, options.batches)) {
+        std::cerr << "--batch needs positive sizes" << std::endl;
+        return false;
+      } // if
+      break;
+    case 'f':
+      if (!parseFractions(optarg, options.fractions)) {
+        std::cerr << "--fractions must be between 0 and 1" << std::endl;
+        return false;
+      } // if
+      break;
+    case 'o':
+      options.ops = std::strtoull(optarg, nullptr, 10); // NOLINT: base
+      break;
+    case 's':
+      options.seed = static_cast<std::uint32_t>(
+          std::strtoul(optarg, nullptr, 10)); // NOLINT: base
+      break;
+    case 'h':
+    default:
+      printUsage(argv[0]);
+      return false;
+    } // switch
+  }   // while
+
+  if (options.minSize == 0) {
+    std::cerr << "--min-size must be at least 1" << std::endl;
+    return false;
+  } // if
+  return true;
+} // getOptions()
+
+} // namespace
+
+int main(int argc, char *argv[]) {
+  std::ios_base::sync_with_stdio(false);
+  Options options;
+  if (!getOptions(argc, argv, options)) {
+    return 1;
+  } // if
+
+  std::cout << options.ops << " steps\n"
+            << std::left << std::setw(6) << "model" << std::right
+            << std::setw(10) << "size" << std::setw(8) << "batch"
+            << std::setw(10) << "merges" << std::setw(12) << "binary ns"
+            << std::setw(12) << "pairing ns" << std::setw(8) << "ratio"
+            << '\n';
+
+  Workload work;
+  std::mt19937_64 gen{options.seed};
+  std::exponential_distribution<double> expo{1.0};
+  work.increments.resize(std::size_t{1} << 16); // NOLINT: a power of two
+  for (auto &inc : work.increments) {
+    inc = expo(gen);
+  } // for ..inc
+
+  for (const auto &model : options.models) {
+    if (model != "hold" && model != "grow") {
+      std::cerr << "Unknown model " << model << std::endl;
+      return 1;
+    } // if
+    const bool hold = model == "hold";
+    for (std::size_t n : powersOfTen(options.minSize, options.maxSize)) {
+      for (std::size_t batch : options.batches) {
+        for (double fraction : options.fractions) {
+          // A step merges with probability p.  The merge fraction is
+          // p / (p (batch + 1) + 2 (1 - p)) for hold, and p / (p + 2 (1 -
+          // p)) for grow; solved for p:
+          auto popped = hold ? static_cast<double>(batch) : 0.0;
+          double rest = 1 - fraction * (popped - 1);
+          if (rest <= 0 || 2 * fraction > rest) {
+            continue; // p would exceed 1
+          } // if
+          double probability = 2 * fraction / rest;
+          std::bernoulli_distribution coin{probability};
+          work.merges.resize(options.ops);
+          for (auto &merge : work.merges) {
+            merge = coin(gen) ? 1 : 0;
+          } // for ..merge
+
+          OpCounts counts;
+          double binary = run<Binary>(work, n, batch, hold, counts);
+          double pairing = run<Pairing>(work, n, batch, hold, counts);
+          auto ops = static_cast<double>(counts.merges + counts.others);
+          std::cout << std::left << std::setw(6) << model << std::right
+                    << std::setw(10) << n << std::setw(8) << batch
+                    << std::fixed << std::setprecision(3) << std::setw(10)
+                    << static_cast<double>(counts.merges) / ops
+                    << std::setprecision(1) << std::setw(12)
+                    << binary * 1e9 / ops // NOLINT: ns per second
+                    << std::setw(12) << pairing * 1e9 / ops // NOLINT
+                    << std::setprecision(2) << std::setw(8)
+                    << binary / pairing << std::endl;
+        } // for ..fraction
+      }   // for ..batch
+    }     // for ..n
+  }       // for ..model
+
+  return 0;
+} // main()
@@ -0,0 +1,259 @@
+// Project identifier: 43DE0E0C4C76BFAA6D8C2F5AEAE0518A9C42CF4E
+
+/*
+ * k-way merge of sorted runs: the loser tree against PQs as merge heaps.
+ *
+ * A fixed number of random ints is split into k sorted runs of (nearly)
+ * equal length, and the runs are merged into one output vector, for k in
+ * the powers of two from --min-k to --max-k.  'losertree' is kWayMerge()
+ * (LoserTree.hpp); any other name is a PQ from visitPQ() holding a
+ * (value, run) entry per run, which is replaced with the run's next
+ * element by replaceTop(), or popped when the run is exhausted.
+ *
+ * For every (k, pq) it reports nanoseconds per element merged, measured
+ * with a plain comparator, and comparisons per element, counted in a
+ * second run with a counting comparator.  Every output is checked to be
+ * sorted and complete.
+ *
+ * Usage: ./benchMerge [--pq losertree,binary,pairing] [--min-k 2]
+ *                     [--max-k 65536] [--elements 4194304] [--seed 281]
+ */
+
+#include <getopt.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "Benchmark.hpp"
+#include "LoserTree.hpp"
+
+namespace {
+
+// Settings from the command line.
+struct Options {
+  std::vector<std::string> pqs{"losertree", "binary", "pairing"};
+  std::size_t minK = 2;                  // NOLINT: smallest merge
+  std::size_t maxK = 65536;              // NOLINT: 2^16 runs
+  std::size_t elements = std::size_t{1} << 22; // NOLINT: 4M ints
+  std::uint32_t seed = 281;              // NOLINT: default seed
+};                                       // Options
+
+// Results of one (k, pq) combination.
+struct RunResult {
+  double nanosPerElement = 0;
+  double comparesPerElement = 0;
+}; // RunResult
+
+using Runs = std::vector<std::vector<int>>;
+
+// The head of a run in a merge heap.
+struct Entry {
+  int value;
+  std::uint32_t run;
+}; // Entry
+
+// Orders entries by value, smallest on top, through a comparator of ints.
+template <typename COMP_FUNCTOR> struct EntryComp {
+  COMP_FUNCTOR comp;
+
+  bool operator()(const Entry &a, const Entry &b) const {
+    return comp(b.value, a.value);
+  } // operator()()
+};  // EntryComp
+
+// Wraps a comparator and counts its calls.
+template <typename COMP_FUNCTOR> struct CountingComp {
+  COMP_FUNCTOR comp;
+  std::uint64_t *count = nullptr;
+
+  template <typename LHS, typename RHS>
+  bool operator()(const LHS &a, const RHS &b) const {
+    ++*count;
+    return comp(a, b);
+  } // operator()()
+};  // CountingComp
+
+// Description: Merge 'runs' into 'out' with 'pq' as the merge heap.
+template <typename PQ> void heapMerge(PQ &pq, const Runs &runs, int *out) {
+  std::vector<std::size_t> next(runs.size(), 1);
+  for (std::size_t i = 0; i < runs.size(); ++i) {
+    if (!runs[i].empty()) {
+      pq.push(Entry{runs[i].front(), static_cast<std::uint32_t>(i)});
+    } // if
+  }   // for ..i
+  while (!pq.empty()) {
+    const Entry &head = pq.top();
+    *out++ = head.value;
+    const auto &run = runs[head.run];
+    std::size_t &pos = next[head.run];
+    if (pos < run.size()) {
+      pq.replaceTop(Entry{run[pos++], head.run});
+    } else {
+      pq.pop();
+    } // if
+  }   // while
+} // heapMerge()
+
+// Description: Merge 'runs' into 'out' with the strategy called 'name',
+//              comparing ints with 'comp'.  Returns false for an unknown
+//              name.
+template <typename COMP_FUNCTOR>
+bool merge(const std::string &name, const Runs &runs, int *out,
+           COMP_FUNCTOR comp) {
+  if (name == "losertree") {
+    kWayMerge(runs, out, comp);
+    return true;
+  } // if
+  return visitPQ<Entry, EntryComp<COMP_FUNCTOR>>(
+      name, [&](auto &pq) { heapMerge(pq, runs, out); },
+      EntryComp<COMP_FUNCTOR>{comp});
+} // merge()
+
+// Description: Time and count one strategy on 'runs', and check its
+//              output against 'expected'.  Returns false for an unknown
+//              name or a wrong merge.
+bool runMerge(const std::string &name, const Runs &runs,
+              const std::vector<int> &expected, RunResult &result) {
+  std::vector<int> out(expected.size());
+  auto start = BenchClock::now();
+  if (!merge(name, runs, out.data(), std::less<int>{})) {
+    return false;
+  } // if
+  double seconds = secondsBetween(start, BenchClock::now());
+  auto elements = static_cast<double>(expected.size());
+  result.nanosPerElement = seconds * 1e9 / elements; // NOLINT: ns per s
+  if (out != expected) {
+    return false;
+  } // if
+
+  std::uint64_t count = 0;
+  merge(name, runs, out.data(),
+        CountingComp<std::less<int>>{std::less<int>{}, &count});
+  result.comparesPerElement = static_cast<double>(count) / elements;
+  return out == expected;
+} // runMerge()
+
+// Description: Split 'elements' random ints into 'k' sorted runs whose
+//              lengths differ by at most one; 'expected' receives all of
+//              them sorted.
+Runs makeRuns(std::size_t k, std::size_t elements, std::uint32_t seed,
+              std::vector<int> &expected) {
+  std::mt19937_64 gen{seed};
+  std::uniform_int_distribution<int> dist;
+  Runs runs(k);
+  expected.clear();
+  for (std::size_t i = 0; i < k; ++i) {
+    auto &run = runs[i];
+    run.resize(elements / k + (i < elements % k ? 1 : 0));
+    std::generate(run.begin(), run.end(), [&] { return dist(gen); });
+    std::sort(run.begin(), run.end());
+    expected.insert(expected.end(), run.begin(), run.end());
+  } // for ..i
+  std::sort(expected.begin(), expected.end());
+  return runs;
+} // makeRuns()
+
+void printUsage(const char *prog) {
+  std::cout << "Usage: " << prog << " [--pq LIST] [--min-k K] [--max-k K]"
+            << " [--elements N] [--seed S]\n"
+            << "  PQs: losertree";
+  for (const auto &name : pqNames()) {
+    std::cout << ' ' << name;
+  } // for ..name
+  std::cout << std::endl;
+} // printUsage()
+
+bool getOptions(int argc, char *argv[], Options &options) {
+  // NOLINTNEXTLINE: getopt_long requires a C array
+  static struct option longOpts[] = {
+      {"pq", required_argument, nullptr, 'p'},
+      {"min-k", required_argument, nullptr, 'k'},
+      {"max-k", required_argument, nullptr, 'K'},
+      {"elements", required_argument, nullptr, 'n'},
+      {"seed", required_argument, nullptr, 's'},
+      {"help", no_argument, nullptr, 'h'},
+      {nullptr, 0, nullptr, '\0'},
+  };
+
+  int choice = 0;
+  while ((choice = getopt_long(argc, argv, "p:k:K:n:s:h", longOpts,
+                               nullptr)) != -1) {
+    switch (choice) {
+    case 'p':
+      options.pqs = splitList(optarg);
+      break;
+    case 'k':
+      options.minK = std::strtoull(optarg, nullptr, 10); // NOLINT: base
+      break;
+    case 'K':
+      options.maxK = std::strtoull(optarg, nullptr, 10); // NOLINT: base
+      break;
+    case 'n':
+      options.elements = std::strtoull(optarg, nullptr, 10); // NOLINT: base
+      break;
+    case 's':
+      options.seed = static_cast<std::uint32_t>(
+          std::strtoul(optarg, nullptr, 10)); // NOLINT: base
+      break;
+    case 'h':
+    default:
+      printUsage(argv[0]);
+      return false;
+    } // switch
+  }   // while
+
+  if (options.minK == 0 || options.elements == 0) {
+    std::cerr << "--min-k and --elements must be at least 1" << std::endl;
+    return false;
+  } // if
+  return true;
+} // getOptions()
+
+} // namespace
+
+int main(int argc, char *argv[]) {
+  std::ios_base::sync_with_stdio(false);
+  Options options;
+  if (!getOptions(argc, argv, options)) {
+    return 1;
+  } // if
+
+  std::cout << options.elements << " elements\n"
+            << std::right << std::setw(8) << "k" << "  " << std::left
+            << std::setw(16) << "pq" << std::right << std::setw(10)
+            << "ns/elt" << std::setw(10) << "cmp/elt" << '\n';
+
+  std::vector<int> expected;
+  for (std::size_t k = options.minK; k <= options.maxK; k *= 2) {
+    Runs runs = makeRuns(k, options.elements, options.seed, expected);
+    for (const auto &name : options.pqs) {
+      std::cout << std::right << std::setw(8) << k << "  " << std::left
+                << std::setw(16) << name << std::right;
+      // NOLINTNEXTLINE: O(n) operations on this many runs take minutes
+      if (isLinearPQ(name) && k > 1024) {
+        std::cout << "  skipped (O(n) operations)" << std::endl;
+        continue;
+      } // if
+
+      RunResult result;
+      if (!runMerge(name, runs, expected, result)) {
+        std::cout << std::endl;
+        std::cerr << "Unknown PQ " << name << " or a wrong merge"
+                  << std::endl;
+        return 1;
+      } // if
+      std::cout << std::fixed << std::setprecision(1) << std::setw(10)
+                << result.nanosPerElement << std::setprecision(2)
+                << std::setw(10) << result.comparesPerElement << std::endl;
+    } // for ..name
+  }   // for ..k
+
+  return 0;
+} // main()
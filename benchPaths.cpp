@@ -0,0 +1,534 @@
+// Project identifier: 43DE0E0C4C76BFAA6D8C2F5AEAE0518A9C42CF4E
+
+/*
+ * Shortest-path workload comparing decrease-key against lazy deletion.
+ *
+ * Runs point-to-point Dijkstra and A* on generated graphs:
+ *
+ *   grid    a side x side 4-connected grid with random edge weights
+ *   random  a road-network-like graph: points scattered in the plane,
+ *           each linked (both ways) to its 'degree' nearest neighbours
+ *
+ * Edge weights are never shorter than the straight-line distance, so the
+ * Euclidean distance to the target is a consistent A* heuristic.
+ *
+ * Strategies:
+ *   pairing       PairingPQ with one node per vertex; a shorter distance
+ *                 is applied in place with updateElt() (decrease-key)
+ *   pairing-lazy  PairingPQ with lazy deletion
+ *   compact       CompactPairingPQ with decrease-key, like pairing
+ *   binary        BinaryPQ with lazy deletion: every improvement is a new
+ *                 push, and pops of already settled vertices are skipped
+ *   sorted        SortedPQ with lazy deletion
+ *
+ * For each (graph, algorithm, strategy) it reports the time per query,
+ * PQ operation counts, the peak PQ size and the peak bytes allocated by
+ * the PQ (measured through a counting pmr resource).  The checksum of the
+ * distances found must be the same for every strategy.
+ *
+ * Usage: ./benchPaths [--graph grid,random] [--algo dijkstra,astar]
+ *                     [--strategy pairing,pairing-lazy,compact,binary,
+ *                                 sorted]
+ *                     [--nodes 1000000] [--degree 4] [--queries 20]
+ *                     [--seed 281]
+ */
+
+#include <getopt.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+#include <memory_resource>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "Benchmark.hpp"
+#include "BinaryPQ.hpp"
+#include "CompactPairingPQ.hpp"
+#include "PairingPQ.hpp"
+#include "SortedPQ.hpp"
+
+namespace {
+
+const double kInfinity = std::numeric_limits<double>::infinity();
+
+// Settings from the command line.
+struct Options {
+  std::vector<std::string> graphs{"grid", "random"};
+  std::vector<std::string> algos{"dijkstra", "astar"};
+  std::vector<std::string> strategies{"pairing", "pairing-lazy", "compact",
+                                      "binary", "sorted"};
+  std::size_t nodes = 1000000; // NOLINT: default graph size
+  std::size_t degree = 4;      // NOLINT: default nearest neighbours
+  std::size_t queries = 20;    // NOLINT: default number of queries
+  std::uint32_t seed = 281;    // NOLINT: default seed
+};                             // Options
+
+// A directed graph in compressed sparse row form, with coordinates for
+// the A* heuristic.
+struct Graph {
+  std::vector<std::size_t> offsets; // edges of v: [offsets[v], offsets[v+1])
+  std::vector<std::uint32_t> targets;
+  std::vector<double> weights;
+  std::vector<double> xs;
+  std::vector<double> ys;
+
+  std::size_t vertexCount() const { return xs.size(); }
+  std::size_t edgeCount() const { return targets.size(); }
+}; // Graph
+
+// Description: Build the CSR arrays from an edge list.
+void buildCsr(Graph &graph,
+              std::vector<std::pair<std::uint32_t, std::uint32_t>> &edges,
+              std::mt19937_64 &gen) {
+  std::uniform_real_distribution<double> stretch{1.0, 2.0};
+  std::sort(edges.begin(), edges.end());
+  edges.erase(std::unique(edges.begin(), edges.end()), edges.end());
+
+  graph.offsets.assign(graph.vertexCount() + 1, 0);
+  for (const auto &edge : edges) {
+    ++graph.offsets[edge.first + 1];
+  } // for ..edge
+  for (std::size_t v = 0; v < graph.vertexCount(); ++v) {
+    graph.offsets[v + 1] += graph.offsets[v];
+  } // for ..v
+
+  graph.targets.reserve(edges.size());
+  graph.weights.reserve(edges.size());
+  for (const auto &[from, to] : edges) {
+    double length = std::hypot(graph.xs[from] - graph.xs[to],
+                               graph.ys[from] - graph.ys[to]);
+    graph.targets.push_back(to);
+    graph.weights.push_back(length * stretch(gen));
+  } // for ..edge
+} // buildCsr()
+
+// Description: A side x side grid with 4-neighbour edges in both
+//              directions.
+Graph makeGrid(std::size_t nodes, std::mt19937_64 &gen) {
+  auto side = static_cast<std::uint32_t>(std::sqrt(static_cast<double>(nodes)));
+  Graph graph;
+  std::vector<std::pair<std::uint32_t, std::uint32_t>> edges;
+  for (std::uint32_t y = 0; y < side; ++y) {
+    for (std::uint32_t x = 0; x < side; ++x) {
+      std::uint32_t v = y * side + x;
+      graph.xs.push_back(x);
+      graph.ys.push_back(y);
+      if (x + 1 < side) {
+        edges.emplace_back(v, v + 1);
+        edges.emplace_back(v + 1, v);
+      } // if
+      if (y + 1 < side) {
+        edges.emplace_back(v, v + side);
+        edges.emplace_back(v + side, v);
+      } // if
+    }   // for ..x
+  }     // for ..y
+  buildCsr(graph, edges, gen);
+  return graph;
+} // makeGrid()
+
+// Description: Points scattered uniformly with unit density, each linked
+//              in both directions to its 'degree' nearest neighbours
+//              (searched in the surrounding unit cells).
+Graph makeRandom(std::size_t nodes, std::size_t degree,
+                 std::mt19937_64 &gen) {
+  auto side = static_cast<std::uint32_t>(
+      std::ceil(std::sqrt(static_cast<double>(nodes))));
+  std::uniform_real_distribution<double> coord{0.0, static_cast<double>(side)};
+  Graph graph;
+  graph.xs.resize(nodes);
+  graph.ys.resize(nodes);
+  std::vector<std::vector<std::uint32_t>> cells(std::size_t{side} * side);
+  auto cellOf = [side](double c) {
+    return std::min(static_cast<std::uint32_t>(c), side - 1);
+  };
+  for (std::uint32_t v = 0; v < nodes; ++v) {
+    graph.xs[v] = coord(gen);
+    graph.ys[v] = coord(gen);
+    cells[std::size_t{cellOf(graph.ys[v])} * side + cellOf(graph.xs[v])]
+        .push_back(v);
+  } // for ..v
+
+  std::vector<std::pair<std::uint32_t, std::uint32_t>> edges;
+  std::vector<std::pair<double, std::uint32_t>> near;
+  for (std::uint32_t v = 0; v < nodes; ++v) {
+    near.clear();
+    std::uint32_t cx = cellOf(graph.xs[v]);
+    std::uint32_t cy = cellOf(graph.ys[v]);
+    for (std::uint32_t y = cy == 0 ? 0 : cy - 1; y <= cy + 1 && y < side;
+         ++y) {
+      for (std::uint32_t x = cx == 0 ? 0 : cx - 1; x <= cx + 1 && x < side;
+           ++x) {
+        for (std::uint32_t u : cells[std::size_t{y} * side + x]) {
+          if (u != v) {
+            near.emplace_back(std::hypot(graph.xs[u] - graph.xs[v],
+                                         graph.ys[u] - graph.ys[v]),
+                              u);
+          } // if
+        }   // for ..u
+      }     // for ..x
+    }       // for ..y
+    std::size_t keep = std::min(degree, near.size());
+    std::partial_sort(near.begin(),
+                      near.begin() + static_cast<std::ptrdiff_t>(keep),
+                      near.end());
+    for (std::size_t i = 0; i < keep; ++i) {
+      edges.emplace_back(v, near[i].second);
+      edges.emplace_back(near[i].second, v);
+    } // for ..i
+  }   // for ..v
+  buildCsr(graph, edges, gen);
+  return graph;
+} // makeRandom()
+
+// A search label: priority key (distance, plus the heuristic for A*) and
+// the vertex it belongs to.
+struct Label {
+  double key;
+  std::uint32_t vertex;
+}; // Label
+
+// Orders labels so that the smallest key is the most extreme.
+struct LabelComp {
+  bool operator()(const Label &a, const Label &b) const {
+    return a.key > b.key;
+  } // operator()()
+};  // LabelComp
+
+// PQ operation counts and memory for a set of queries.
+struct SearchStats {
+  std::size_t pushes = 0;
+  std::size_t pops = 0;
+  std::size_t stalePops = 0;
+  std::size_t decreaseKeys = 0;
+  std::size_t peakSize = 0;
+  std::size_t peakBytes = 0;
+  std::size_t settled = 0;
+  double checksum = 0;
+}; // SearchStats
+
+// Per-query working state, sized once for the graph and reset between
+// queries outside the timed region.
+struct SearchState {
+  std::vector<double> dist;
+  std::vector<bool> settled;
+
+  explicit SearchState(std::size_t n) : dist(n, kInfinity), settled(n) {}
+
+  void reset() {
+    std::fill(dist.begin(), dist.end(), kInfinity);
+    settled.assign(settled.size(), false);
+  } // reset()
+};  // SearchState
+
+// Description: Heuristic for the search: straight-line distance to the
+//              target for A*, zero for Dijkstra.
+double heuristic(const Graph &graph, bool astar, std::uint32_t v,
+                 std::uint32_t target) {
+  if (!astar) {
+    return 0;
+  } // if
+  return std::hypot(graph.xs[v] - graph.xs[target],
+                    graph.ys[v] - graph.ys[target]);
+} // heuristic()
+
+// Description: Point-to-point search with lazy deletion: improvements are
+//              pushed as new labels and stale labels are skipped when they
+//              reach the top.  Returns the distance to 'target'.
+template <typename PQ>
+double searchLazy(const Graph &graph, bool astar, std::uint32_t source,
+                  std::uint32_t target, SearchState &state, PQ &pq,
+                  SearchStats &stats) {
+  state.dist[source] = 0;
+  pq.push({heuristic(graph, astar, source, target), source});
+  ++stats.pushes;
+  while (!pq.empty()) {
+    std::uint32_t v = pq.top().vertex;
+    pq.pop();
+    ++stats.pops;
+    if (state.settled[v]) {
+      ++stats.stalePops;
+      continue;
+    } // if
+    state.settled[v] = true;
+    ++stats.settled;
+    if (v == target) {
+      break;
+    } // if
+    for (std::size_t e = graph.offsets[v]; e < graph.offsets[v + 1]; ++e) {
+      std::uint32_t u = graph.targets[e];
+      double candidate = state.dist[v] + graph.weights[e];
+      if (candidate < state.dist[u]) {
+        state.dist[u] = candidate;
+        pq.push({candidate + heuristic(graph, astar, u, target), u});
+        ++stats.pushes;
+        stats.peakSize = std::max(stats.peakSize, pq.size());
+      } // if
+    }   // for ..e
+  }     // while
+
+  // Empty the PQ outside the search proper; the next query starts fresh.
+  while (!pq.empty()) {
+    pq.pop();
+  } // while
+  return state.dist[target];
+} // searchLazy()
+
+// Description: Point-to-point search with decrease-key: each vertex has at
+//              most one node in the pairing heap, and improvements are
+//              applied to it with updateElt().  A value-initialized HANDLE
+//              marks a vertex that is not in the heap.  Returns the
+//              distance to 'target'.
+template <typename PQ, typename HANDLE>
+double searchDecreaseKey(const Graph &graph, bool astar,
+                         std::uint32_t source, std::uint32_t target,
+                         SearchState &state, PQ &pq,
+                         std::vector<HANDLE> &handles, SearchStats &stats) {
+  state.dist[source] = 0;
+  handles[source] = pq.addNode({heuristic(graph, astar, source, target),
+                                source});
+  ++stats.pushes;
+  while (!pq.empty()) {
+    std::uint32_t v = pq.top().vertex;
+    pq.pop();
+    ++stats.pops;
+    handles[v] = HANDLE{};
+    state.settled[v] = true;
+    ++stats.settled;
+    if (v == target) {
+      break;
+    } // if
+    for (std::size_t e = graph.offsets[v]; e < graph.offsets[v + 1]; ++e) {
+      std::uint32_t u = graph.targets[e];
+      double candidate = state.dist[v] + graph.weights[e];
+      if (candidate < state.dist[u]) {
+        state.dist[u] = candidate;
+        Label label{candidate + heuristic(graph, astar, u, target), u};
+        if (handles[u] == HANDLE{}) {
+          handles[u] = pq.addNode(label);
+          ++stats.pushes;
+          stats.peakSize = std::max(stats.peakSize, pq.size());
+        } else {
+          pq.updateElt(handles[u], label);
+          ++stats.decreaseKeys;
+        } // if
+      }   // if
+    }     // for ..e
+  }       // while
+
+  while (!pq.empty()) {
+    handles[pq.top().vertex] = HANDLE{};
+    pq.pop();
+  } // while
+  return state.dist[target];
+} // searchDecreaseKey()
+
+// Description: Run every query with one strategy, returning the total
+//              search time in seconds and filling in 'stats'.
+double runQueries(
+    const Graph &graph, bool astar, const std::string &strategy,
+    const std::vector<std::pair<std::uint32_t, std::uint32_t>> &queries,
+    SearchStats &stats) {
+  SearchState state{graph.vertexCount()};
+  CountingResource counter;
+  std::pmr::polymorphic_allocator<Label> alloc{&counter};
+  double seconds = 0;
+
+  auto record = [&](double dist) {
+    if (dist != kInfinity) {
+      stats.checksum += dist;
+    } // if
+    stats.peakBytes = std::max(stats.peakBytes, counter.peak());
+  };
+
+  auto decreaseKey = [&](auto &pq, auto &handles) {
+    handles.resize(graph.vertexCount());
+    for (const auto &[source, target] : queries) {
+      state.reset();
+      counter.resetPeak();
+      auto start = BenchClock::now();
+      double dist = searchDecreaseKey(graph, astar, source, target, state,
+                                      pq, handles, stats);
+      seconds += secondsBetween(start, BenchClock::now());
+      record(dist);
+    } // for ..query
+  };
+  if (strategy == "pairing") {
+    pmr::PairingPQ<Label, LabelComp> pq{LabelComp{}, alloc};
+    std::vector<pmr::PairingPQ<Label, LabelComp>::Node *> handles;
+    decreaseKey(pq, handles);
+    return seconds;
+  } // if
+  if (strategy == "compact") {
+    pmr::CompactPairingPQ<Label, LabelComp> pq{LabelComp{}, alloc};
+    std::vector<pmr::CompactPairingPQ<Label, LabelComp>::Handle> handles;
+    decreaseKey(pq, handles);
+    return seconds;
+  } // if
+
+  auto lazy = [&](auto &pq) {
+    for (const auto &[source, target] : queries) {
+      state.reset();
+      counter.resetPeak();
+      auto start = BenchClock::now();
+      double dist =
+          searchLazy(graph, astar, source, target, state, pq, stats);
+      seconds += secondsBetween(start, BenchClock::now());
+      record(dist);
+    } // for ..query
+  };
+  if (strategy == "pairing-lazy") {
+    pmr::PairingPQ<Label, LabelComp> pq{LabelComp{}, alloc};
+    lazy(pq);
+  } else if (strategy == "binary") {
+    pmr::BinaryPQ<Label, LabelComp> pq{LabelComp{}, alloc};
+    lazy(pq);
+  } else if (strategy == "sorted") {
+    pmr::SortedPQ<Label, LabelComp> pq{LabelComp{}, alloc};
+    lazy(pq);
+  } else {
+    return -1;
+  } // if
+  return seconds;
+} // runQueries()
+
+void printUsage(const char *prog) {
+  std::cout << "Usage: " << prog
+            << " [--graph grid,random] [--algo dijkstra,astar]\n"
+            << "       [--strategy pairing,pairing-lazy,compact,binary,"
+            << "sorted]\n"
+            << "       [--nodes N] [--degree D] [--queries Q] [--seed S]"
+            << std::endl;
+} // printUsage()
+
+bool getOptions(int argc, char *argv[], Options &options) {
+  // NOLINTNEXTLINE: getopt_long requires a C array
+  static struct option longOpts[] = {
+      {"graph", required_argument, nullptr, 'g'},
+      {"algo", required_argument, nullptr, 'a'},
+      {"strategy", required_argument, nullptr, 'S'},
+      {"nodes", required_argument, nullptr, 'n'},
+      {"degree", required_argument, nullptr, 'd'},
+      {"queries", required_argument, nullptr, 'q'},
+      {"seed", required_argument, nullptr, 's'},
+      {"help", no_argument, nullptr, 'h'},
+      {nullptr, 0, nullptr, '\0'},
+  };
+
+  int choice = 0;
+  while ((choice = getopt_long(argc, argv, "g:a:S:n:d:q:s:h", longOpts,
+                               nullptr)) != -1) {
+    switch (choice) {
+    case 'g':
+      options.graphs = splitList(optarg);
+      break;
+    case 'a':
+      options.algos = splitList(optarg);
+      break;
+    case 'S':
+      options.strategies = splitList(optarg);
+      break;
+    case 'n':
+      options.nodes = std::strtoull(optarg, nullptr, 10); // NOLINT: base
+      break;
+    case 'd':
+      options.degree = std::strtoull(optarg, nullptr, 10); // NOLINT: base
+      break;
+    case 'q':
+      options.queries = std::strtoull(optarg, nullptr, 10); // NOLINT: base
+      break;
+    case 's':
+      options.seed = static_cast<std::uint32_t>(
+          std::strtoul(optarg, nullptr, 10)); // NOLINT: base
+      break;
+    case 'h':
+    default:
+      printUsage(argv[0]);
+      return false;
+    } // switch
+  }   // while
+
+  // Vertex ids are stored in 32 bits.
+  if (options.nodes < 4 ||
+      options.nodes > std::numeric_limits<std::uint32_t>::max()) {
+    std::cerr << "--nodes must be between 4 and 2^32 - 1" << std::endl;
+    return false;
+  } // if
+  return true;
+} // getOptions()
+
+} // namespace
+
+int main(int argc, char *argv[]) {
+  std::ios_base::sync_with_stdio(false);
+  Options options;
+  if (!getOptions(argc, argv, options)) {
+    return 1;
+  } // if
+
+  for (const auto &graphName : options.graphs) {
+    std::mt19937_64 gen{options.seed};
+    Graph graph;
+    if (graphName == "grid") {
+      graph = makeGrid(options.nodes, gen);
+    } else if (graphName == "random") {
+      graph = makeRandom(options.nodes, options.degree, gen);
+    } else {
+      std::cerr << "Unknown graph " << graphName << std::endl;
+      return 1;
+    } // if
+
+    std::uniform_int_distribution<std::uint32_t> pick{
+        0, static_cast<std::uint32_t>(graph.vertexCount() - 1)};
+    std::vector<std::pair<std::uint32_t, std::uint32_t>> queries;
+    for (std::size_t i = 0; i < options.queries; ++i) {
+      queries.emplace_back(pick(gen), pick(gen));
+    } // for ..i
+
+    std::cout << graphName << " graph: " << graph.vertexCount()
+              << " vertices, " << graph.edgeCount() << " edges, "
+              << queries.size() << " queries\n"
+              << std::left << std::setw(10) << "algo" << std::setw(14)
+              << "strategy" << std::right << std::setw(10) << "ms/query"
+              << std::setw(12) << "pushes" << std::setw(12) << "pops"
+              << std::setw(12) << "stale" << std::setw(12) << "decr-key"
+              << std::setw(10) << "peak n" << std::setw(12) << "peak KiB"
+              << std::setw(18) << "checksum" << '\n';
+
+    for (const auto &algo : options.algos) {
+      if (algo != "dijkstra" && algo != "astar") {
+        std::cerr << "Unknown algorithm " << algo << std::endl;
+        return 1;
+      } // if
+      for (const auto &strategy : options.strategies) {
+        SearchStats stats;
+        double seconds =
+            runQueries(graph, algo == "astar", strategy, queries, stats);
+        if (seconds < 0) {
+          std::cerr << "Unknown strategy " << strategy << std::endl;
+          return 1;
+        } // if
+        std::cout << std::left << std::setw(10) << algo << std::setw(14)
+                  << strategy << std::right << std::fixed
+                  << std::setprecision(3) << std::setw(10)
+                  << 1000 * seconds / static_cast<double>(queries.size())
+                  << std::setw(12) << stats.pushes << std::setw(12)
+                  << stats.pops << std::setw(12) << stats.stalePops
+                  << std::setw(12) << stats.decreaseKeys << std::setw(10)
+                  << stats.peakSize << std::setw(12)
+                  << stats.peakBytes / 1024 << std::setw(18)
+                  << stats.checksum << std::endl;
+      } // for ..strategy
+    }   // for ..algo
+  }     // for ..graphName
+
+  return 0;
+} // main()
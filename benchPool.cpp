@@ -0,0 +1,349 @@
+// Project identifier: 43DE0E0C4C76BFAA6D8C2F5AEAE0518A9C42CF4E
+
+/*
+ * Throughput and priority order of PriorityThreadPool.
+ *
+ * 'global' is the classic pool the work-stealing one replaces: a single
+ * BinaryPQ behind one mutex and condition variable.  Any other name is a
+ * PriorityThreadPool whose workers' queues are that PQ from visitPQ().
+ *
+ * For every (pq, threads), with threads the powers of two from
+ * --min-threads to --max-threads, two runs are made:
+ *
+ *   throughput  --tasks jobs with random priorities are posted from the
+ *               main thread while the workers run them; each job spins
+ *               for --work iterations.  Reported in jobs per second.
+ *   inversion   every worker is first held up by a gate job, then
+ *               --tasks jobs are posted and the gates opened.  Each job
+ *               logs its priority when it starts; the result is the share
+ *               of pairs of jobs that started in the wrong order, lower
+ *               priority first, in percent: 0 is perfect and 50 is random.
+ *
+ * Usage: ./benchPool [--pq global,binary,pairing] [--min-threads 1]
+ *                    [--max-threads 64] [--tasks 200000] [--work 200]
+ *                    [--seed 281]
+ */
+
+#include <getopt.h>
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdlib>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+#include "Benchmark.hpp"
+#include "PriorityThreadPool.hpp"
+
+namespace {
+
+// Settings from the command line.
+struct Options {
+  std::vector<std::string> pqs{"global", "binary", "pairing"};
+  std::size_t minThreads = 1;
+  std::size_t maxThreads = 64;   // NOLINT: a large machine
+  std::size_t tasks = 200000;    // NOLINT: 2e5
+  std::uint64_t work = 200;      // NOLINT: a short job
+  std::uint32_t seed = 281;      // NOLINT: default seed
+};                               // Options
+
+// Results of one (pq, threads) combination.
+struct RunResult {
+  double jobsPerSecond = 0;
+  double inversionPercent = 0;
+}; // RunResult
+
+// Priorities are 0 .. kPriorities - 1.
+constexpr int kPriorities = 1000;
+
+// Where spin() leaves its result, so that the loop is not optimized away.
+thread_local volatile std::uint64_t spinSink = 0;
+
+// Description: Busy work for a job: 'iterations' steps of an LCG.
+void spin(std::uint64_t iterations) {
+  std::uint64_t x = iterations;
+  for (std::uint64_t i = 0; i < iterations; ++i) {
+    x = x * 6364136223846793005ULL + 1442695040888963407ULL; // NOLINT: LCG
+  } // for ..i
+  spinSink = x;
+} // spin()
+
+// The pool being replaced: one BinaryPQ, one mutex, one condition variable.
+class GlobalPool {
+public:
+  explicit GlobalPool(std::size_t threads) {
+    for (std::size_t i = 0; i < threads; ++i) {
+      workers.emplace_back([this] { workerLoop(); });
+    } // for ..i
+  }   // GlobalPool()
+
+  GlobalPool(const GlobalPool &) = delete;
+  GlobalPool &operator=(const GlobalPool &) = delete;
+
+  ~GlobalPool() {
+    {
+      std::lock_guard<std::mutex> lock{mutex};
+      stopping = true;
+    }
+    ready.notify_all();
+    for (auto &worker : workers) {
+      worker.join();
+    } // for ..worker
+  }   // ~GlobalPool()
+
+  template <typename FUNC> void post(int priority, FUNC &&func) {
+    {
+      std::lock_guard<std::mutex> lock{mutex};
+      queue.push(PoolTask<int>{
+          priority, seq++,
+          new PoolJobFor<std::decay_t<FUNC>>(std::forward<FUNC>(func))});
+      ++unfinished;
+    }
+    ready.notify_one();
+  } // post()
+
+  void wait() {
+    std::unique_lock<std::mutex> lock{mutex};
+    done.wait(lock, [this] { return unfinished == 0; });
+  } // wait()
+
+private:
+  std::mutex mutex;
+  std::condition_variable ready;
+  std::condition_variable done;
+  BinaryPQ<PoolTask<int>, PoolTaskComp<int>> queue;
+  std::uint64_t seq = 0;
+  std::size_t unfinished = 0;
+  bool stopping = false;
+  std::vector<std::thread> workers;
+
+  void workerLoop() {
+    while (true) {
+      PoolTask<int> task{};
+      {
+        std::unique_lock<std::mutex> lock{mutex};
+        ready.wait(lock, [this] { return stopping || !queue.empty(); });
+        if (queue.empty()) {
+          return;
+        } // if
+        task = queue.top();
+        queue.pop();
+      }
+      std::unique_ptr<PoolJob>{task.job}->run();
+      std::lock_guard<std::mutex> lock{mutex};
+      if (--unfinished == 0) {
+        done.notify_all();
+      } // if
+    }   // while
+  }     // workerLoop()
+};      // GlobalPool
+
+// Description: Post every job of 'priorities' and wait for them.  Returns
+//              the elapsed seconds.
+template <typename POOL>
+double runThroughput(POOL &pool, const std::vector<int> &priorities,
+                     std::uint64_t work) {
+  auto start = BenchClock::now();
+  for (int priority : priorities) {
+    pool.post(priority, [work] { spin(work); });
+  } // for ..priority
+  pool.wait();
+  return secondsBetween(start, BenchClock::now());
+} // runThroughput()
+
+// Description: Hold up the 'threads' workers of 'pool', post a job per
+//              priority, let them run, and return the share of pairs of
+//              jobs that started lower priority first, in percent.
+template <typename POOL>
+double runInversion(POOL &pool, std::size_t threads,
+                    const std::vector<int> &priorities, std::uint64_t work) {
+  std::atomic<std::size_t> held{0};
+  std::atomic<bool> open{false};
+  for (std::size_t i = 0; i < threads; ++i) {
+    pool.post(kPriorities, [&held, &open] {
+      ++held;
+      while (!open.load()) {
+        std::this_thread::yield();
+      } // while
+    });
+  } // for ..i
+  while (held.load() < threads) {
+    std::this_thread::yield();
+  } // while
+
+  std::vector<int> log(priorities.size());
+  std::atomic<std::size_t> next{0};
+  for (int priority : priorities) {
+    pool.post(priority, [&log, &next, priority, work] {
+      log[next++] = priority;
+      spin(work);
+    });
+  } // for ..priority
+  open.store(true);
+  pool.wait();
+
+  // For each job, count the jobs that started earlier with a lower
+  // priority, with a Fenwick tree over the priorities.
+  std::vector<std::uint64_t> tree(kPriorities + 1);
+  std::uint64_t inverted = 0;
+  for (int priority : log) {
+    for (int i = priority; i > 0; i -= i & -i) {
+      inverted += tree[static_cast<std::size_t>(i)];
+    } // for ..i
+    for (int i = priority + 1; i <= kPriorities; i += i & -i) {
+      ++tree[static_cast<std::size_t>(i)];
+    } // for ..i
+  }   // for ..priority
+  auto n = static_cast<double>(log.size());
+  return 100.0 * static_cast<double>(inverted) / (n * (n - 1) / 2); // NOLINT
+} // runInversion()
+
+// Description: Construct the pool called 'name' with 'threads' workers
+//              and call 'func' with it.  Returns false for an unknown name.
+template <typename FUNC>
+bool visitPool(const std::string &name, std::size_t threads, FUNC &&func) {
+  if (name == "global") {
+    GlobalPool pool{threads};
+    func(pool);
+    return true;
+  } // if
+  return visitPQ<PoolTask<int>, PoolTaskComp<int>>(name, [&](auto &pq) {
+    using Queue = std::decay_t<decltype(pq)>;
+    PriorityThreadPool<int, std::less<int>, Queue> pool{threads};
+    func(pool);
+  });
+} // visitPool()
+
+bool runPool(const Options &options, const std::string &name,
+             std::size_t threads, RunResult &result) {
+  std::mt19937_64 gen{options.seed};
+  std::uniform_int_distribution<int> dist{0, kPriorities - 1};
+  std::vector<int> priorities(options.tasks);
+  for (auto &priority : priorities) {
+    priority = dist(gen);
+  } // for ..priority
+
+  bool known = visitPool(name, threads, [&](auto &pool) {
+    double seconds = runThroughput(pool, priorities, options.work);
+    result.jobsPerSecond = static_cast<double>(options.tasks) / seconds;
+  });
+  if (!known) {
+    return false;
+  } // if
+  visitPool(name, threads, [&](auto &pool) {
+    result.inversionPercent =
+        runInversion(pool, threads, priorities, options.work);
+  });
+  return true;
+} // runPool()
+
+void printUsage(const char *prog) {
+  std::cout << "Usage: " << prog << " [--pq LIST] [--min-threads N]"
+            << " [--max-threads N]\n"
+            << "       [--tasks N] [--work N] [--seed S]\n"
+            << "  PQs: global";
+  for (const auto &name : pqNames()) {
+    std::cout << ' ' << name;
+  } // for ..name
+  std::cout << std::endl;
+} // printUsage()
+
+bool getOptions(int argc, char *argv[], Options &options) {
+  // NOLINTNEXTLINE: getopt_long requires a C array
+  static struct option longOpts[] = {
+      {"pq", required_argument, nullptr, 'p'},
+      {"min-threads", required_argument, nullptr, 't'},
+      {"max-threads", required_argument, nullptr, 'T'},
+      {"tasks", required_argument, nullptr, 'n'},
+      {"work", required_argument, nullptr, 'w'},
+      {"seed", required_argument, nullptr, 's'},
+      {"help", no_argument, nullptr, 'h'},
+      {nullptr, 0, nullptr, '\0'},
+  };
+
+  int choice = 0;
+  while ((choice = getopt_long(argc, argv, "p:t:T:n:w:s:h", longOpts,
+                               nullptr)) != -1) {
+    switch (choice) {
+    case 'p':
+      options.pqs = splitList(optarg);
+      break;
+    case 't':
+      options.minThreads = std::strtoull(optarg, nullptr, 10); // NOLINT
+      break;
+    case 'T':
+      options.maxThreads = std::strtoull(optarg, nullptr, 10); // NOLINT
+      break;
+    case 'n':
+      options.tasks = std::strtoull(optarg, nullptr, 10); // NOLINT: base
+      break;
+    case 'w':
+      options.work = std::strtoull(optarg, nullptr, 10); // NOLINT: base
+      break;
+    case 's':
+      options.seed = static_cast<std::uint32_t>(
+          std::strtoul(optarg, nullptr, 10)); // NOLINT: base
+      break;
+    case 'h':
+    default:
+      printUsage(argv[0]);
+      return false;
+    } // switch
+  }   // while
+
+  if (options.minThreads == 0 || options.tasks < 2) {
+    std::cerr << "--min-threads must be at least 1 and --tasks at least 2"
+              << std::endl;
+    return false;
+  } // if
+  return true;
+} // getOptions()
+
+} // namespace
+
+int main(int argc, char *argv[]) {
+  std::ios_base::sync_with_stdio(false);
+  Options options;
+  if (!getOptions(argc, argv, options)) {
+    return 1;
+  } // if
+
+  std::cout << options.tasks << " jobs of " << options.work
+            << " iterations\n"
+            << std::left << std::setw(16) << "pq" << std::right
+            << std::setw(8) << "threads" << std::setw(14) << "jobs/s"
+            << std::setw(12) << "inverted %" << '\n';
+
+  for (std::size_t threads = options.minThreads;
+       threads <= options.maxThreads; threads *= 2) {
+    for (const auto &name : options.pqs) {
+      std::cout << std::left << std::setw(16) << name << std::right
+                << std::setw(8) << threads;
+      if (isLinearPQ(name)) {
+        std::cout << "  skipped (O(n) operations)" << std::endl;
+        continue;
+      } // if
+
+      RunResult result;
+      if (!runPool(options, name, threads, result)) {
+        std::cout << std::endl;
+        std::cerr << "Unknown PQ " << name << std::endl;
+        return 1;
+      } // if
+      std::cout << std::fixed << std::setprecision(0) << std::setw(14)
+                << result.jobsPerSecond << std::setprecision(2)
+                << std::setw(12) << result.inversionPercent << std::endl;
+    } // for ..name
+  }   // for ..threads
+
+  return 0;
+} // main()
@@ -0,0 +1,170 @@
+// Project identifier: 43DE0E0C4C76BFAA6D8C2F5AEAE0518A9C42CF4E
+
+/*
+ * Replays an operation trace against the priority queues.
+ *
+ * A trace is recorded by wrapping the PQ of a real program in RecordingPQ
+ * (RecordingPQ.hpp), e.g. with benchDES --record FILE.  Every chosen
+ * implementation then performs exactly the recorded operations, so they
+ * can be compared on the program's real workload.  The results of top()
+ * and pushPop() are checked against the recording along the way; an
+ * implementation that returns something else is reported, and the exit
+ * status is nonzero.
+ *
+ * For every pq it reports the operations per second of each phase the
+ * trace marks, and the number of mismatches.  The element type and
+ * comparator are read from the trace; int32, int64, uint64 and double
+ * elements compared with std::less or std::greater are supported.
+ *
+ * Usage: ./benchReplay TRACE [--pq binary,pairing]
+ */
+
+#include <getopt.h>
+
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "Benchmark.hpp"
+#include "TraceReplay.hpp"
+
+namespace {
+
+// Settings from the command line.
+struct Options {
+  std::vector<std::string> pqs{"binary", "pairing"};
+  std::string trace;
+}; // Options
+
+// Description: Replay 'trace' against each PQ in 'options' and print the
+//              results.  Returns the total number of mismatches, or -1
+//              for an unknown name.
+template <typename TYPE, typename COMP_FUNCTOR>
+long long replayAll(const Options &options, const MappedTrace &trace) {
+  long long mismatches = 0;
+  for (const auto &name : options.pqs) {
+    ReplayResult result;
+    bool known = visitPQ<TYPE, COMP_FUNCTOR>(name, [&](auto &pq) {
+      result = replayTrace<TYPE, COMP_FUNCTOR>(trace, pq);
+    });
+    if (!known) {
+      std::cerr << "Unknown PQ " << name << std::endl;
+      return -1;
+    } // if
+
+    for (const auto &phase : result.phases) {
+      std::cout << std::left << std::setw(16) << name << std::setw(16)
+                << phase.name << std::right << std::setw(12) << phase.ops
+                << std::setw(14) << std::fixed << std::setprecision(0)
+                << (phase.seconds > 0
+                        ? static_cast<double>(phase.ops) / phase.seconds
+                        : 0.0)
+                << '\n';
+    } // for ..phase
+    if (result.mismatches != 0) {
+      std::cout << name << ": " << result.mismatches
+                << " mismatched results, the first at record "
+                << result.firstMismatch << '\n';
+    } // if
+    mismatches += static_cast<long long>(result.mismatches);
+  } // for ..name
+  std::cout << std::flush;
+  return mismatches;
+} // replayAll()
+
+// Description: Pick the element type and comparator the trace was
+//              recorded with.  Returns -1 if they are not supported.
+template <typename TYPE>
+long long replayComp(const Options &options, const MappedTrace &trace) {
+  switch (trace.info().comp) {
+  case TraceComp::Less:
+    return replayAll<TYPE, std::less<TYPE>>(options, trace);
+  case TraceComp::Greater:
+    return replayAll<TYPE, std::greater<TYPE>>(options, trace);
+  default:
+    std::cerr << "The trace's comparator is not supported" << std::endl;
+    return -1;
+  } // switch
+} // replayComp()
+
+long long replayType(const Options &options, const MappedTrace &trace) {
+  switch (trace.info().type) {
+  case TraceType::Int32:
+    return replayComp<std::int32_t>(options, trace);
+  case TraceType::Int64:
+    return replayComp<std::int64_t>(options, trace);
+  case TraceType::UInt64:
+    return replayComp<std::uint64_t>(options, trace);
+  case TraceType::Double:
+    return replayComp<double>(options, trace);
+  default:
+    std::cerr << "The trace's element type is not supported" << std::endl;
+    return -1;
+  } // switch
+} // replayType()
+
+void printUsage(const char *prog) {
+  std::cout << "Usage: " << prog << " TRACE [--pq LIST]\n"
+            << "  LIST is comma separated, or 'all'.\n  PQs:";
+  for (const auto &name : pqNames()) {
+    std::cout << ' ' << name;
+  } // for ..name
+  std::cout << std::endl;
+} // printUsage()
+
+bool getOptions(int argc, char *argv[], Options &options) {
+  // NOLINTNEXTLINE: getopt_long requires a C array
+  static struct option longOpts[] = {
+      {"pq", required_argument, nullptr, 'p'},
+      {"help", no_argument, nullptr, 'h'},
+      {nullptr, 0, nullptr, '\0'},
+  };
+
+  int choice = 0;
+  while ((choice = getopt_long(argc, argv, "p:h", longOpts, nullptr)) !=
+         -1) {
+    switch (choice) {
+    case 'p':
+      options.pqs = std::string{optarg} == "all" ? pqNames() : splitList(optarg);
+      break;
+    case 'h':
+    default:
+      printUsage(argv[0]);
+      return false;
+    } // switch
+  }   // while
+
+  if (optind + 1 != argc) {
+    printUsage(argv[0]);
+    return false;
+  } // if
+  options.trace = argv[optind];
+  return true;
+} // getOptions()
+
+} // namespace
+
+int main(int argc, char *argv[]) {
+  std::ios_base::sync_with_stdio(false);
+  Options options;
+  if (!getOptions(argc, argv, options)) {
+    return 1;
+  } // if
+
+  try {
+    MappedTrace trace{options.trace};
+    std::cout << trace.info().records << " records\n"
+              << std::left << std::setw(16) << "pq" << std::setw(16)
+              << "phase" << std::right << std::setw(12) << "ops"
+              << std::setw(14) << "ops/s" << '\n';
+    long long mismatches = replayType(options, trace);
+    return mismatches == 0 ? 0 : 1;
+  } catch (const std::exception &e) {
+    std::cerr << e.what() << std::endl;
+    return 1;
+  } // try
+} // main()
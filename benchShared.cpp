@@ -0,0 +1,194 @@
+// Project identifier: 43DE0E0C4C76BFAA6D8C2F5AEAE0518A9C42CF4E
+
+/*
+ * Moving work items from a producer process to a consumer process: over a
+ * pipe into the consumer's BinaryPQ, against a SharedMemoryPQ both
+ * processes map.
+ *
+ * For every n, the powers of ten from --min-items to --max-items, a forked
+ * producer sends n random 64-bit keys and the parent consumes them:
+ *
+ *   pipe    the producer write()s each key to a pipe, and the consumer
+ *           read()s each one and pushes it into a BinaryPQ, then pops all
+ *   shared  the producer pushes each key into a SharedMemoryPQ in
+ *           anonymous shared memory, and the consumer waitPop()s them as
+ *           they come
+ *
+ * Reported are the nanoseconds per item from the fork until the consumer
+ * has popped the last one, and the ratio.
+ *
+ * Usage: ./benchShared [--min-items 1000] [--max-items 1000000]
+ *                      [--seed 281]
+ */
+
+#include <getopt.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <array>
+#include <cstdint>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <vector>
+
+#include "Benchmark.hpp"
+#include "SharedMemoryPQ.hpp"
+
+namespace {
+
+// Settings from the command line.
+struct Options {
+  std::size_t minItems = 1000;    // NOLINT: 1e3
+  std::size_t maxItems = 1000000; // NOLINT: 1e6
+  std::uint32_t seed = 281;       // NOLINT: default seed
+};                                // Options
+
+// Description: Fork a producer that calls 'produce' and exits, and
+//              return its pid.
+template <typename PRODUCE> pid_t forkProducer(PRODUCE produce) {
+  std::cout.flush();
+  pid_t pid = ::fork();
+  if (pid == 0) {
+    produce();
+    ::_exit(0);
+  } // if
+  return pid;
+} // forkProducer()
+
+// Description: Wait for the producer 'pid'; returns false if it failed.
+bool producerSucceeded(pid_t pid) {
+  int status = 0;
+  return ::waitpid(pid, &status, 0) == pid && WIFEXITED(status) &&
+         WEXITSTATUS(status) == 0;
+} // producerSucceeded()
+
+// Description: Send 'keys' one write() each over a pipe into a BinaryPQ,
+//              then pop them all.  Returns the seconds taken, or a
+//              negative number if a system call failed.
+double viaPipe(const std::vector<std::uint64_t> &keys) {
+  std::array<int, 2> ends{};
+  if (::pipe(ends.data()) != 0) {
+    return -1;
+  } // if
+  auto start = BenchClock::now();
+  pid_t pid = forkProducer([&keys, &ends] {
+    ::close(ends[0]);
+    for (std::uint64_t key : keys) {
+      if (::write(ends[1], &key, sizeof(key)) != sizeof(key)) {
+        ::_exit(1);
+      } // if
+    } // for ..key
+    ::close(ends[1]);
+  });
+  ::close(ends[1]);
+  BinaryPQ<std::uint64_t> pq;
+  std::uint64_t key = 0;
+  while (::read(ends[0], &key, sizeof(key)) == sizeof(key)) {
+    pq.push(key);
+  } // while
+  while (!pq.empty()) {
+    pq.pop();
+  } // while
+  double seconds = secondsBetween(start, BenchClock::now());
+  ::close(ends[0]);
+  return producerSucceeded(pid) ? seconds : -1;
+} // viaPipe()
+
+// Description: Push 'keys' into a SharedMemoryPQ from a producer process
+//              and pop them in this one as they come.  Returns the seconds
+//              taken, or a negative number if the producer failed.
+double viaShared(const std::vector<std::uint64_t> &keys) {
+  SharedMemoryPQ<std::uint64_t> pq{keys.size()};
+  auto start = BenchClock::now();
+  pid_t pid = forkProducer([&keys, &pq] {
+    for (std::uint64_t key : keys) {
+      pq.push(key);
+    } // for ..key
+  });
+  for (std::size_t i = 0; i < keys.size(); ++i) {
+    pq.waitPop();
+  } // for ..i
+  double seconds = secondsBetween(start, BenchClock::now());
+  return producerSucceeded(pid) ? seconds : -1;
+} // viaShared()
+
+void printUsage(const char *prog) {
+  std::cout << "Usage: " << prog << " [--min-items N] [--max-items N]"
+            << " [--seed S]" << std::endl;
+} // printUsage()
+
+bool getOptions(int argc, char *argv[], Options &options) {
+  // NOLINTNEXTLINE: getopt_long requires a C array
+  static struct option longOpts[] = {
+      {"min-items", required_argument, nullptr, 'n'},
+      {"max-items", required_argument, nullptr, 'N'},
+      {"seed", required_argument, nullptr, 's'},
+      {"help", no_argument, nullptr, 'h'},
+      {nullptr, 0, nullptr, '\0'},
+  };
+
+  int choice = 0;
+  while ((choice = getopt_long(argc, argv, "n:N:s:h", longOpts, nullptr)) !=
+         -1) {
+    switch (choice) {
+    case 'n':
+      options.minItems = std::strtoull(optarg, nullptr, 10); // NOLINT: base
+      break;
+    case 'N':
+      options.maxItems = std::strtoull(optarg, nullptr, 10); // NOLINT: base
+      break;
+    case 's':
+      options.seed = static_cast<std::uint32_t>(
+          std::strtoul(optarg, nullptr, 10)); // NOLINT: base
+      break;
+    case 'h':
+    default:
+      printUsage(argv[0]);
+      return false;
+    } // switch
+  }   // while
+
+  if (options.minItems == 0) {
+    std::cerr << "--min-items must be at least 1" << std::endl;
+    return false;
+  } // if
+  return true;
+} // getOptions()
+
+} // namespace
+
+int main(int argc, char *argv[]) {
+  std::ios_base::sync_with_stdio(false);
+  Options options;
+  if (!getOptions(argc, argv, options)) {
+    return 1;
+  } // if
+
+  std::cout << std::setw(10) << "items" << std::setw(12) << "pipe ns"
+            << std::setw(12) << "shared ns" << std::setw(8) << "ratio"
+            << '\n';
+  for (std::size_t n : powersOfTen(options.minItems, options.maxItems)) {
+    std::mt19937_64 gen{options.seed};
+    std::vector<std::uint64_t> keys(n);
+    for (auto &key : keys) {
+      key = gen();
+    } // for ..key
+
+    double pipe = viaPipe(keys);
+    double shared = viaShared(keys);
+    if (pipe < 0 || shared < 0) {
+      std::cerr << "A producer or a system call failed" << std::endl;
+      return 1;
+    } // if
+    auto items = static_cast<double>(n);
+    std::cout << std::setw(10) << n << std::fixed << std::setprecision(1)
+              << std::setw(12) << pipe * 1e9 / items // NOLINT: ns per s
+              << std::setw(12) << shared * 1e9 / items // NOLINT: ns per s
+              << std::setprecision(2) << std::setw(8) << pipe / shared
+              << std::endl;
+  } // for ..n
+
+  return 0;
+} // main()
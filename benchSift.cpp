@@ -0,0 +1,276 @@
+// Project identifier: 43DE0E0C4C76BFAA6D8C2F5AEAE0518A9C42CF4E
+
+/*
+ * Comparison counts and time of the sift strategies, per kind of key.
+ *
+ * The PQ is filled with n random keys, then each operation pops the top
+ * and pushes a fresh random key, so the heap stays a random heap of size
+ * n.  Keys of three kinds are available:
+ *
+ *   int     plain ints; comparisons are nearly free
+ *   string  24-character strings sharing a 16-character prefix, so every
+ *           comparison scans the prefix
+ *   intptr  pointers into a shuffled array of ints, compared through the
+ *           pointer like IntPtrComp in project2b.cpp; comparisons are
+ *           cache misses once the array is large
+ *
+ * For every (key, pq, n) it reports nanoseconds per pop + push, measured
+ * with a plain comparator, and the comparisons per pop and per push,
+ * counted in a second run with a counting comparator.
+ *
+ * Usage: ./benchSift [--pq binary,bottomup,bheap] [--key int,string,intptr]
+ *                    [--min-size 1000] [--max-size 1000000]
+ *                    [--ops 1000000] [--seed 281]
+ */
+
+#include <getopt.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <numeric>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "Benchmark.hpp"
+
+namespace {
+
+// Settings from the command line.
+struct Options {
+  std::vector<std::string> pqs{"binary", "bottomup", "bheap"};
+  std::vector<std::string> keys{"int", "string", "intptr"};
+  std::size_t minSize = 1000;    // NOLINT: 1e3
+  std::size_t maxSize = 1000000; // NOLINT: 1e6
+  std::size_t ops = 1000000;     // NOLINT: 1e6
+  std::uint32_t seed = 281;      // NOLINT: default seed
+};                               // Options
+
+// Results of one (key, pq, n) combination.
+struct RunResult {
+  double nanosPerOp = 0;
+  double comparesPerPop = 0;
+  double comparesPerPush = 0;
+}; // RunResult
+
+// Compares ints through pointers to them.
+struct IntPtrComp {
+  bool operator()(const int *a, const int *b) const { return *a < *b; }
+}; // IntPtrComp
+
+// Wraps a comparator and counts its calls.
+template <typename COMP_FUNCTOR> struct CountingComp {
+  COMP_FUNCTOR comp;
+  std::uint64_t *count = nullptr;
+
+  template <typename LHS, typename RHS>
+  bool operator()(const LHS &a, const RHS &b) const {
+    ++*count;
+    return comp(a, b);
+  } // operator()()
+};  // CountingComp
+
+// Description: Fill 'pq' with the first n keys, then pop and push one of
+//              the remaining keys per operation.  Returns the elapsed
+//              seconds; 'popCompares' and 'pushCompares' receive the
+//              difference of '*count' over the pops and pushes, when
+//              'count' is not null.
+template <typename PQ, typename KEY>
+double replay(PQ &pq, const std::vector<KEY> &keys, std::size_t n,
+              const std::uint64_t *count, std::uint64_t &popCompares,
+              std::uint64_t &pushCompares) {
+  for (std::size_t i = 0; i < n; ++i) {
+    pq.push(keys[i]);
+  } // for ..i
+  popCompares = 0;
+  pushCompares = 0;
+  auto start = BenchClock::now();
+  for (std::size_t i = n; i < keys.size(); ++i) {
+    if (count != nullptr) {
+      std::uint64_t before = *count;
+      pq.pop();
+      std::uint64_t middle = *count;
+      pq.push(keys[i]);
+      popCompares += middle - before;
+      pushCompares += *count - middle;
+    } else {
+      pq.pop();
+      pq.push(keys[i]);
+    } // if
+  }   // for ..i
+  return secondsBetween(start, BenchClock::now());
+} // replay()
+
+// Description: Time and count one PQ implementation on 'keys'.  Returns
+//              false for an unknown name.
+template <typename KEY, typename COMP_FUNCTOR>
+bool runPQ(const std::string &name, const std::vector<KEY> &keys,
+           std::size_t n, RunResult &result) {
+  auto ops = static_cast<double>(keys.size() - n);
+  std::uint64_t popCompares = 0;
+  std::uint64_t pushCompares = 0;
+  bool known = visitPQ<KEY, COMP_FUNCTOR>(name, [&](auto &pq) {
+    double seconds =
+        replay(pq, keys, n, nullptr, popCompares, pushCompares);
+    result.nanosPerOp = seconds * 1e9 / ops; // NOLINT: ns per second
+  });
+  if (!known) {
+    return false;
+  } // if
+
+  std::uint64_t count = 0;
+  visitPQ<KEY, CountingComp<COMP_FUNCTOR>>(
+      name,
+      [&](auto &pq) {
+        replay(pq, keys, n, &count, popCompares, pushCompares);
+      },
+      CountingComp<COMP_FUNCTOR>{COMP_FUNCTOR{}, &count});
+  result.comparesPerPop = static_cast<double>(popCompares) / ops;
+  result.comparesPerPush = static_cast<double>(pushCompares) / ops;
+  return true;
+} // runPQ()
+
+// Description: Random keys of the kind called 'key', n + ops of them.
+//              Pointer keys point into 'ints', which is filled as well.
+//              Returns false for an unknown kind.
+bool runKey(const Options &options, const std::string &key,
+            const std::string &name, std::size_t n, RunResult &result) {
+  std::mt19937_64 gen{options.seed};
+  std::size_t total = n + options.ops;
+  if (key == "int") {
+    std::uniform_int_distribution<int> dist;
+    std::vector<int> keys(total);
+    std::generate(keys.begin(), keys.end(), [&] { return dist(gen); });
+    return runPQ<int, std::less<int>>(name, keys, n, result);
+  } // if
+  if (key == "string") {
+    std::uniform_int_distribution<int> letter{'a', 'z'};
+    std::vector<std::string> keys(total,
+                                  std::string(16, 'k')); // NOLINT: prefix
+    for (auto &str : keys) {
+      for (int i = 0; i < 8; ++i) { // NOLINT: random suffix
+        str.push_back(static_cast<char>(letter(gen)));
+      } // for ..i
+    }   // for ..str
+    return runPQ<std::string, std::less<std::string>>(name, keys, n, result);
+  } // if
+  if (key == "intptr") {
+    std::uniform_int_distribution<int> dist;
+    std::vector<int> ints(total);
+    std::generate(ints.begin(), ints.end(), [&] { return dist(gen); });
+    std::vector<const int *> keys(total);
+    std::iota(keys.begin(), keys.end(), ints.data());
+    std::shuffle(keys.begin(), keys.end(), gen);
+    return runPQ<const int *, IntPtrComp>(name, keys, n, result);
+  } // if
+  return false;
+} // runKey()
+
+void printUsage(const char *prog) {
+  std::cout << "Usage: " << prog << " [--pq LIST] [--key LIST]"
+            << " [--min-size N] [--max-size N]\n"
+            << "       [--ops N] [--seed S]\n"
+            << "  PQs:";
+  for (const auto &name : pqNames()) {
+    std::cout << ' ' << name;
+  } // for ..name
+  std::cout << "\n  keys: int string intptr" << std::endl;
+} // printUsage()
+
+bool getOptions(int argc, char *argv[], Options &options) {
+  // NOLINTNEXTLINE: getopt_long requires a C array
+  static struct option longOpts[] = {
+      {"pq", required_argument, nullptr, 'p'},
+      {"key", required_argument, nullptr, 'k'},
+      {"min-size", required_argument, nullptr, 'n'},
+      {"max-size", required_argument, nullptr, 'N'},
+      {"ops", required_argument, nullptr, 'o'},
+      {"seed", required_argument, nullptr, 's'},
+      {"help", no_argument, nullptr, 'h'},
+      {nullptr, 0, nullptr, '\0'},
+  };
+
+  int choice = 0;
+  while ((choice = getopt_long(argc, argv, "p:k:n:N:o:s:h", longOpts,
+                               nullptr)) != -1) {
+    switch (choice) {
+    case 'p':
+      options.pqs = splitList(optarg);
+      break;
+    case 'k':
+      options.keys = splitList(optarg);
+      break;
+    case 'n':
+      options.minSize = std::strtoull(optarg, nullptr, 10); // NOLINT: base
+      break;
+    case 'N':
+      options.maxSize = std::strtoull(optarg, nullptr, 10); // NOLINT: base
+      break;
+    case 'o':
+      options.ops = std::strtoull(optarg, nullptr, 10); // NOLINT: base
+      break;
+    case 's':
+      options.seed = static_cast<std::uint32_t>(
+          std::strtoul(optarg, nullptr, 10)); // NOLINT: base
+      break;
+    case 'h':
+    default:
+      printUsage(argv[0]);
+      return false;
+    } // switch
+  }   // while
+
+  if (options.minSize == 0) {
+    std::cerr << "--min-size must be at least 1" << std::endl;
+    return false;
+  } // if
+  return true;
+} // getOptions()
+
+} // namespace
+
+int main(int argc, char *argv[]) {
+  std::ios_base::sync_with_stdio(false);
+  Options options;
+  if (!getOptions(argc, argv, options)) {
+    return 1;
+  } // if
+
+  std::cout << options.ops << " pop + push operations\n"
+            << std::left << std::setw(8) << "key" << std::setw(12) << "pq"
+            << std::right << std::setw(10) << "size" << std::setw(10)
+            << "ns/op" << std::setw(10) << "cmp/pop" << std::setw(10)
+            << "cmp/push" << '\n';
+
+  for (const auto &key : options.keys) {
+    for (std::size_t n : powersOfTen(options.minSize, options.maxSize)) {
+      for (const auto &name : options.pqs) {
+        std::cout << std::left << std::setw(8) << key << std::setw(12)
+                  << name << std::right << std::setw(10) << n;
+        // NOLINTNEXTLINE: 1e4 is where O(n) operations stop being usable
+        if (isLinearPQ(name) && n > 10000) {
+          std::cout << "  skipped (O(n) operations)" << std::endl;
+          continue;
+        } // if
+
+        RunResult result;
+        if (!runKey(options, key, name, n, result)) {
+          std::cout << std::endl;
+          std::cerr << "Unknown PQ " << name << " or key " << key
+                    << std::endl;
+          return 1;
+        } // if
+        std::cout << std::fixed << std::setprecision(1) << std::setw(10)
+                  << result.nanosPerOp << std::setprecision(2)
+                  << std::setw(10) << result.comparesPerPop
+                  << std::setw(10) << result.comparesPerPush << std::endl;
+      } // for ..name
+    }   // for ..n
+  }     // for ..key
+
+  return 0;
+} // main()
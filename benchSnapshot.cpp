@@ -0,0 +1,236 @@
+// Project identifier: 43DE0E0C4C76BFAA6D8C2F5AEAE0518A9C42CF4E
+
+/*
+ * Cost of publishing snapshots for concurrent readers (SnapshotPQ.hpp).
+ *
+ * The writer fills the PQ with n random keys, then each operation pops the
+ * top and pushes a fresh random key, once on the plain PQ and once on the
+ * same kind of PQ wrapped in SnapshotPQ, which publishes the top and size
+ * after every change.  Meanwhile --readers threads poll snapshot() as fast
+ * as they can, and check that the size is always n or n - 1.
+ *
+ * For every (pq, n) it reports the writer's nanoseconds per pop + push,
+ * plain and wrapped, the difference per published change (two per
+ * operation), and the snapshots the readers took per second.
+ *
+ * Usage: ./benchSnapshot [--pq binary,pairing] [--min-size 1000]
+ *                        [--max-size 1000000] [--ops 2000000]
+ *                        [--readers 1] [--seed 281]
+ */
+
+#include <getopt.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstdlib>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "Benchmark.hpp"
+#include "SnapshotPQ.hpp"
+
+namespace {
+
+// Settings from the command line.
+struct Options {
+  std::vector<std::string> pqs{"binary", "pairing"};
+  std::size_t minSize = 1000;    // NOLINT: 1e3
+  std::size_t maxSize = 1000000; // NOLINT: 1e6
+  std::size_t ops = 2000000;     // NOLINT: 2e6
+  std::size_t readers = 1;
+  std::uint32_t seed = 281; // NOLINT: default seed
+};                          // Options
+
+// Results of one (pq, n) combination.
+struct RunResult {
+  double plainNanos = 0;
+  double snapshotNanos = 0;
+  double snapshotsPerSecond = 0;
+  bool consistent = true;
+}; // RunResult
+
+// Description: Fill 'pq' with the first n keys, then pop and push one of
+//              the remaining keys per operation.  Returns the seconds the
+//              operations took.
+template <typename PQ>
+double hold(PQ &pq, const std::vector<std::uint64_t> &keys, std::size_t n) {
+  for (std::size_t i = 0; i < n; ++i) {
+    pq.push(keys[i]);
+  } // for ..i
+  auto start = BenchClock::now();
+  for (std::size_t i = n; i < keys.size(); ++i) {
+    pq.pop();
+    pq.push(keys[i]);
+  } // for ..i
+  return secondsBetween(start, BenchClock::now());
+} // hold()
+
+// Description: Run the hold model on the plain PQ called 'name' and on a
+//              wrapped one with 'readers' threads polling it.  Returns
+//              false for an unknown name.
+bool runPQ(const std::string &name, const std::vector<std::uint64_t> &keys,
+           std::size_t n, std::size_t readers, RunResult &result) {
+  auto ops = static_cast<double>(keys.size() - n);
+  return visitPQ<std::uint64_t, std::less<std::uint64_t>>(
+      name, [&](auto &plain) {
+        using Queue = std::decay_t<decltype(plain)>;
+        result.plainNanos = hold(plain, keys, n) * 1e9 / ops; // NOLINT
+
+        SnapshotPQ<Queue> wrapped;
+        for (std::size_t i = 0; i < n; ++i) {
+          wrapped.push(keys[i]);
+        } // for ..i
+        std::atomic<bool> done{false};
+        std::atomic<std::uint64_t> polls{0};
+        std::atomic<bool> consistent{true};
+        std::vector<std::thread> threads;
+        for (std::size_t r = 0; r < readers; ++r) {
+          threads.emplace_back([&] {
+            std::uint64_t count = 0;
+            while (!done.load(std::memory_order_relaxed)) {
+              auto snap = wrapped.snapshot();
+              if (snap.size != n && snap.size + 1 != n) {
+                consistent.store(false);
+              } // if
+              ++count;
+            } // while
+            polls += count;
+          });
+        } // for ..r
+
+        auto start = BenchClock::now();
+        for (std::size_t i = n; i < keys.size(); ++i) {
+          wrapped.pop();
+          wrapped.push(keys[i]);
+        } // for ..i
+        double seconds = secondsBetween(start, BenchClock::now());
+        done.store(true);
+        for (auto &thread : threads) {
+          thread.join();
+        } // for ..thread
+        result.snapshotNanos = seconds * 1e9 / ops; // NOLINT: ns per s
+        result.snapshotsPerSecond = static_cast<double>(polls.load()) / seconds;
+        result.consistent = consistent.load();
+      });
+} // runPQ()
+
+void printUsage(const char *prog) {
+  std::cout << "Usage: " << prog << " [--pq LIST] [--min-size N]"
+            << " [--max-size N] [--ops N]\n"
+            << "       [--readers R] [--seed S]\n"
+            << "  PQs:";
+  for (const auto &name : pqNames()) {
+    std::cout << ' ' << name;
+  } // for ..name
+  std::cout << std::endl;
+} // printUsage()
+
+bool getOptions(int argc, char *argv[], Options &options) {
+  // NOLINTNEXTLINE: getopt_long requires a C array
+  static struct option longOpts[] = {
+      {"pq", required_argument, nullptr, 'p'},
+      {"min-size", required_argument, nullptr, 'n'},
+      {"max-size", required_argument, nullptr, 'N'},
+      {"ops", required_argument, nullptr, 'o'},
+      {"readers", required_argument, nullptr, 'r'},
+      {"seed", required_argument, nullptr, 's'},
+      {"help", no_argument, nullptr, 'h'},
+      {nullptr, 0, nullptr, '\0'},
+  };
+
+  int choice = 0;
+  while ((choice = getopt_long(argc, argv, "p:n:N:o:r:s:h", longOpts,
+                               nullptr)) != -1) {
+    switch (choice) {
+    case 'p':
+      options.pqs = splitList(optarg);
+      break;
+    case 'n':
+      options.minSize = std::strtoull(optarg, nullptr, 10); // NOLINT: base
+      break;
+    case 'N':
+      options.maxSize = std::strtoull(optarg, nullptr, 10); // NOLINT: base
+      break;
+    case 'o':
+      options.ops = std::strtoull(optarg, nullptr, 10); // NOLINT: base
+      break;
+    case 'r':
+      options.readers = std::strtoull(optarg, nullptr, 10); // NOLINT: base
+      break;
+    case 's':
+      options.seed = static_cast<std::uint32_t>(
+          std::strtoul(optarg, nullptr, 10)); // NOLINT: base
+      break;
+    case 'h':
+    default:
+      printUsage(argv[0]);
+      return false;
+    } // switch
+  }   // while
+
+  if (options.minSize == 0 || options.ops == 0) {
+    std::cerr << "--min-size and --ops must be at least 1" << std::endl;
+    return false;
+  } // if
+  return true;
+} // getOptions()
+
+} // namespace
+
+int main(int argc, char *argv[]) {
+  std::ios_base::sync_with_stdio(false);
+  Options options;
+  if (!getOptions(argc, argv, options)) {
+    return 1;
+  } // if
+
+  std::cout << options.ops << " pop + push operations, " << options.readers
+            << " reader threads\n"
+            << std::left << std::setw(16) << "pq" << std::right
+            << std::setw(10) << "size" << std::setw(10) << "plain"
+            << std::setw(10) << "wrapped" << std::setw(12) << "ns/publish"
+            << std::setw(14) << "snapshots/s" << '\n';
+
+  for (std::size_t n : powersOfTen(options.minSize, options.maxSize)) {
+    std::mt19937_64 gen{options.seed};
+    std::vector<std::uint64_t> keys(n + options.ops);
+    std::generate(keys.begin(), keys.end(), [&gen] { return gen(); });
+    for (const auto &name : options.pqs) {
+      std::cout << std::left << std::setw(16) << name << std::right
+                << std::setw(10) << n;
+      // NOLINTNEXTLINE: 1e4 is where O(n) operations stop being usable
+      if (isLinearPQ(name) && n > 10000) {
+        std::cout << "  skipped (O(n) operations)" << std::endl;
+        continue;
+      } // if
+
+      RunResult result;
+      if (!runPQ(name, keys, n, options.readers, result)) {
+        std::cout << std::endl;
+        std::cerr << "Unknown PQ " << name << std::endl;
+        return 1;
+      } // if
+      if (!result.consistent) {
+        std::cout << std::endl;
+        std::cerr << "A reader saw an impossible size" << std::endl;
+        return 1;
+      } // if
+      std::cout << std::fixed << std::setprecision(1) << std::setw(10)
+                << result.plainNanos << std::setw(10)
+                << result.snapshotNanos << std::setw(12)
+                << (result.snapshotNanos - result.plainNanos) / 2
+                << std::setprecision(0) << std::setw(14)
+                << result.snapshotsPerSecond << std::endl;
+    } // for ..name
+  }   // for ..n
+
+  return 0;
+} // main()
@@ -0,0 +1,293 @@
+// Project identifier: 43DE0E0C4C76BFAA6D8C2F5AEAE0518A9C42CF4E
+
+/*
+ * Timeout workload: most timers are cancelled before they fire.
+ *
+ * There are n connections, each with exactly one pending timeout.  Each
+ * event of the trace is either
+ *   cancel  (probability --cancel, default 0.8): a random connection saw
+ *           activity, so its timeout is cancelled and a new one scheduled;
+ *   expire  the earliest timeout fires, the clock moves to it, and that
+ *           connection schedules a new timeout.
+ * Timeouts are uniform in [1, 2 * --timeout] ticks after the current time.
+ *
+ * The timing wheel reschedules through its handles.  BinaryPQ and PairingPQ
+ * cannot remove an arbitrary element, so they use lazy deletion: a
+ * cancelled timeout stays in the queue as a tombstone and is skipped when
+ * it reaches the top.  The peak queue size shows how much they bloat.
+ *
+ * A key is (tick << 20 | connection), so keys are unique and every
+ * implementation fires the same timeouts in the same order; the checksum
+ * of the fired keys must match across implementations.
+ *
+ * Usage: ./benchTimers [--pq wheel,binary,pairing] [--min-size 1000]
+ *                      [--max-size 1000000] [--ops 2000000]
+ *                      [--cancel 0.8] [--timeout 10000] [--seed 281]
+ */
+
+#include <getopt.h>
+
+#include <cstdint>
+#include <cstdlib>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "Benchmark.hpp"
+#include "TimingWheel.hpp"
+
+namespace {
+
+constexpr unsigned kConnBits = 20;
+constexpr std::uint64_t kMaxConns = std::uint64_t{1} << kConnBits;
+
+// Settings from the command line.
+struct Options {
+  std::vector<std::string> pqs{"wheel", "binary", "pairing"};
+  std::size_t minSize = 1000;    // NOLINT: 1e3
+  std::size_t maxSize = 1000000; // NOLINT: 1e6
+  std::size_t ops = 2000000;     // NOLINT: 2e6
+  double cancel = 0.8;           // NOLINT: 80% of timeouts are cancelled
+  std::uint64_t timeout = 10000; // NOLINT: mean timeout in ticks
+  std::uint32_t seed = 281;      // NOLINT: default seed
+};                               // Options
+
+// One pregenerated event: a connection to cancel (or kMaxConns to expire
+// the earliest timeout) and the new timeout's length.
+struct Event {
+  std::uint32_t conn;
+  std::uint32_t delay;
+}; // Event
+
+// Results of one run.
+struct RunResult {
+  double eventsPerSecond = 0;
+  std::size_t peakSize = 0;
+  std::uint64_t fired = 0;
+  std::uint64_t checksum = 0;
+}; // RunResult
+
+std::uint64_t makeKey(std::uint64_t tick, std::uint64_t conn) {
+  return tick << kConnBits | conn;
+} // makeKey()
+
+std::uint64_t tickOfKey(std::uint64_t key) { return key >> kConnBits; }
+
+std::uint64_t connOfKey(std::uint64_t key) { return key & (kMaxConns - 1); }
+
+// Description: Draw the trace for 'n' connections, and their initial
+//              timeouts.
+std::vector<Event> makeTrace(const Options &options, std::size_t n,
+                             std::vector<std::uint32_t> &initial) {
+  std::mt19937_64 gen{options.seed};
+  std::uniform_real_distribution<double> unit{0.0, 1.0};
+  std::uniform_int_distribution<std::uint32_t> conn{
+      0, static_cast<std::uint32_t>(n - 1)};
+  std::uniform_int_distribution<std::uint32_t> delay{
+      1, static_cast<std::uint32_t>(2 * options.timeout)};
+
+  initial.resize(n);
+  for (auto &first : initial) {
+    first = delay(gen);
+  } // for ..first
+  std::vector<Event> trace(options.ops);
+  for (auto &event : trace) {
+    event.conn = unit(gen) < options.cancel ? conn(gen)
+                                            : static_cast<std::uint32_t>(
+                                                  kMaxConns);
+    event.delay = delay(gen);
+  } // for ..event
+  return trace;
+} // makeTrace()
+
+// Description: Run the trace on the timing wheel, cancelling through the
+//              handles.
+RunResult runWheel(const std::vector<Event> &trace,
+                   const std::vector<std::uint32_t> &initial) {
+  using Wheel = TimingWheel<std::uint64_t>;
+  RunResult result;
+  Wheel wheel;
+  std::vector<Wheel::Node *> handles(initial.size());
+  for (std::size_t conn = 0; conn < initial.size(); ++conn) {
+    handles[conn] = wheel.schedule(makeKey(initial[conn], conn));
+  } // for ..conn
+
+  std::uint64_t now = 0;
+  auto start = BenchClock::now();
+  for (const Event &event : trace) {
+    std::uint64_t conn = event.conn;
+    if (conn == kMaxConns) {
+      std::uint64_t key = wheel.top();
+      now = tickOfKey(key);
+      conn = connOfKey(key);
+      ++result.fired;
+      result.checksum += key;
+    } // if
+    wheel.reschedule(handles[conn], makeKey(now + event.delay, conn));
+  } // for ..event
+  result.eventsPerSecond = static_cast<double>(trace.size()) /
+                           secondsBetween(start, BenchClock::now());
+  result.peakSize = initial.size();
+  return result;
+} // runWheel()
+
+// Description: Run the trace on a PQ of keys with lazy deletion: the
+//              current key of each connection is remembered, and popped
+//              keys that are not current are tombstones.
+template <typename PQ>
+RunResult runLazy(PQ &pq, const std::vector<Event> &trace,
+                  const std::vector<std::uint32_t> &initial) {
+  RunResult result;
+  std::vector<std::uint64_t> current(initial.size());
+  for (std::size_t conn = 0; conn < initial.size(); ++conn) {
+    current[conn] = makeKey(initial[conn], conn);
+    pq.push(current[conn]);
+  } // for ..conn
+
+  std::uint64_t now = 0;
+  std::size_t peak = pq.size();
+  auto start = BenchClock::now();
+  for (const Event &event : trace) {
+    std::uint64_t conn = event.conn;
+    if (conn == kMaxConns) {
+      while (current[connOfKey(pq.top())] != pq.top()) {
+        pq.pop();
+      } // while
+      std::uint64_t key = pq.top();
+      pq.pop();
+      now = tickOfKey(key);
+      conn = connOfKey(key);
+      ++result.fired;
+      result.checksum += key;
+    } // if
+    current[conn] = makeKey(now + event.delay, conn);
+    pq.push(current[conn]);
+    peak = std::max(peak, pq.size());
+  } // for ..event
+  result.eventsPerSecond = static_cast<double>(trace.size()) /
+                           secondsBetween(start, BenchClock::now());
+  result.peakSize = peak;
+  return result;
+} // runLazy()
+
+void printUsage(const char *prog) {
+  std::cout << "Usage: " << prog << " [--pq LIST] [--min-size N]"
+            << " [--max-size N] [--ops N]\n"
+            << "       [--cancel P] [--timeout T] [--seed S]\n"
+            << "  LIST is comma separated: wheel, or any of";
+  for (const auto &name : pqNames()) {
+    std::cout << ' ' << name;
+  } // for ..name
+  std::cout << std::endl;
+} // printUsage()
+
+bool getOptions(int argc, char *argv[], Options &options) {
+  // NOLINTNEXTLINE: getopt_long requires a C array
+  static struct option longOpts[] = {
+      {"pq", required_argument, nullptr, 'p'},
+      {"min-size", required_argument, nullptr, 'n'},
+      {"max-size", required_argument, nullptr, 'N'},
+      {"ops", required_argument, nullptr, 'o'},
+      {"cancel", required_argument, nullptr, 'c'},
+      {"timeout", required_argument, nullptr, 't'},
+      {"seed", required_argument, nullptr, 's'},
+      {"help", no_argument, nullptr, 'h'},
+      {nullptr, 0, nullptr, '\0'},
+  };
+
+  int choice = 0;
+  while ((choice = getopt_long(argc, argv, "p:n:N:o:c:t:s:h", longOpts,
+                               nullptr)) != -1) {
+    switch (choice) {
+    case 'p':
+      options.pqs = splitList(optarg);
+      break;
+    case 'n':
+      options.minSize = std::strtoull(optarg, nullptr, 10); // NOLINT: base
+      break;
+    case 'N':
+      options.maxSize = std::strtoull(optarg, nullptr, 10); // NOLINT: base
+      break;
+    case 'o':
+      options.ops = std::strtoull(optarg, nullptr, 10); // NOLINT: base
+      break;
+    case 'c':
+      options.cancel = std::strtod(optarg, nullptr);
+      break;
+    case 't':
+      options.timeout = std::strtoull(optarg, nullptr, 10); // NOLINT: base
+      break;
+    case 's':
+      options.seed = static_cast<std::uint32_t>(
+          std::strtoul(optarg, nullptr, 10)); // NOLINT: base
+      break;
+    case 'h':
+    default:
+      printUsage(argv[0]);
+      return false;
+    } // switch
+  }   // while
+
+  if (options.minSize == 0 || options.maxSize >= kMaxConns) {
+    std::cerr << "Sizes must be between 1 and " << kMaxConns - 1 << std::endl;
+    return false;
+  } // if
+  if (options.timeout == 0 || options.timeout > UINT32_MAX / 2) {
+    std::cerr << "--timeout out of range" << std::endl;
+    return false;
+  } // if
+  return true;
+} // getOptions()
+
+} // namespace
+
+int main(int argc, char *argv[]) {
+  std::ios_base::sync_with_stdio(false);
+  Options options;
+  if (!getOptions(argc, argv, options)) {
+    return 1;
+  } // if
+
+  std::cout << options.ops << " events, " << options.cancel
+            << " cancelled, mean timeout " << options.timeout << " ticks\n"
+            << std::left << std::setw(10) << "pq" << std::right
+            << std::setw(10) << "size" << std::setw(14) << "events/s"
+            << std::setw(12) << "peak size" << std::setw(10) << "fired"
+            << std::setw(22) << "checksum" << '\n';
+
+  for (std::size_t n : powersOfTen(options.minSize, options.maxSize)) {
+    std::vector<std::uint32_t> initial;
+    std::vector<Event> trace = makeTrace(options, n, initial);
+    for (const auto &name : options.pqs) {
+      std::cout << std::left << std::setw(10) << name << std::right
+                << std::setw(10) << n;
+      // NOLINTNEXTLINE: 1e4 is where O(n) operations stop being usable
+      if (isLinearPQ(name) && n > 10000) {
+        std::cout << "  skipped (O(n) operations)" << std::endl;
+        continue;
+      } // if
+
+      RunResult result;
+      if (name == "wheel") {
+        result = runWheel(trace, initial);
+      } else if (!visitPQ<std::uint64_t, std::greater<std::uint64_t>>(
+                     name, [&](auto &pq) {
+                       result = runLazy(pq, trace, initial);
+                     })) {
+        std::cout << std::endl;
+        std::cerr << "Unknown PQ " << name << std::endl;
+        return 1;
+      } // if
+
+      std::cout << std::setw(14) << std::fixed << std::setprecision(0)
+                << result.eventsPerSecond << std::setw(12) << result.peakSize
+                << std::setw(10) << result.fired << std::setw(22)
+                << result.checksum << std::endl;
+    } // for ..name
+  }   // for ..n
+
+  return 0;
+} // main()
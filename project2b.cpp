@@ -24,17 +24,55 @@
  * do.
  */
 
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <array>
+#include <atomic>
 #include <cassert>
+#include <chrono>
+#include <cstdlib>
+#include <filesystem>
+#include <future>
 #include <iostream>
+#include <iterator>
+#include <limits>
+#include <list>
+#include <memory_resource>
+#include <numeric>
+#include <optional>
 #include <ostream>
+#include <random>
+#include <set>
 #include <stdexcept>
 #include <string>
+#include <system_error>
+#include <thread>
 #include <vector>
 
+#include "AdaptivePQ.hpp"
+#include "Benchmark.hpp"
 #include "BinaryPQ.hpp"
+#include "CompactPairingPQ.hpp"
 #include "Eecs281PQ.hpp"
+#include "FlatCombiningPQ.hpp"
+#include "LoserTree.hpp"
+#include "MemoryUsage.hpp"
+#include "MinMaxPQ.hpp"
 #include "PairingPQ.hpp"
+#include "PersistentPQ.hpp"
+#include "PriorityThreadPool.hpp"
+#include "RadixSort.hpp"
+#include "RecordingPQ.hpp"
+#include "SequenceHeapPQ.hpp"
+#include "SharedMemoryPQ.hpp"
+#include "SnapshotPQ.hpp"
 #include "SortedPQ.hpp"
+#include "TimingWheel.hpp"
+#include "TopK.hpp"
+#include "TraceReplay.hpp"
+#include "UnorderedFastPQ.hpp"
 #include "UnorderedPQ.hpp"
 
 // A type for representing priority queue types at runtime
@@ -43,6 +81,14 @@ enum class PQType {
   Sorted,
   Binary,
   Pairing,
+  UnorderedFast,
+  MinMax,
+  Adaptive,
+  Persistent,
+  TimingWheel,
+  CompactPairing,
+  SequenceHeap,
+  Extras,
 };
 
 // These can be pretty-printed :)
@@ -56,6 +102,22 @@ std::ostream &operator<<(std::ostream &ost, PQType pqType) {
     return ost << "Binary";
   case PQType::Pairing:
     return ost << "Pairing";
+  case PQType::UnorderedFast:
+    return ost << "UnorderedFast";
+  case PQType::MinMax:
+    return ost << "MinMax";
+  case PQType::Adaptive:
+    return ost << "Adaptive";
+  case PQType::Persistent:
+    return ost << "Persistent";
+  case PQType::TimingWheel:
+    return ost << "TimingWheel";
+  case PQType::CompactPairing:
+    return ost << "CompactPairing";
+  case PQType::SequenceHeap:
+    return ost << "SequenceHeap";
+  case PQType::Extras:
+    return ost << "Extras (TopK, LoserTree, SharedMemory)";
   } // switch
 
   return ost << "Unknown PQType";
@@ -155,6 +217,862 @@ template <template <typename...> typename PQ> void testUpdatePriorities() {
   // TODO: Add more testing here as you see fit.
 } // testUpdatePriorities()
 
+// Detects PQs with a merge(other) member.
+template <typename PQ, typename = void> struct HasMerge : std::false_type {};
+
+template <typename PQ>
+struct HasMerge<PQ, std::void_t<decltype(std::declval<PQ &>().merge(
+                        std::declval<PQ &>()))>> : std::true_type {};
+
+// Test that a PQ can be backed by a std::pmr::memory_resource: every
+// allocation must come from the arena, and the copies must still work.
+// PQs that can merge() must not keep memory of the other PQ's resource.
+template <template <typename...> typename PQ> void testAllocator() {
+  std::cout << "Testing with a pmr allocator..." << std::endl;
+
+  // The arena has no upstream, so any allocation that escapes the buffer
+  // (e.g. to global new) throws std::bad_alloc instead.
+  std::vector<std::byte> buffer(1 << 16); // NOLINT: arena size for the test
+  std::pmr::monotonic_buffer_resource bounded{buffer.data(), buffer.size(),
+                                              std::pmr::null_memory_resource()};
+
+  using PmrPQ = PQ<int, std::less<int>, std::pmr::polymorphic_allocator<int>>;
+  const std::vector<int> vec{5, 1, 9, 3, 7}; // NOLINT: arbitrary test data
+  {
+    PmrPQ pq{vec.begin(), vec.end(), std::less<int>{}, &bounded};
+    assert(pq.get_allocator().resource() == &bounded);
+    for (int i = 0; i < 100; ++i) { // NOLINT: enough pushes to allocate
+      pq.push(i);
+    } // for ..i
+    assert(pq.size() == 105);
+    assert(pq.top() == 99);
+
+    PmrPQ copy{pq};
+    PmrPQ assigned{std::less<int>{}, &bounded};
+    assigned = pq;
+    assert(assigned.get_allocator().resource() == &bounded);
+    for (int expected = 99; expected >= 10; --expected) {
+      assert(copy.top() == expected);
+      assert(assigned.top() == expected);
+      copy.pop();
+      assigned.pop();
+    } // for ..expected
+
+    PmrPQ moved{std::move(pq)};
+    assert(moved.size() == 105);
+    assert(moved.top() == 99);
+  } // block for testing destructors
+
+  if constexpr (HasMerge<PmrPQ>::value) {
+    std::pmr::unsynchronized_pool_resource pool;
+    PmrPQ merged{vec.begin(), vec.end(), std::less<int>{}, &pool};
+    {
+      std::vector<std::byte> otherBuffer(1 << 12); // NOLINT: arena size
+      std::pmr::monotonic_buffer_resource arena{
+          otherBuffer.data(), otherBuffer.size(),
+          std::pmr::null_memory_resource()};
+      PmrPQ other{vec.begin(), vec.end(), std::less<int>{}, &arena};
+      other.push(100); // NOLINT: larger than vec
+      merged.merge(other);
+    } // block for releasing the arena
+    assert(merged.size() == 2 * vec.size() + 1);
+    assert(merged.top() == 100);
+    merged.pop();
+    assert(merged.top() == 9);
+  } // if
+
+  std::cout << "testAllocator succeeded!" << std::endl;
+} // testAllocator()
+
+// Orders ints increasingly or decreasingly, as chosen at construction.
+struct DirectedComp {
+  bool minFirst = false;
+
+  bool operator()(int a, int b) const {
+    return minFirst ? b < a : a < b;
+  } // operator()
+};  // DirectedComp structure
+
+// Test that copy and move assignment take over the comparator along with
+// the elements: a max-first PQ assigned from a min-first one must be
+// min-first afterwards, also when pmr allocators on different resources
+// make the move copy the elements.
+template <template <typename...> typename PQ> void testCompareAssignment() {
+  std::cout << "Testing assignment with a stateful comparator..."
+            << std::endl;
+
+  const std::vector<int> vec{5, 1, 9, 3, 7}; // NOLINT: arbitrary test data
+  const DirectedComp minFirst{true};
+  PQ<int, DirectedComp> source{vec.begin(), vec.end(), minFirst};
+
+  PQ<int, DirectedComp> copied{};
+  copied = source;
+  copied.push(0);
+  copied.push(10); // NOLINT: larger than every element
+  assert(copied.top() == 0);
+
+  PQ<int, DirectedComp> moved{};
+  moved = std::move(source);
+  moved.push(-1);
+  assert(moved.top() == -1);
+  std::vector<int> drained;
+  moved.drainSorted(std::back_inserter(drained));
+  assert((drained == std::vector<int>{-1, 1, 3, 5, 7, 9})); // NOLINT
+
+  using PmrPQ =
+      PQ<int, DirectedComp, std::pmr::polymorphic_allocator<int>>;
+  std::pmr::unsynchronized_pool_resource first;
+  std::pmr::unsynchronized_pool_resource second;
+  PmrPQ pmrSource{vec.begin(), vec.end(), minFirst, &first};
+  PmrPQ pmrMoved{DirectedComp{}, &second};
+  pmrMoved = std::move(pmrSource);
+  assert(pmrMoved.get_allocator().resource() == &second);
+  pmrMoved.push(0);
+  assert(pmrMoved.top() == 0);
+
+  std::cout << "testCompareAssignment succeeded!" << std::endl;
+} // testCompareAssignment()
+
+// Test that drainSorted() empties the PQ and writes every element, most
+// extreme first, and that the PQ is still usable afterwards.
+template <template <typename...> typename PQ> void testDrainSorted() {
+  std::cout << "Testing drainSorted..." << std::endl;
+
+  std::mt19937 gen{281}; // NOLINT: fixed seed for reproducible tests
+  std::uniform_int_distribution<int> dist{0, 99}; // NOLINT: want duplicates
+  std::vector<int> vec(300);                     // NOLINT
+  for (auto &val : vec) {
+    val = dist(gen);
+  } // for ..val
+
+  std::vector<int> expected{vec};
+  std::sort(expected.begin(), expected.end(), std::greater<int>{});
+  PQ<int> pq{vec.begin(), vec.end()};
+  std::vector<int> drained;
+  pq.drainSorted(std::back_inserter(drained));
+  assert(drained == expected);
+  assert(pq.empty());
+  assert(pq.size() == 0); // NOLINT: Explicit test for size == 0
+
+  pq.push(4);
+  pq.push(2);
+  assert(pq.top() == 4);
+
+  std::reverse(expected.begin(), expected.end());
+  PQ<int, std::greater<int>> minPQ{vec.begin(), vec.end()};
+  std::vector<int> ascending(vec.size());
+  [[maybe_unused]] auto end = minPQ.drainSorted(ascending.begin());
+  assert(end == ascending.end());
+  assert(ascending == expected);
+
+  std::cout << "testDrainSorted succeeded!" << std::endl;
+} // testDrainSorted()
+
+// Test that eraseIf() removes exactly the matching elements, leaves a
+// valid PQ and does not affect copies.
+template <template <typename...> typename PQ> void testEraseIf() {
+  std::cout << "Testing eraseIf..." << std::endl;
+
+  std::mt19937 gen{281}; // NOLINT: fixed seed for reproducible tests
+  std::uniform_int_distribution<int> dist{0, 999}; // NOLINT
+  std::vector<int> vec(600);                      // NOLINT
+  for (auto &val : vec) {
+    val = dist(gen);
+  } // for ..val
+
+  PQ<int> pq{vec.begin(), vec.begin() + 300}; // NOLINT: half bulk-built
+  for (auto it = vec.begin() + 300; it != vec.end(); ++it) { // NOLINT
+    pq.push(*it);
+  } // for ..it
+  PQ<int> copy{pq};
+
+  auto multipleOfThree = [](int val) { return val % 3 == 0; };
+  std::vector<int> expected;
+  std::copy_if(vec.begin(), vec.end(), std::back_inserter(expected),
+               [&](int val) { return !multipleOfThree(val); });
+  std::sort(expected.begin(), expected.end(), std::greater<int>{});
+
+  [[maybe_unused]] size_t erased = pq.eraseIf(multipleOfThree);
+  assert(erased == vec.size() - expected.size());
+  assert(pq.size() == expected.size());
+  assert(pq.eraseIf(multipleOfThree) == 0);
+  pq.push(1000); // NOLINT: larger than anything erased
+  assert(pq.top() == 1000);
+  pq.pop();
+
+  std::vector<int> drained;
+  pq.drainSorted(std::back_inserter(drained));
+  assert(drained == expected);
+  assert(copy.size() == vec.size());
+  assert(copy.top() == *std::max_element(vec.begin(), vec.end()));
+
+  assert(copy.eraseIf([](int) { return true; }) == vec.size());
+  assert(copy.empty());
+  copy.push(7); // NOLINT
+  assert(copy.top() == 7);
+
+  std::cout << "testEraseIf succeeded!" << std::endl;
+} // testEraseIf()
+
+// Test replaceTop() and pushPop() through the Eecs281PQ interface, mixed
+// with pushes and pops, against a std::multiset.
+template <template <typename...> typename PQ> void testReplaceTop() {
+  std::cout << "Testing replaceTop and pushPop..." << std::endl;
+
+  PQ<int> pq;
+  Eecs281PQ<int> &eecsPQ = pq;
+  [[maybe_unused]] int popped = eecsPQ.pushPop(5); // NOLINT
+  assert(popped == 5); // NOLINT: empty, returned right away
+  assert(eecsPQ.empty());
+
+  std::mt19937 gen{281}; // NOLINT: fixed seed for reproducible tests
+  std::uniform_int_distribution<int> dist{0, 999}; // NOLINT
+  std::multiset<int> expected;
+  for (int round = 0; round < 4000; ++round) { // NOLINT
+    int val = dist(gen);
+    switch (expected.empty() ? 0 : val % 4) {
+    case 0:
+      eecsPQ.push(val);
+      expected.insert(val);
+      break;
+    case 1:
+      eecsPQ.pop();
+      expected.erase(std::prev(expected.end()));
+      break;
+    case 2:
+      eecsPQ.replaceTop(val);
+      expected.erase(std::prev(expected.end()));
+      expected.insert(val);
+      break;
+    default: {
+      expected.insert(val);
+      [[maybe_unused]] int most = *expected.rbegin();
+      expected.erase(std::prev(expected.end()));
+      popped = eecsPQ.pushPop(val);
+      assert(popped == most);
+      break;
+    }
+    } // switch
+    assert(eecsPQ.size() == expected.size());
+    assert(expected.empty() || eecsPQ.top() == *expected.rbegin());
+  } // for ..round
+
+  std::cout << "testReplaceTop succeeded!" << std::endl;
+} // testReplaceTop()
+
+// Test that PairingPQ's replaceTop() and pushPop() reuse the root's node.
+void testPairingReplaceTop() {
+  std::cout << "Testing PairingPQ replaceTop node reuse..." << std::endl;
+
+  PairingPQ<int> pq;
+  pq.push(3);
+  pq.push(7); // NOLINT
+  PairingPQ<int>::Node *top = pq.addNode(9); // NOLINT
+  pq.replaceTop(1);
+  assert(top->getElt() == 1);
+  assert(pq.top() == 7);
+  assert(pq.size() == 3);
+  [[maybe_unused]] int popped = pq.pushPop(8); // NOLINT
+  assert(popped == 8);                         // NOLINT: would be the top
+  popped = pq.pushPop(2);                      // NOLINT
+  assert(popped == 7);                         // NOLINT
+  assert(pq.size() == 3);
+  pq.updateElt(top, 5); // NOLINT: the reused node is still a valid handle
+  assert(pq.top() == 5);
+
+  std::cout << "testPairingReplaceTop succeeded!" << std::endl;
+} // testPairingReplaceTop()
+
+// Test PairingPQ::merge() with equal allocators, where the nodes change
+// owner, and with pmr allocators on different resources, where they must
+// not: the merged heap has to outlive the arena 'other' allocated from.
+void testPairingMerge() {
+  std::cout << "Testing PairingPQ merge..." << std::endl;
+
+  using PmrPairing =
+      PairingPQ<int, std::less<int>, std::pmr::polymorphic_allocator<int>>;
+  std::pmr::unsynchronized_pool_resource pool;
+  PmrPairing pq{std::less<int>{}, &pool};
+  pq.push(4); // NOLINT
+  {
+    PmrPairing same{std::less<int>{}, &pool};
+    same.push(6); // NOLINT
+    pq.merge(same);
+    assert(same.empty());
+
+    std::vector<std::byte> buffer(1 << 12); // NOLINT: arena size
+    std::pmr::monotonic_buffer_resource arena{
+        buffer.data(), buffer.size(), std::pmr::null_memory_resource()};
+    PmrPairing other{std::less<int>{}, &arena};
+    for (int i = 0; i < 8; ++i) { // NOLINT: a few nodes in the arena
+      other.push(i * 3);         // NOLINT
+    } // for ..i
+    pq.merge(other);
+    assert(other.empty());
+  } // block for releasing the arena
+  assert(pq.size() == 10);
+
+  std::vector<int> drained;
+  pq.drainSorted(std::back_inserter(drained));
+  assert((drained == std::vector<int>{21, 18, 15, 12, 9, 6, 6, 4, 3, 0}));
+
+  std::cout << "testPairingMerge succeeded!" << std::endl;
+} // testPairingMerge()
+
+// A trace file of its own in the temporary directory, named after 'name'
+// and made unique by mkstemp(), so that concurrent test runs do not write
+// over each other's traces.  The file is removed when this goes out of
+// scope.
+class TempTrace {
+public:
+  explicit TempTrace(const std::string &name) {
+    std::string pattern =
+        (std::filesystem::temp_directory_path() /
+         ("project2b-" + name + "-XXXXXX"))
+            .string();
+    std::vector<char> buffer(pattern.begin(), pattern.end());
+    buffer.push_back('\0');
+    int fd = ::mkstemp(buffer.data());
+    if (fd < 0) {
+      throw std::runtime_error("cannot create a trace file for " + name);
+    } // if
+    ::close(fd);
+    filePath = buffer.data();
+  } // TempTrace()
+
+  TempTrace(const TempTrace &) = delete;
+  TempTrace &operator=(const TempTrace &) = delete;
+
+  ~TempTrace() {
+    std::error_code ignored;
+    std::filesystem::remove(filePath, ignored);
+  } // ~TempTrace()
+
+  const std::string &path() const { return filePath; }
+
+private:
+  std::string filePath;
+}; // TempTrace
+
+// Test that a RecordingPQ records a random mix of operations, and that
+// replaying the trace against PQ and BinaryPQ reproduces every result,
+// while a PQ with the opposite order is caught.
+template <template <typename...> typename PQ> void testRecording() {
+  std::cout << "Testing RecordingPQ and replayTrace..." << std::endl;
+
+  const TempTrace file{"recording.trace"};
+  const std::string &path = file.path();
+  std::mt19937 gen{281}; // NOLINT: fixed seed
+  std::uniform_int_distribution<int> values{0, 99}; // NOLINT
+  std::uniform_int_distribution<int> ops{0, 5};     // NOLINT
+  {
+    RecordingPQ<PQ<int>> pq{path};
+    markPhase(pq, "fill");
+    for (int i = 0; i < 50; ++i) { // NOLINT
+      pq.push(values(gen));
+    } // for ..i
+    markPhase(pq, "mixed");
+    for (int round = 0; round < 500; ++round) { // NOLINT
+      int op = pq.empty() ? 0 : ops(gen);
+      switch (op) {
+      case 0:
+        pq.push(values(gen));
+        break;
+      case 1:
+        pq.pop();
+        break;
+      case 2:
+        pq.replaceTop(values(gen));
+        break;
+      case 3:
+        pq.pushPop(values(gen));
+        break;
+      case 4:
+        pq.updatePriorities();
+        break;
+      default:
+        pq.top();
+        break;
+      } // switch
+    }   // for ..round
+    assert(pq.size() == pq.inner().size());
+  } // The destructor finishes the trace.
+
+  MappedTrace trace{path};
+  assert(trace.info().type == TraceType::Int32);
+  assert(trace.info().comp == TraceComp::Less);
+  assert(trace.info().records == 552);   // NOLINT: 550 + two phases
+  assert(trace.info().hasUpdates == 0);
+
+  PQ<int> same;
+  ReplayResult result = replayTrace<int, std::less<int>>(trace, same);
+  assert(result.mismatches == 0);
+  assert(result.phases.size() == 2);
+  assert(result.phases[0].name == "fill");
+  assert(result.phases[0].ops == 50);  // NOLINT
+  assert(result.phases[1].ops == 500); // NOLINT
+  BinaryPQ<int> binary;
+  result = replayTrace<int, std::less<int>>(trace, binary);
+  assert(result.mismatches == 0);
+  assert(same.size() == binary.size());
+
+  BinaryPQ<int, std::greater<int>> reversed;
+  result = replayTrace<int, std::less<int>>(trace, reversed);
+  assert(result.mismatches > 0);
+
+  std::cout << "testRecording succeeded!" << std::endl;
+} // testRecording()
+
+// Test PriorityThreadPool with PQ as the workers' queues: the priority
+// order on a single worker, capacity, futures and exceptions, jobs that
+// submit jobs on several workers, and the destructor running what is left.
+template <template <typename...> typename PQ> void testThreadPool() {
+  std::cout << "Testing PriorityThreadPool..." << std::endl;
+
+  {
+    // One worker, held up by a gate of the highest priority, so the jobs
+    // queued behind it run strictly by priority, and first come, first
+    // served among equals.
+    PriorityThreadPoolOf<PQ> pool{1};
+    std::promise<void> gate;
+    std::shared_future<void> opened = gate.get_future().share();
+    pool.post(100, [opened] { opened.wait(); }); // NOLINT: the highest
+    std::vector<int> order;
+    const std::array<int, 5> priorities{3, 1, 2, 3, 1};
+    for (int i = 0; i < 5; ++i) { // NOLINT
+      pool.post(priorities[static_cast<size_t>(i)],
+                [&order, i] { order.push_back(i); });
+    } // for ..i
+    assert(not pool.idle());
+    gate.set_value();
+    pool.wait();
+    assert(pool.idle());
+    assert(pool.queued() == 0);
+    assert((order == std::vector<int>{0, 3, 2, 1, 4}));
+  }
+
+  {
+    // Room for two queued jobs while the only worker is held up.
+    PriorityThreadPoolOf<PQ> pool{1, 2};
+    std::promise<void> started;
+    std::promise<void> gate;
+    std::shared_future<void> opened = gate.get_future().share();
+    pool.post(0, [&started, opened] {
+      started.set_value();
+      opened.wait();
+    });
+    started.get_future().wait();
+    auto one = pool.trySubmit(1, [] { return 1; });
+    auto two = pool.trySubmit(2, [] { return 2; });
+    assert(one && two);
+    assert(pool.queued() == 2);
+    assert(not pool.trySubmit(3, [] { return 3; }));
+    assert(not pool.tryPost(3, [] {}));
+    assert(not pool.waitFor(std::chrono::milliseconds(1)));
+
+    // A blocking submit waits for room, which opening the gate makes.
+    std::future<int> three;
+    std::thread submitter{
+        [&pool, &three] { three = pool.submit(3, [] { return 3; }); }};
+    gate.set_value();
+    submitter.join();
+    assert(one->get() == 1 && two->get() == 2 && three.get() == 3);
+    auto failing = pool.submit(0, []() -> int {
+      throw std::runtime_error("job failed");
+    });
+    [[maybe_unused]] bool caught = false;
+    try {
+      failing.get();
+    } catch (const std::runtime_error &) {
+      caught = true;
+    } // try
+    assert(caught);
+    assert(pool.waitFor(std::chrono::seconds(10))); // NOLINT
+  }
+
+  {
+    // Outer jobs from outside, each posting inner jobs from inside the
+    // pool, which the other workers steal.
+    PriorityThreadPoolOf<PQ> pool{4}; // NOLINT
+    std::atomic<int> inner{0};
+    std::vector<std::future<int>> squares;
+    for (int i = 0; i < 200; ++i) { // NOLINT
+      squares.push_back(pool.submit(i % 7, [&pool, &inner, i] { // NOLINT
+        for (int j = 0; j < 5; ++j) {                          // NOLINT
+          pool.post(j, [&inner] { ++inner; });
+        } // for ..j
+        return i * i;
+      }));
+    } // for ..i
+    pool.wait();
+    assert(inner.load() == 1000); // NOLINT: 200 * 5
+    for (int i = 0; i < 200; ++i) { // NOLINT
+      assert(squares[static_cast<size_t>(i)].get() == i * i);
+    } // for ..i
+  }
+
+  std::atomic<int> leftover{0};
+  {
+    PriorityThreadPoolOf<PQ> pool{2};
+    for (int i = 0; i < 100; ++i) { // NOLINT
+      pool.post(i, [&leftover] { ++leftover; });
+    } // for ..i
+  }   // The destructor runs what is still queued.
+  assert(leftover.load() == 100); // NOLINT
+
+  std::cout << "testThreadPool succeeded!" << std::endl;
+} // testThreadPool()
+
+// Four copies of one number, so that a torn copy shows.
+struct Wide {
+  uint64_t a, b, c, d;
+}; // Wide
+
+struct WideLess {
+  bool operator()(const Wide &x, const Wide &y) const { return x.a < y.a; }
+}; // WideLess
+
+// Test SnapshotPQ with PQ inside: a reader thread polls snapshots while the
+// writer pushes and pops, and must never see a torn element, an element
+// without a size or the version going back; handles are forwarded too.
+template <template <typename...> typename PQ> void testSnapshot() {
+  std::cout << "Testing SnapshotPQ..." << std::endl;
+
+  SnapshotPQ<PQ<Wide, WideLess>> pq;
+  [[maybe_unused]] auto first = pq.snapshot();
+  assert(not first.top && first.size == 0 && first.version == 1);
+
+  std::atomic<bool> done{false};
+  std::atomic<bool> torn{false};
+  std::thread reader{[&pq, &done, &torn] {
+    uint64_t last = 0;
+    while (!done.load()) {
+      auto snap = pq.snapshot();
+      if (snap.version < last || snap.top.has_value() != (snap.size != 0) ||
+          (snap.top && (snap.top->b != snap.top->a ||
+                        snap.top->c != snap.top->a ||
+                        snap.top->d != snap.top->a))) {
+        torn.store(true);
+      } // if
+      last = snap.version;
+    } // while
+  }};
+  uint64_t changes = 1;
+  for (uint64_t i = 1; i <= 3000; ++i) { // NOLINT
+    pq.push(Wide{i, i, i, i});
+    ++changes;
+    if (i % 3 == 0) { // NOLINT
+      pq.pop();
+      ++changes;
+    } // if
+  }   // for ..i
+  done.store(true);
+  reader.join();
+  assert(not torn.load());
+
+  [[maybe_unused]] auto last = pq.snapshot();
+  assert(last.size == pq.size() && last.size == 2000); // NOLINT
+  assert(last.top && last.top->a == pq.top().a);
+  assert(last.version == changes);
+
+  if constexpr (HasHandles<PQ<Wide, WideLess>, Wide>::value) {
+    auto handle = pq.addNode(Wide{5000, 5000, 5000, 5000}); // NOLINT
+    assert(pq.snapshot().top->a == 5000);                    // NOLINT
+    pq.updateElt(handle, Wide{6000, 6000, 6000, 6000});     // NOLINT
+    assert(pq.snapshot().top->d == 6000);                    // NOLINT
+  } // if
+  while (!pq.empty()) {
+    pq.pop();
+  } // while
+  assert(not pq.snapshot().top && pq.snapshot().size == 0);
+
+  std::cout << "testSnapshot succeeded!" << std::endl;
+} // testSnapshot()
+
+// Test FlatCombiningPQ with PQ inside: alone, then with threads pushing
+// at once, popping at once (each thread must see its pops in priority
+// order, and together all elements once), and pushing and popping mixed.
+template <template <typename...> typename PQ> void testFlatCombining() {
+  std::cout << "Testing FlatCombiningPQ..." << std::endl;
+
+  {
+    FlatCombiningPQ<PQ<int>> pq{PQ<int>{}, 1};
+    assert(not pq.tryPop() && pq.empty());
+    for (int val : {3, 9, 1, 7}) { // NOLINT
+      pq.push(val);
+    } // for ..val
+    assert(pq.size() == 4);
+    for ([[maybe_unused]] int val : {9, 7, 3, 1}) { // NOLINT
+      [[maybe_unused]] auto popped = pq.tryPop();
+      assert(popped && *popped == val);
+    } // for ..val
+    assert(not pq.tryPop());
+  }
+
+  // More threads than slots, so some wait for a free one.
+  constexpr int kThreads = 6;
+  constexpr int kEach = 1000;
+  FlatCombiningPQ<PQ<int>> pq{PQ<int>{}, 4};
+  std::vector<std::thread> threads;
+  for (int t = 0; t < kThreads; ++t) {
+    threads.emplace_back([&pq, t] {
+      for (int i = 0; i < kEach; ++i) {
+        pq.push(i * kThreads + t);
+      } // for ..i
+    });
+  } // for ..t
+  for (auto &thread : threads) {
+    thread.join();
+  } // for ..thread
+  threads.clear();
+  assert(pq.size() == kThreads * kEach);
+
+  std::vector<std::vector<int>> popped(kThreads);
+  for (int t = 0; t < kThreads; ++t) {
+    threads.emplace_back([&pq, &popped, t] {
+      while (auto val = pq.tryPop()) {
+        popped[static_cast<size_t>(t)].push_back(*val);
+      } // while
+    });
+  } // for ..t
+  for (auto &thread : threads) {
+    thread.join();
+  } // for ..thread
+  threads.clear();
+  std::vector<int> all;
+  for (const auto &vals : popped) {
+    assert(std::is_sorted(vals.rbegin(), vals.rend()));
+    all.insert(all.end(), vals.begin(), vals.end());
+  } // for ..vals
+  std::sort(all.begin(), all.end());
+  for (int i = 0; i < kThreads * kEach; ++i) {
+    assert(all[static_cast<size_t>(i)] == i);
+  } // for ..i
+  assert(pq.empty());
+
+  std::atomic<int> pops{0};
+  for (int t = 0; t < kThreads; ++t) {
+    threads.emplace_back([&pq, &pops, t] {
+      for (int i = 0; i < kEach; ++i) {
+        pq.push(i * kThreads + t);
+        if (i % 2 == 0 && pq.tryPop()) {
+          ++pops;
+        } // if
+      }   // for ..i
+    });
+  } // for ..t
+  for (auto &thread : threads) {
+    thread.join();
+  } // for ..thread
+  // Every thread pushed before it popped, so no pop found the PQ empty.
+  assert(pops.load() == kThreads * kEach / 2);
+  assert(pq.size() == kThreads * kEach / 2);
+  assert(pq.inner().size() == pq.size());
+  [[maybe_unused]] std::optional<int> last;
+  while (auto val = pq.tryPop()) {
+    assert(not last || *val <= *last);
+    last = val;
+  } // while
+
+  std::cout << "testFlatCombining succeeded!" << std::endl;
+} // testFlatCombining()
+
+// Test that updateElt() on a recorded PairingPQ replays through handles on
+// a PairingPQ, and by removing and pushing on a BinaryPQ.
+void testPairingRecording() {
+  std::cout << "Testing RecordingPQ with PairingPQ handles..." << std::endl;
+
+  const TempTrace file{"pairing.trace"};
+  const std::string &path = file.path();
+  {
+    RecordingPQ<PairingPQ<int>> pq{path};
+    pq.push(5); // NOLINT
+    auto *low = pq.addNode(1);
+    auto *mid = pq.addNode(4); // NOLINT
+    pq.push(3);                // NOLINT
+    pq.updateElt(low, 8);      // NOLINT: push number 1, now the top
+    pq.top();
+    pq.pop();
+    pq.updateElt(mid, 6); // NOLINT: push number 2
+    pq.top();
+    pq.close();
+    assert(pq.size() == 3);
+  }
+
+  MappedTrace trace{path};
+  assert(trace.info().hasUpdates != 0);
+  assert(trace.info().pqType == tracePQTypeOf<PairingPQ<int>>());
+  PairingPQ<int> pairing;
+  ReplayResult result = replayTrace<int, std::less<int>>(trace, pairing);
+  assert(result.mismatches == 0);
+  assert(pairing.size() == 3 && pairing.top() == 6);
+  BinaryPQ<int> binary;
+  result = replayTrace<int, std::less<int>>(trace, binary);
+  assert(result.mismatches == 0);
+  assert(binary.size() == 3 && binary.top() == 6);
+
+  // Equal elements: the recording pops the first one and updates the
+  // second.  A PairingPQ type that breaks the tie the other way pops the
+  // second, so it must replay without handles.
+  const TempTrace tieFile{"pairing-tie.trace"};
+  const std::string &tiePath = tieFile.path();
+  {
+    RecordingPQ<PairingPQ<int>> pq{tiePath};
+    pq.addNode(5);                // NOLINT
+    auto *second = pq.addNode(5); // NOLINT
+    pq.pop();
+    pq.updateElt(second, 7); // NOLINT: push number 1, now the top
+    pq.top();
+    pq.close();
+  }
+  MappedTrace tie{tiePath};
+  PairingPQ<int, std::less_equal<int>> unmatched;
+  assert(tie.info().pqType != tracePQTypeOf<decltype(unmatched)>());
+  result = replayTrace<int, std::less<int>>(tie, unmatched);
+  assert(result.mismatches == 0);
+  assert(unmatched.size() == 1 && unmatched.top() == 7);
+
+  std::cout << "testPairingRecording succeeded!" << std::endl;
+} // testPairingRecording()
+
+// Test CompactPairingPQ's handles: updateElt() through them, slot reuse
+// by the free list, handles that stay valid in copies, and the smaller
+// footprint that is the point of the class.
+void testCompactPairing() {
+  std::cout << "Testing CompactPairingPQ handles and slots..." << std::endl;
+
+  CompactPairingPQ<int> pq;
+  std::vector<CompactPairingPQ<int>::Handle> handles;
+  for (int i = 0; i < 10; ++i) { // NOLINT
+    handles.push_back(pq.addNode(i));
+  } // for ..i
+  assert(handles[3].index() == 3);
+  assert(handles[3] != CompactPairingPQ<int>::Handle{});
+  pq.updateElt(handles[3], 20); // NOLINT
+  assert(pq.top() == 20);
+  assert(pq.getElt(handles[3]) == 20);
+  pq.updateElt(handles[5], 15); // NOLINT
+  pq.pop();
+  assert(pq.top() == 15);
+
+  // The copy has the same slots, so the handles carry over.
+  CompactPairingPQ<int> copy{pq};
+  copy.updateElt(handles[7], 30); // NOLINT
+  assert(copy.top() == 30);
+  assert(pq.top() == 15);
+
+  // A pop frees a slot and the next push takes it, so the array does not
+  // grow.
+  [[maybe_unused]] std::size_t capacity = pq.memoryUsage().total();
+  [[maybe_unused]] auto handle = pq.addNode(40); // NOLINT
+  assert(handle == handles[3]);
+  assert(pq.memoryUsage().total() == capacity);
+  assert(pq.size() == 10);
+
+  std::vector<int> drained;
+  pq.drainSorted(std::back_inserter(drained));
+  assert((drained == std::vector<int>{40, 15, 9, 8, 7, 6, 4, 2, 1, 0}));
+
+  // Nodes without pointers and malloc headers: at least half the bytes of
+  // PairingPQ for ints.
+  CompactPairingPQ<int> compact;
+  PairingPQ<int> pairing;
+  compact.reserve(1000); // NOLINT
+  for (int i = 0; i < 1000; ++i) { // NOLINT
+    compact.push(i);
+    pairing.push(i);
+  } // for ..i
+  assert(compact.memoryUsage().payload == pairing.memoryUsage().payload);
+  assert(2 * compact.memoryUsage().total() <= pairing.memoryUsage().total());
+
+  std::cout << "testCompactPairing succeeded!" << std::endl;
+} // testCompactPairing()
+
+// Test that memoryUsage() counts exactly the elements as payload, and some
+// overhead for the structure around them.
+template <template <typename...> typename PQ> void testMemoryUsage() {
+  std::cout << "Testing memoryUsage..." << std::endl;
+
+  PQ<int> pq;
+  assert(pq.memoryUsage().payload == 0);
+  for (int i = 0; i < 1000; ++i) { // NOLINT: enough to allocate
+    pq.push(i);
+  } // for ..i
+  [[maybe_unused]] MemoryUsage usage = pq.memoryUsage();
+  assert(usage.payload == 1000 * sizeof(int));
+  assert(usage.overhead > 0);
+  assert(usage.total() == usage.payload + usage.overhead + usage.slack);
+  while (pq.size() > 10) { // NOLINT
+    pq.pop();
+  } // while
+  assert(pq.memoryUsage().payload == 10 * sizeof(int));
+  std::vector<int> drained;
+  pq.drainSorted(std::back_inserter(drained));
+  assert(pq.memoryUsage().payload == 0);
+
+  std::cout << "testMemoryUsage succeeded!" << std::endl;
+} // testMemoryUsage()
+
+// Shrink once less than a quarter full, but keep room for 16 elements, so
+// that small tests shrink several times.
+using SmallShrink = ShrinkBelow<4, 16>; // NOLINT
+
+// Test that a PQ with the SmallShrink policy gives capacity back as it
+// drains, keeps its order while doing so, and does not reallocate when
+// pushes and pops alternate after a shrink.
+template <typename PQ> void testShrinkPolicy() {
+  std::cout << "Testing shrink policy..." << std::endl;
+
+  // Slack bound that SmallShrink guarantees after every removal: the
+  // capacity is below 4 * slots + 4, or at most 16.
+  [[maybe_unused]] auto withinBound = [](const MemoryUsage &usage) {
+    return usage.slack <= 3 * (usage.payload + usage.overhead) +
+                              16 * sizeof(int); // NOLINT
+  };
+
+  PQ pq;
+  for (int i = 0; i < 10000; ++i) { // NOLINT: large burst
+    pq.push(i);
+  } // for ..i
+  int expected = 9999; // NOLINT
+  while (pq.size() > 100) { // NOLINT
+    assert(pq.top() == expected);
+    pq.pop();
+    --expected;
+    assert(withinBound(pq.memoryUsage()));
+  } // while
+  assert(pq.memoryUsage().slack < 1000 * sizeof(int)); // NOLINT
+
+  // Pop until the next shrink.  Right after it the capacity is twice the
+  // size, so alternating pushes and pops must not reallocate.
+  std::size_t total = pq.memoryUsage().total();
+  while (pq.memoryUsage().total() == total) {
+    pq.pop();
+    --expected;
+  } // while
+  total = pq.memoryUsage().total();
+  for (int i = 0; i < 1000; ++i) { // NOLINT
+    pq.push(10000);                // NOLINT: larger than anything left
+    pq.pop();
+    assert(pq.memoryUsage().total() == total);
+  } // for ..i
+
+  [[maybe_unused]] size_t erased =
+      pq.eraseIf([&](int val) { return val > expected - 5; }); // NOLINT
+  assert(erased == 5);
+  assert(withinBound(pq.memoryUsage()));
+  expected -= 5; // NOLINT
+  while (!pq.empty()) {
+    assert(pq.top() == expected);
+    pq.pop();
+    --expected;
+  } // while
+  assert(expected == -1);
+  assert(pq.memoryUsage().slack <= 16 * sizeof(int)); // NOLINT
+
+  std::cout << "testShrinkPolicy succeeded!" << std::endl;
+} // testShrinkPolicy()
+
 // Test the pairing heap's range-based constructor, copy constructor,
 // copy-assignment operator, and destructor
 // TODO: Test other operations specific to this PQ type.
@@ -297,29 +1215,1206 @@ void testPairing3() {
             << "copied size is: " << pairingPq3.size() << std::endl;
 }
 
-// Run all tests for a particular PQ type.
-template <template <typename...> typename PQ> void testPriorityQueue() {
+// Test the double-ended operations of the min-max heap against a
+// std::multiset, removing from both ends in a random order.
+void testMinMax() {
+  std::cout << "Testing MinMax Heap separately..." << std::endl;
+
+  std::mt19937 gen{281}; // NOLINT: fixed seed for reproducible tests
+  std::uniform_int_distribution<int> dist{0, 999}; // NOLINT
+  std::vector<int> vec(500);                      // NOLINT
+  for (auto &val : vec) {
+    val = dist(gen);
+  } // for ..val
+
+  MinMaxPQ<int> pq{vec.begin(), vec.end()};
+  std::multiset<int> expected{vec.begin(), vec.end()};
+  while (!expected.empty()) {
+    assert(pq.size() == expected.size());
+    assert(pq.top() == *expected.rbegin());
+    assert(pq.bottom() == *expected.begin());
+    switch (dist(gen) % 3) {
+    case 0:
+      pq.pop();
+      expected.erase(std::prev(expected.end()));
+      break;
+    case 1:
+      pq.popBottom();
+      expected.erase(expected.begin());
+      break;
+    default:
+      pq.popBottom();
+      expected.erase(expected.begin());
+      if (dist(gen) % 2 == 0) {
+        int val = dist(gen);
+        pq.push(val);
+        expected.insert(val);
+      } // if
+      break;
+    } // switch
+  }   // while
+  assert(pq.empty());
+
+  // A reversed comparator turns bottom() into the largest element.
+  MinMaxPQ<int, std::greater<int>> rev{vec.begin(), vec.end()};
+  assert(rev.top() == *std::min_element(vec.begin(), vec.end()));
+  assert(rev.bottom() == *std::max_element(vec.begin(), vec.end()));
+
+  std::cout << "testMinMax succeeded!" << std::endl;
+} // testMinMax()
+
+// Test the bounded top-K selector built on BinaryPQ, with both single and
+// batched pushes, against a full sort of the same data.
+void testTopK() {
+  std::cout << "Testing TopK separately..." << std::endl;
+
+  std::mt19937 gen{281}; // NOLINT: fixed seed for reproducible tests
+  std::uniform_int_distribution<int> dist{0, 9999}; // NOLINT
+  std::vector<int> vec(2000);                      // NOLINT
+  for (auto &val : vec) {
+    val = dist(gen);
+  } // for ..val
+  std::vector<int> sorted{vec};
+  std::sort(sorted.begin(), sorted.end(), std::greater<int>{});
+
+  const size_t k = 37; // NOLINT: not a power of two on purpose
+  TopK<int> single{k};
+  for (int val : vec) {
+    single.push(val);
+  } // for ..val
+  assert(single.full());
+  assert(single.worst() == sorted[k - 1]);
+  assert(not single.push(sorted[k] - 1));
+
+  TopK<int> batched{k};
+  batched.pushBatch(vec.begin(), vec.end());
+
+  const std::vector<int> expected{sorted.begin(), sorted.begin() + k};
+  assert(single.extractSorted() == expected);
+  assert(batched.extractSorted() == expected);
+  assert(single.empty());
+
+  // With std::greater the "best" elements are the smallest ones.
+  TopK<int, std::greater<int>> smallest{3};
+  smallest.pushBatch(vec.begin(), vec.end());
+  const std::vector<int> lowest{sorted.rbegin(), sorted.rbegin() + 3};
+  assert(smallest.extractSorted() == lowest);
+
+  // The staging buffer of pushBatch() comes from the selector's allocator
+  // too, so the resource sees the heap and the buffer, k elements each.
+  CountingResource counting;
+  TopK<int, std::less<int>, std::pmr::polymorphic_allocator<int>> pmrTopK{
+      k, std::less<int>{}, &counting};
+  pmrTopK.pushBatch(vec.begin(), vec.end());
+  assert(counting.peak() >= 2 * k * sizeof(int));
+  auto kept = pmrTopK.extractSorted();
+  assert(std::equal(kept.begin(), kept.end(), expected.begin(),
+                    expected.end()));
+
+  TopK<int> none{0};
+  assert(not none.push(1));
+  none.pushBatch(vec.begin(), vec.end());
+  assert(none.empty());
+
+  std::cout << "testTopK succeeded!" << std::endl;
+} // testTopK()
+
+// Test BinaryPQ's two sift paths (trivially copyable keys and others) at
+// every size up to a few levels, so both parities of the last level, which
+// decide whether a node has a single child, are covered.
+void testBinarySift() {
+  std::cout << "Testing BinaryPQ sift paths separately..." << std::endl;
+
+  std::mt19937 gen{281}; // NOLINT: fixed seed for reproducible tests
+  std::uniform_int_distribution<int> dist{0, 49}; // NOLINT: with duplicates
+  for (size_t n = 0; n < 70; ++n) {               // NOLINT: a few levels
+    std::vector<int> vec(n);
+    for (auto &val : vec) {
+      val = dist(gen);
+    } // for ..val
+    std::vector<std::string> strs;
+    for (int val : vec) {
+      strs.push_back(std::to_string(val));
+    } // for ..val
+
+    BinaryPQ<int, std::greater<int>> ints{vec.begin(), vec.end()};
+    BinaryPQ<std::string> strings;
+    for (const auto &str : strs) {
+      strings.push(str);
+    } // for ..str
+
+    std::sort(vec.begin(), vec.end());
+    std::sort(strs.begin(), strs.end(), std::greater<std::string>{});
+    for (size_t i = 0; i < n; ++i) {
+      assert(ints.top() == vec[i]);
+      assert(strings.top() == strs[i]);
+      ints.pop();
+      strings.pop();
+    } // for ..i
+    assert(ints.empty() && strings.empty());
+  } // for ..n
+
+  std::cout << "testBinarySift succeeded!" << std::endl;
+} // testBinarySift()
+
+// Test BinaryPQ::pushRange() against a std::multiset, with batches smaller
+// than the heap (fixed up one by one) and larger (rebuilt), in both
+// layouts, the paged one across the padding slot of a new page.
+void testPushRange() {
+  std::cout << "Testing BinaryPQ pushRange..." << std::endl;
+
+  std::mt19937 gen{281}; // NOLINT: fixed seed for reproducible tests
+  std::uniform_int_distribution<int> dist{0, 999}; // NOLINT: duplicates
+  BinaryPQ<int> flat;
+  BinaryPQ<int, std::less<int>, std::allocator<int>, BHeapLayout<64>>
+      paged; // NOLINT
+  std::multiset<int> expected;
+  for (size_t batch : {0, 1, 5, 3, 40, 2, 200, 7, 31}) { // NOLINT
+    std::vector<int> vec(batch);
+    for (auto &val : vec) {
+      val = dist(gen);
+    } // for ..val
+    flat.pushRange(vec.begin(), vec.end());
+    paged.pushRange(vec.begin(), vec.end());
+    expected.insert(vec.begin(), vec.end());
+    assert(flat.size() == expected.size());
+    assert(paged.size() == expected.size());
+    // Pop a few, so the next batch meets a heap that was not rebuilt.
+    for (int i = 0; i < 3 && !expected.empty(); ++i) {
+      assert(flat.top() == *expected.rbegin());
+      assert(paged.top() == *expected.rbegin());
+      flat.pop();
+      paged.pop();
+      expected.erase(std::prev(expected.end()));
+    } // for ..i
+  }   // for ..batch
+  while (!expected.empty()) {
+    assert(flat.top() == *expected.rbegin());
+    assert(paged.top() == *expected.rbegin());
+    flat.pop();
+    paged.pop();
+    expected.erase(std::prev(expected.end()));
+  } // while
+  assert(flat.empty() && paged.empty());
+
+  std::cout << "testPushRange succeeded!" << std::endl;
+} // testPushRange()
+
+// Description: Fork a child process that runs 'body' and exits with status
+//              0 if it returns true.  A failed assert in the child aborts
+//              it instead.  Returns the child's pid.
+template <typename BODY> pid_t forkChild(BODY body) {
+  std::cout.flush();
+  pid_t pid = ::fork();
+  assert(pid >= 0);
+  if (pid == 0) {
+    ::_exit(body() ? 0 : 1);
+  } // if
+  return pid;
+} // forkChild()
+
+// Description: Wait for the child 'pid' and return true if it succeeded.
+bool childSucceeded(pid_t pid) {
+  int status = 0;
+  return ::waitpid(pid, &status, 0) == pid && WIFEXITED(status) &&
+         WEXITSTATUS(status) == 0;
+} // childSucceeded()
+
+// Test SharedMemoryPQ in one process, then across processes: two forked
+// producers pushing into anonymous shared memory while the parent takes
+// everything with waitPop(), and a child that opens the parent's file by
+// its path and drains it in order.
+void testSharedMemory() {
+  std::cout << "Testing SharedMemoryPQ separately..." << std::endl;
+
+  std::mt19937 gen{281}; // NOLINT: fixed seed for reproducible tests
+  std::uniform_int_distribution<int> dist{0, 999}; // NOLINT: duplicates
+  const size_t capacity = 600;                     // NOLINT
+  SharedMemoryPQ<int> pq{capacity};
+  std::multiset<int> expected;
+  assert(pq.empty() && !pq.tryPop());
+  for (size_t i = 0; i < capacity; ++i) {
+    int val = dist(gen);
+    pq.push(val);
+    expected.insert(val);
+    assert(pq.top() == *expected.rbegin());
+  } // for ..i
+  assert(pq.size() == capacity && pq.capacity() == capacity);
+  assert(pq.memoryUsage().payload == capacity * sizeof(int));
+  [[maybe_unused]] bool threw = false;
+  try {
+    pq.push(0);
+  } catch (const std::length_error &) {
+    threw = true;
+  } // try
+  assert(threw && pq.size() == capacity);
+  pq.replaceTop(-1);
+  expected.erase(std::prev(expected.end()));
+  expected.insert(-1);
+  [[maybe_unused]] int top = *expected.rbegin();
+  [[maybe_unused]] int same = pq.pushPop(1000); // NOLINT: above all
+  assert(same == 1000);                          // NOLINT
+  [[maybe_unused]] int popped = pq.pushPop(-2);
+  assert(popped == top);
+  expected.erase(std::prev(expected.end()));
+  expected.insert(-2);
+  pq.updatePriorities();
+  while (!expected.empty()) {
+    [[maybe_unused]] std::optional<int> next = pq.tryPop();
+    assert(next == *expected.rbegin());
+    expected.erase(std::prev(expected.end()));
+  } // while
+  assert(pq.empty());
+
+  // Two producers, and the parent as the consumer, which sleeps in
+  // waitPop() whenever it gets ahead of them.
+  const uint64_t perChild = 5000; // NOLINT
+  SharedMemoryPQ<uint64_t> shared{2 * perChild};
+  std::vector<pid_t> children;
+  for (uint64_t child = 0; child < 2; ++child) {
+    children.push_back(forkChild([&shared, child, perChild] {
+      for (uint64_t i = 0; i < perChild; ++i) {
+        shared.push(child * perChild + i);
+      } // for ..i
+      return true;
+    }));
+  } // for ..child
+  std::vector<bool> seen(2 * perChild);
+  for (uint64_t i = 0; i < 2 * perChild; ++i) {
+    uint64_t val = shared.waitPop();
+    assert(val < seen.size() && !seen[val]);
+    seen[val] = true;
+  } // for ..i
+  for (pid_t child : children) {
+    [[maybe_unused]] bool succeeded = childSucceeded(child);
+    assert(succeeded);
+  } // for ..child
+  assert(shared.empty());
+
+  // The same PQ opened by path in another process.
+  std::string path = (std::filesystem::temp_directory_path() /
+                      ("project2b_shared_pq_" + std::to_string(::getpid())))
+                         .string();
+  SharedMemoryPQ<int, std::greater<int>>::remove(path);
+  {
+    const int count = 100; // NOLINT
+    SharedMemoryPQ<int, std::greater<int>> byPath{path, count};
+    std::vector<int> vals(count);
+    std::iota(vals.begin(), vals.end(), 0);
+    std::shuffle(vals.begin(), vals.end(), gen);
+    for (int val : vals) {
+      byPath.push(val);
+    } // for ..val
+    pid_t child = forkChild([&path, count] {
+      SharedMemoryPQ<int, std::greater<int>> opened{path, 1};
+      assert(opened.capacity() == count && opened.size() == count);
+      for (int val = 0; val < count; ++val) {
+        [[maybe_unused]] std::optional<int> next = opened.tryPop();
+        assert(next == val);
+      } // for ..val
+      return opened.empty();
+    });
+    [[maybe_unused]] bool succeeded = childSucceeded(child);
+    assert(succeeded && byPath.empty());
+
+    threw = false;
+    try {
+      SharedMemoryPQ<uint64_t> wrongSize{path, 1};
+    } catch (const std::runtime_error &) {
+      threw = true;
+    } // try
+    assert(threw);
+  }
+  SharedMemoryPQ<int>::remove(path);
+
+  std::cout << "testSharedMemory succeeded!" << std::endl;
+} // testSharedMemory()
+
+// A BinaryPQ that sifts bottom-up.
+template <typename TYPE, typename COMP_FUNCTOR = std::less<TYPE>,
+          typename ALLOCATOR = std::allocator<TYPE>>
+using BottomUpPQ = BinaryPQ<TYPE, COMP_FUNCTOR, ALLOCATOR, FlatLayout,
+                            NeverShrink, BottomUpSift>;
+
+// Compares ints and counts how often it was called.
+struct CountingIntComp {
+  std::size_t *count = nullptr;
+
+  bool operator()(int a, int b) const {
+    ++*count;
+    return a < b;
+  } // operator()()
+};  // CountingIntComp
+
+// Description: Number of comparisons PQ needs to heapify 'vec' and pop
+//              everything, checking the order on the way.
+template <typename PQ>
+std::size_t countDrainCompares(const std::vector<int> &vec) {
+  std::size_t count = 0;
+  PQ pq{vec.begin(), vec.end(), CountingIntComp{&count}};
+  std::vector<int> sorted{vec};
+  std::sort(sorted.begin(), sorted.end(), std::greater<int>{});
+  for ([[maybe_unused]] int expected : sorted) {
+    assert(pq.top() == expected);
+    pq.pop();
+  } // for ..expected
+  return count;
+} // countDrainCompares()
+
+// Test the bottom-up sift against a std::multiset with int (the arithmetic
+// child selection) and std::string elements, in both layouts, and check
+// that it saves comparisons.
+void testBottomUp() {
+  std::cout << "Testing BinaryPQ bottom-up sift separately..." << std::endl;
+
+  std::mt19937 gen{281}; // NOLINT: fixed seed for reproducible tests
+  std::uniform_int_distribution<int> dist{0, 9999}; // NOLINT
+  BottomUpPQ<int> ints;
+  BottomUpPQ<std::string> strings;
+  BinaryPQ<int, std::less<int>, std::allocator<int>, BHeapLayout<64>,
+           NeverShrink, BottomUpSift>
+      paged; // NOLINT
+  std::multiset<int> expected;
+  std::multiset<std::string> expectedStrings;
+  for (int round = 0; round < 6000; ++round) { // NOLINT: grow and shrink
+    bool grow = round < 3000 ? dist(gen) % 3 != 0 : dist(gen) % 3 == 0;
+    if (grow || expected.empty()) {
+      int val = dist(gen);
+      ints.push(val);
+      paged.push(val);
+      strings.push(std::to_string(val));
+      expected.insert(val);
+      expectedStrings.insert(std::to_string(val));
+    } else {
+      assert(ints.top() == *expected.rbegin());
+      assert(paged.top() == *expected.rbegin());
+      assert(strings.top() == *expectedStrings.rbegin());
+      ints.pop();
+      paged.pop();
+      strings.pop();
+      expected.erase(std::prev(expected.end()));
+      expectedStrings.erase(std::prev(expectedStrings.end()));
+    } // if
+    assert(ints.size() == expected.size());
+    assert(paged.size() == expected.size());
+  } // for ..round
+
+  std::vector<int> vec(4096); // NOLINT
+  for (auto &val : vec) {
+    val = dist(gen);
+  } // for ..val
+  [[maybe_unused]] std::size_t topDown =
+      countDrainCompares<BinaryPQ<int, CountingIntComp>>(vec);
+  [[maybe_unused]] std::size_t bottomUp =
+      countDrainCompares<BottomUpPQ<int, CountingIntComp>>(vec);
+  // About log(n) instead of 2 log(n) per pop.
+  assert(bottomUp * 10 < topDown * 7); // NOLINT
+
+  std::cout << "testBottomUp succeeded!" << std::endl;
+} // testBottomUp()
+
+// Test kWayMerge() against a sort of all runs, with empty runs, a single
+// run and no runs at all, and check that the loser tree replays a source
+// in at most ceil(log2(k)) comparisons.
+void testLoserTree() {
+  std::cout << "Testing LoserTree separately..." << std::endl;
+
+  std::mt19937 gen{281}; // NOLINT: fixed seed for reproducible tests
+  std::uniform_int_distribution<int> dist{0, 9999}; // NOLINT
+  for (size_t k : {0, 1, 2, 3, 5, 37, 64}) {        // NOLINT
+    std::vector<std::vector<int>> runs(k);
+    std::vector<int> expected;
+    for (auto &run : runs) {
+      run.resize(static_cast<size_t>(dist(gen) % 50)); // NOLINT: some empty
+      for (auto &val : run) {
+        val = dist(gen);
+      } // for ..val
+      std::sort(run.begin(), run.end());
+      expected.insert(expected.end(), run.begin(), run.end());
+    } // for ..run
+    std::sort(expected.begin(), expected.end());
+
+    std::vector<int> merged;
+    kWayMerge(runs, std::back_inserter(merged));
+    assert(merged == expected);
+
+    // Descending runs through the iterator pair overload, from lists.
+    std::vector<std::list<int>> lists;
+    std::vector<std::pair<std::list<int>::const_iterator,
+                          std::list<int>::const_iterator>>
+        ranges;
+    lists.reserve(k);
+    for (const auto &run : runs) {
+      lists.emplace_back(run.rbegin(), run.rend());
+      ranges.emplace_back(lists.back().cbegin(), lists.back().cend());
+    } // for ..run
+    std::vector<int> descending(expected.size());
+    [[maybe_unused]] auto last =
+        kWayMerge(ranges, descending.begin(), std::greater<int>{});
+    assert(last == descending.end());
+    assert(std::equal(descending.begin(), descending.end(),
+                      expected.rbegin()));
+  } // for ..k
+
+  // Every source gets a new random element when it wins; the winner must
+  // be the largest current element, found in ceil(log2(37)) = 6
+  // comparisons or fewer.
+  const size_t k = 37; // NOLINT: not a power of two on purpose
+  size_t count = 0;
+  LoserTree<int, CountingIntComp> tree{k, CountingIntComp{&count}};
+  std::vector<int> current(k);
+  for (size_t i = 0; i < k; ++i) {
+    current[i] = dist(gen);
+    tree.setSource(i, current[i]);
+  } // for ..i
+  tree.build();
+  assert(count <= k - 1);
+  for (int round = 0; round < 1000; ++round) { // NOLINT
+    assert(tree.size() == k);
+    assert(tree.top() == *std::max_element(current.begin(), current.end()));
+    assert(current[tree.topSource()] == tree.top());
+    count = 0;
+    current[tree.topSource()] = dist(gen);
+    tree.replaceTop(current[tree.topSource()]);
+    assert(count <= 6); // NOLINT: ceil(log2(37))
+  }                     // for ..round
+  while (!tree.empty()) {
+    current[tree.topSource()] = -1;
+    tree.pop();
+    if (!tree.empty()) {
+      assert(tree.top() ==
+             *std::max_element(current.begin(), current.end()));
+    } // if
+  }   // while
+
+  std::cout << "testLoserTree succeeded!" << std::endl;
+} // testLoserTree()
+
+// A BinaryPQ in the B-heap layout with tiny pages, so that small tests
+// already span several levels of pages.
+template <typename TYPE, typename COMP_FUNCTOR = std::less<TYPE>,
+          typename ALLOCATOR = std::allocator<TYPE>>
+using SmallPageBHeapPQ =
+    BinaryPQ<TYPE, COMP_FUNCTOR, ALLOCATOR, BHeapLayout<64>>; // NOLINT
+
+// Test the B-heap layout with interleaved pushes and pops against a
+// std::multiset, with int (16 per page) and std::string (2 per page, the
+// degenerate case) elements.
+void testBHeap() {
+  std::cout << "Testing BinaryPQ B-heap layout separately..." << std::endl;
+
+  std::mt19937 gen{281}; // NOLINT: fixed seed for reproducible tests
+  std::uniform_int_distribution<int> dist{0, 9999}; // NOLINT
+  std::vector<int> vec(1000);                      // NOLINT
+  for (auto &val : vec) {
+    val = dist(gen);
+  } // for ..val
+
+  SmallPageBHeapPQ<int> ints{vec.begin(), vec.end()};
+  SmallPageBHeapPQ<std::string, std::greater<std::string>> strings;
+  std::multiset<int> expected{vec.begin(), vec.end()};
+  std::multiset<std::string> expectedStrings;
+  for (int val : vec) {
+    strings.push(std::to_string(val));
+    expectedStrings.insert(std::to_string(val));
+  } // for ..val
+
+  // Grow to a few thousand elements, then shrink to nothing.
+  for (int round = 0; round < 8000; ++round) { // NOLINT: grow and shrink
+    bool grow = round < 4000 ? dist(gen) % 3 != 0 : dist(gen) % 3 == 0;
+    if (grow || expected.empty()) {
+      int val = dist(gen);
+      ints.push(val);
+      strings.push(std::to_string(val));
+      expected.insert(val);
+      expectedStrings.insert(std::to_string(val));
+    } else {
+      ints.pop();
+      strings.pop();
+      expected.erase(std::prev(expected.end()));
+      expectedStrings.erase(expectedStrings.begin());
+    } // if
+    assert(ints.size() == expected.size());
+    assert(ints.top() == *expected.rbegin());
+    assert(strings.top() == *expectedStrings.begin());
+  } // for ..round
+
+  std::vector<int> remaining{expected.rbegin(), expected.rend()};
+  std::vector<int> drained;
+  ints.drainSorted(std::back_inserter(drained));
+  assert(drained == remaining);
+  while (!strings.empty()) {
+    assert(strings.top() == *expectedStrings.begin());
+    strings.pop();
+    expectedStrings.erase(expectedStrings.begin());
+  } // while
+
+  std::cout << "testBHeap succeeded!" << std::endl;
+} // testBHeap()
+
+// The priorities of a fixed schedule table, in no particular order.
+constexpr std::array<int, 12> kScheduleInput{30, 5,  18, 40, 12, 27, // NOLINT
+                                             3,  33, 9,  21, 15, 36}; // NOLINT
+
+// Description: Build a PQ from kScheduleInput, run each kind of operation
+//              on it, and drain it into a table, most extreme first.  In
+//              C++20 builds this can run at compile time.
+template <typename PQ> PQ_CONSTEXPR std::array<int, 12> buildSchedule() {
+  PQ pq{kScheduleInput.begin(), kScheduleInput.end()};
+  pq.push(42); // NOLINT
+  pq.pop();
+  pq.replaceTop(7); // NOLINT
+  pq.pushPop(16);   // NOLINT
+  pq.push(8);       // NOLINT
+  pq.updatePriorities();
+  pq.pop();
+  std::array<int, 12> table{};
+  pq.drainSorted(table.begin());
+  return table;
+} // buildSchedule()
+
+// Test that a schedule table built with PQ matches one built with a
+// std::multiset, and in C++20 builds that the same table built at compile
+// time matches the one built at runtime.
+template <typename PQ> void testConstexpr() {
+  std::cout << "Testing compile-time tables..." << std::endl;
+
+  std::multiset<int> expected(kScheduleInput.begin(), kScheduleInput.end());
+  auto popTop = [&expected] { expected.erase(std::prev(expected.end())); };
+  expected.insert(42); // NOLINT
+  popTop();
+  popTop();
+  expected.insert(7); // NOLINT
+  popTop();
+  expected.insert(16); // NOLINT
+  expected.insert(8);  // NOLINT
+  popTop();
+
+  [[maybe_unused]] const std::array<int, 12> runtime = buildSchedule<PQ>();
+  assert(std::equal(runtime.begin(), runtime.end(), expected.rbegin(),
+                    expected.rend()));
+#if PQ_HAS_CONSTEXPR
+  constexpr std::array<int, 12> compileTime = buildSchedule<PQ>();
+  static_assert(compileTime.front() == 30 && compileTime.back() == 3);
+  assert(compileTime == runtime);
+  std::cout << "Compile-time table checked" << std::endl;
+#endif
+
+  std::cout << "testConstexpr succeeded!" << std::endl;
+} // testConstexpr()
+
+// A job ordered by its deadline alone, which radixSort() can sort by.
+struct Deadline {
+  uint32_t due;
+  int id;
+
+  bool operator<(const Deadline &other) const { return due < other.due; }
+  bool operator>(const Deadline &other) const { return due > other.due; }
+}; // Deadline
+
+template <> struct RadixKey<Deadline> {
+  static uint32_t key(const Deadline &job) { return job.due; }
+}; // RadixKey<Deadline>
+
+static_assert(RadixOrder<int, std::less<int>>::sortable);
+static_assert(RadixOrder<float, std::greater<>>::descending);
+static_assert(RadixOrder<Deadline, std::less<Deadline>>::sortable);
+static_assert(!RadixOrder<bool, std::less<bool>>::sortable);
+static_assert(!RadixOrder<int, InvertedComp<std::less<int>>>::sortable);
+static_assert(!RadixOrder<int, std::function<bool(int, int)>>::sortable);
+
+// Description: Sort 'vals' both ways with sortByCompare() and check the
+//              results against std::sort.  -0.0 and +0.0 compare equal, so
+//              the vectors compare equal whatever order radixSort() put
+//              them in.
+template <typename TYPE> void checkRadixSort(const std::vector<TYPE> &vals) {
+  std::vector<TYPE> expected{vals};
+  std::vector<TYPE> actual{vals};
+  std::less<TYPE> less;
+  std::sort(expected.begin(), expected.end(), less);
+  sortByCompare(actual, less);
+  assert(actual == expected);
+
+  std::greater<> greater;
+  actual = vals;
+  std::reverse(expected.begin(), expected.end());
+  sortByCompare(actual, greater);
+  assert(actual == expected);
+} // checkRadixSort()
+
+// Test the radix sort behind SortedPQ::updatePriorities() for every kind
+// of key: unsigned and signed integers, floats with negative, zero,
+// subnormal and infinite values, keys whose high bytes are all equal (so
+// their passes are skipped), and a struct with a RadixKey, which must be
+// sorted stably by its key.
+void testRadixSort() {
+  std::cout << "Testing radix sort separately..." << std::endl;
+
+  std::mt19937_64 gen{281}; // NOLINT: fixed seed for reproducible tests
+  const size_t n = 5000;    // NOLINT: well above kRadixMinSize
+  std::vector<uint32_t> u32(n);
+  std::vector<int64_t> i64(n);
+  std::vector<int16_t> small(n);
+  std::vector<uint8_t> bytes(n);
+  std::vector<float> f32(n);
+  std::vector<double> f64(n);
+  std::uniform_real_distribution<double> real{-1e6, 1e6}; // NOLINT
+  for (size_t i = 0; i < n; ++i) {
+    uint64_t bits = gen();
+    u32[i] = static_cast<uint32_t>(bits);
+    i64[i] = static_cast<int64_t>(bits);
+    small[i] = static_cast<int16_t>(static_cast<int>(bits % 200) - 100);
+    bytes[i] = static_cast<uint8_t>(bits);
+    f64[i] = real(gen);
+    f32[i] = static_cast<float>(f64[i]);
+  } // for ..i
+  for (float special : {-0.0F, 0.0F, std::numeric_limits<float>::infinity(),
+                        -std::numeric_limits<float>::infinity(),
+                        std::numeric_limits<float>::denorm_min(),
+                        -std::numeric_limits<float>::denorm_min(),
+                        std::numeric_limits<float>::lowest(),
+                        std::numeric_limits<float>::max()}) {
+    f32.push_back(special);
+    f64.push_back(static_cast<double>(special));
+  } // for ..special
+
+  checkRadixSort(u32);
+  checkRadixSort(i64);
+  checkRadixSort(small);
+  checkRadixSort(bytes);
+  checkRadixSort(f32);
+  checkRadixSort(f64);
+  // Below kRadixMinSize, std::sort does it.
+  checkRadixSort(std::vector<float>(f32.begin(), f32.begin() + 10));
+
+  // Equal deadlines keep their ids in order.
+  std::vector<Deadline> jobs;
+  for (int id = 0; id < static_cast<int>(n); ++id) {
+    jobs.push_back({static_cast<uint32_t>(gen() % 100), id}); // NOLINT
+  } // for ..id
+  sortByCompare(jobs, std::less<Deadline>{});
+  for (size_t i = 1; i < jobs.size(); ++i) {
+    assert(jobs[i - 1].due < jobs[i].due ||
+           (jobs[i - 1].due == jobs[i].due && jobs[i - 1].id < jobs[i].id));
+  } // for ..i
+  sortByCompare(jobs, std::greater<Deadline>{});
+  assert(std::is_sorted(jobs.begin(), jobs.end(), std::greater<Deadline>{}));
+
+  // SortedPQ's range constructor and updatePriorities() use it.
+  SortedPQ<float, std::greater<float>> pq{f32.begin(), f32.end()};
+  std::vector<float> expected{f32};
+  std::sort(expected.begin(), expected.end());
+  for ([[maybe_unused]] float val : expected) {
+    assert(pq.top() == val);
+    pq.pop();
+  } // for ..val
+  SortedPQ<int64_t> big{i64.begin(), i64.end()};
+  big.push(std::numeric_limits<int64_t>::min());
+  big.updatePriorities();
+  assert(big.top() == *std::max_element(i64.begin(), i64.end()));
+  assert(big.drainSorted().front() == std::numeric_limits<int64_t>::min());
+
+  std::cout << "testRadixSort succeeded!" << std::endl;
+} // testRadixSort()
+
+// Test that AdaptivePQ migrates between its backends as its size and merge
+// rate change, without losing or reordering elements.
+void testAdaptive() {
+  std::cout << "Testing Adaptive PQ separately..." << std::endl;
+  using Backend [[maybe_unused]] = AdaptivePQ<int>::Backend;
+
+  AdaptiveThresholds limits;
+  limits.binaryAbove = 8;    // NOLINT: small thresholds for the test
+  limits.unorderedBelow = 4; // NOLINT
+  limits.window = 16;        // NOLINT
+  AdaptivePQ<int> pq{std::less<int>{}, {}, limits};
+  assert(pq.backend() == Backend::Unordered);
+
+  for (int i = 0; i < 20; ++i) { // NOLINT: grow past binaryAbove
+    pq.push((i * 7) % 20);       // NOLINT: a permutation of 0..19
+  } // for ..i
+  assert(pq.backend() == Backend::Binary);
+  assert(pq.migrations() == 1);
+
+  // Within the hysteresis band nothing moves.
+  for (int expected = 19; expected > 4; --expected) { // NOLINT
+    assert(pq.top() == expected);
+    pq.pop();
+  } // for ..expected
+  assert(pq.backend() == Backend::Binary);
+  pq.pop();
+  pq.pop();
+  assert(pq.backend() == Backend::Unordered);
+  assert(pq.top() == 2);
+
+  // Frequent merges move to PairingPQ, and it is left once they stop.
+  for (int round = 0; round < 32; ++round) { // NOLINT: a full window
+    AdaptivePQ<int> other{std::less<int>{}, {}, limits};
+    other.push(100 + round); // NOLINT: arbitrary larger values
+    pq.merge(other);
+    assert(other.empty());
+  } // for ..round
+  assert(pq.backend() == Backend::Pairing);
+  assert(pq.top() == 131);
+  for (int i = 0; i < 64; ++i) { // NOLINT: several windows without merges
+    pq.push(i % 3);              // NOLINT
+  } // for ..i
+  assert(pq.backend() == Backend::Binary);
+
+  std::vector<int> drained;
+  pq.drainSorted(std::back_inserter(drained));
+  assert(drained.size() == 3 + 32 + 64);
+  assert(std::is_sorted(drained.rbegin(), drained.rend()));
+  assert(drained.front() == 131);
+
+  // An assigned PQ migrates with the comparator it was assigned, not the
+  // one it was constructed with.
+  using DirectedPQ = AdaptivePQ<int, DirectedComp>;
+  DirectedPQ minFirst{DirectedComp{true}, {}, limits};
+  for (int i = 0; i < 4; ++i) { // NOLINT: stay below binaryAbove
+    minFirst.push(10 + i);      // NOLINT: arbitrary values
+  } // for ..i
+  DirectedPQ copied{DirectedComp{}, {}, limits};
+  copied = minFirst;
+  DirectedPQ moved{DirectedComp{}, {}, limits};
+  moved = std::move(minFirst);
+  for (DirectedPQ *assigned : {&copied, &moved}) {
+    for (int i = 0; i < 8; ++i) { // NOLINT: grow past binaryAbove
+      assigned->push(20 - i);     // NOLINT: arbitrary values
+    } // for ..i
+    assert(assigned->backend() == DirectedPQ::Backend::Binary);
+    std::vector<int> ascending;
+    assigned->drainSorted(std::back_inserter(ascending));
+    assert(ascending.size() == 12);
+    assert(std::is_sorted(ascending.begin(), ascending.end()));
+  } // for ..assigned
+
+  // Two PairingPQ backends on different pmr resources: the merge must copy
+  // the elements, since the arena's nodes go away with it.
+  using PmrPQ =
+      AdaptivePQ<int, std::less<int>, std::pmr::polymorphic_allocator<int>>;
+  auto mergeUntilPairing = [&limits](PmrPQ &target,
+                                     std::pmr::memory_resource *resource) {
+    for (int round = 0; round < 16; ++round) { // NOLINT: several windows
+      PmrPQ single{std::less<int>{}, resource, limits};
+      single.push(round);
+      target.merge(single);
+    } // for ..round
+  };
+  std::pmr::unsynchronized_pool_resource pool;
+  PmrPQ pooled{std::less<int>{}, &pool, limits};
+  mergeUntilPairing(pooled, &pool);
+  assert(pooled.backend() == PmrPQ::Backend::Pairing);
+  {
+    std::vector<std::byte> buffer(1 << 14); // NOLINT: arena size
+    std::pmr::monotonic_buffer_resource arena{
+        buffer.data(), buffer.size(), std::pmr::null_memory_resource()};
+    PmrPQ scoped{std::less<int>{}, &arena, limits};
+    mergeUntilPairing(scoped, &arena);
+    assert(scoped.backend() == PmrPQ::Backend::Pairing);
+    scoped.push(99); // NOLINT: larger than every merged element
+    pooled.merge(scoped);
+    assert(scoped.empty());
+  } // block for releasing the arena
+  assert(pooled.size() == 33);
+  assert(pooled.top() == 99);
+
+  std::cout << "testAdaptive succeeded!" << std::endl;
+} // testAdaptive()
+
+// Test that copies of a PersistentPQ share nodes without affecting each
+// other: many clones of one heap diverge by a few operations each, and the
+// original must still drain in order.  Also release a heap whose left
+// spine is as long as the heap.
+void testPersistent() {
+  std::cout << "Testing Persistent PQ separately..." << std::endl;
+
+  std::mt19937 gen{281}; // NOLINT: fixed seed for reproducible tests
+  std::uniform_int_distribution<int> dist{0, 9999}; // NOLINT
+  std::vector<int> vec(1000);                      // NOLINT
+  for (auto &val : vec) {
+    val = dist(gen);
+  } // for ..val
+  std::vector<int> expected{vec};
+  std::sort(expected.begin(), expected.end(), std::greater<int>{});
+
+  PersistentPQ<int> original{vec.begin(), vec.end()};
+  std::vector<PersistentPQ<int>> clones;
+  for (int i = 0; i < 100; ++i) { // NOLINT: number of clones
+    clones.push_back(original);
+    PersistentPQ<int> &clone = clones.back();
+    for (int op = 0; op < 5; ++op) { // NOLINT: a few ops per clone
+      if (dist(gen) % 2 == 0) {
+        clone.push(dist(gen));
+      } else {
+        clone.pop();
+      } // if
+    }   // for ..op
+  }     // for ..i
+
+  // Each clone is an independent, valid heap of the right size...
+  for (auto &clone : clones) {
+    std::vector<int> drained;
+    [[maybe_unused]] size_t size = clone.size();
+    clone.drainSorted(std::back_inserter(drained));
+    assert(drained.size() == size);
+    assert(std::is_sorted(drained.rbegin(), drained.rend()));
+  } // for ..clone
+
+  // ...and the original is untouched.
+  PersistentPQ<int> copy{original};
+  std::vector<int> drained;
+  original.drainSorted(std::back_inserter(drained));
+  assert(drained == expected);
+  assert(copy.size() == vec.size());
+  assert(copy.top() == expected.front());
+
+  // merge() leaves its argument alone; a self-merge doubles the elements.
+  PersistentPQ<int> small;
+  small.push(3);
+  small.push(5); // NOLINT
+  copy.merge(small);
+  assert(small.size() == 2 && small.top() == 5);
+  assert(copy.size() == vec.size() + 2);
+  small.merge(small);
+  std::vector<int> doubled;
+  small.drainSorted(std::back_inserter(doubled));
+  assert((doubled == std::vector<int>{5, 5, 3, 3}));
+
+  // Increasing pushes build one long left spine.
+  PersistentPQ<int> chain;
+  for (int i = 0; i < 200000; ++i) { // NOLINT: deep enough to overflow
+    chain.push(i);                   //         a recursive destructor
+  } // for ..i
+  PersistentPQ<int> chainCopy{chain};
+  chain.pop();
+  assert(chain.top() == 199998);
+  assert(chainCopy.top() == 199999);
+
+  std::cout << "testPersistent succeeded!" << std::endl;
+} // testPersistent()
+
+// Test the timing wheel against a std::multiset of ticks with a random mix
+// of schedules (near, far and in the past), cancels, reschedules and pops.
+// TimingWheel is keyed on ticks rather than a comparator, so it does not
+// fit the generic tests above.
+void testTimingWheel() {
+  std::cout << "Testing TimingWheel separately..." << std::endl;
+  using Wheel = TimingWheel<uint64_t>;
+
+  std::mt19937_64 gen{281}; // NOLINT: fixed seed for reproducible tests
+  std::uniform_int_distribution<int> op{0, 9}; // NOLINT: operation mix
+  Wheel wheel;
+  std::multiset<uint64_t> expected;
+  std::vector<Wheel::Node *> handles;
+  uint64_t clock = 1000; // NOLINT: leave room for ticks in the past
+
+  // Ticks are kept unique, so that pop() has only one candidate and the
+  // test knows which handle it invalidates.
+  auto anyTick = [&]() -> uint64_t {
+    switch (op(gen) % 5) { // NOLINT: pick a distance class
+    case 0:
+      return clock + gen() % 64; // NOLINT: level 0
+    case 1:
+      return clock + gen() % 100000; // NOLINT: a few levels up
+    case 2:
+      return clock + (gen() >> 2); // NOLINT: the top levels
+    case 3:
+      return clock - gen() % 1000; // NOLINT: in the past
+    default:
+      return clock;
+    } // switch
+  };
+  auto randomTick = [&]() {
+    uint64_t tick = anyTick();
+    while (expected.count(tick) != 0) {
+      tick = anyTick();
+    } // while
+    return tick;
+  };
+  auto removeHandle = [&](size_t idx) {
+    std::swap(handles[idx], handles.back());
+    handles.pop_back();
+  };
+
+  for (int round = 0; round < 20000; ++round) { // NOLINT
+    int choice = op(gen);
+    if (choice < 4 || expected.empty()) { // NOLINT: schedule
+      uint64_t tick = randomTick();
+      handles.push_back(wheel.schedule(tick));
+      expected.insert(tick);
+    } else if (choice < 6) { // NOLINT: cancel
+      size_t idx = gen() % handles.size();
+      expected.erase(expected.find(**handles[idx]));
+      wheel.cancel(handles[idx]);
+      removeHandle(idx);
+    } else if (choice < 7) { // NOLINT: reschedule
+      size_t idx = gen() % handles.size();
+      uint64_t tick = randomTick();
+      expected.erase(expected.find(**handles[idx]));
+      expected.insert(tick);
+      wheel.reschedule(handles[idx], tick);
+    } else { // pop, advancing the clock
+      clock = wheel.top();
+      auto it = std::find_if(handles.begin(), handles.end(),
+                             [&](auto *node) { return **node == clock; });
+      assert(it != handles.end());
+      removeHandle(static_cast<size_t>(it - handles.begin()));
+      wheel.pop();
+      expected.erase(expected.begin());
+    } // if
+    assert(wheel.size() == expected.size());
+    assert(wheel.empty() || wheel.top() == *expected.begin());
+  } // for ..round
+
+  // Copies are independent, eraseIf() and updatePriorities() keep order.
+  Wheel copy{wheel};
+  auto odd = [](uint64_t tick) { return tick % 2 == 1; };
+  [[maybe_unused]] size_t erased = wheel.eraseIf(odd);
+  assert(erased == static_cast<size_t>(
+                       std::count_if(expected.begin(), expected.end(), odd)));
+  wheel.updatePriorities();
+  std::vector<uint64_t> drained;
+  wheel.drainSorted(std::back_inserter(drained));
+  std::vector<uint64_t> even;
+  std::remove_copy_if(expected.begin(), expected.end(),
+                      std::back_inserter(even), odd);
+  assert(drained == even);
+  assert(copy.size() == expected.size());
+  std::vector<uint64_t> all;
+  copy.drainSorted(std::back_inserter(all));
+  assert(std::equal(all.begin(), all.end(), expected.begin(), expected.end()));
+
+  // replaceTop() and pushPop() reuse the earliest timer's node.
+  Wheel fused;
+  fused.push(100); // NOLINT
+  fused.push(200); // NOLINT
+  [[maybe_unused]] Wheel::Node *first = fused.schedule(50); // NOLINT
+  fused.replaceTop(300);                                    // NOLINT
+  assert(**first == 300);
+  assert(fused.top() == 100);
+  [[maybe_unused]] uint64_t popped = fused.pushPop(10); // NOLINT
+  assert(popped == 10); // NOLINT: earlier than every timer
+  popped = fused.pushPop(250); // NOLINT
+  assert(popped == 100);       // NOLINT
+  assert(fused.size() == 3);
+  assert(fused.top() == 200);
+
+  std::cout << "testTimingWheel succeeded!" << std::endl;
+} // testTimingWheel()
+
+// A sequence heap with a 16-int insertion heap and 4 runs per group, so
+// that a few thousand elements fill several groups.
+template <typename TYPE, typename COMP_FUNCTOR = std::less<TYPE>,
+          typename ALLOCATOR = std::allocator<TYPE>>
+using SmallSequenceHeapPQ =
+    SequenceHeapPQ<TYPE, COMP_FUNCTOR, ALLOCATOR,
+                   SequenceHeapSizes<16 * sizeof(int), 4>>; // NOLINT
+
+// A 16-byte element with a payload, ordered by its key only.
+struct KeyedPayload {
+  uint64_t key;
+  uint64_t payload;
+}; // KeyedPayload
+
+struct KeyedPayloadLess {
+  bool operator()(const KeyedPayload &a, const KeyedPayload &b) const {
+    return a.key < b.key;
+  } // operator()()
+};  // KeyedPayloadLess
+
+// Test the sequence heap's runs, groups and buffers against a
+// std::multiset: pushes and pops mixed with replaceTop() (including new
+// elements more extreme than the buffered ones, which must go back to the
+// buffers), a bulk-built heap several groups deep, eraseIf() and copies
+// while groups are full, and 16-byte elements.
+void testSequenceHeap() {
+  std::cout << "Testing SequenceHeapPQ runs and groups..." << std::endl;
+
+  std::mt19937 gen{281}; // NOLINT: fixed seed for reproducible tests
+  std::uniform_int_distribution<int> dist{0, 99999}; // NOLINT
+  SmallSequenceHeapPQ<int> pq;
+  std::multiset<int> expected;
+  for (int round = 0; round < 60000; ++round) { // NOLINT: grow and shrink
+    int val = dist(gen);
+    // Growing with replaceTop() mixed in, then shrinking.
+    int op = round < 30000 ? val % 8 : (val % 3 == 0 ? 0 : 4); // NOLINT
+    if (expected.empty() || op < 4) {
+      pq.push(val);
+      expected.insert(val);
+    } else if (op == 4) {
+      assert(pq.top() == *expected.rbegin());
+      pq.pop();
+      expected.erase(std::prev(expected.end()));
+    } else {
+      // Above most of what is buffered, half of the time.
+      val += op == 5 ? 50000 : 0; // NOLINT
+      assert(pq.top() == *expected.rbegin());
+      pq.replaceTop(val);
+      expected.erase(std::prev(expected.end()));
+      expected.insert(val);
+    } // if
+    assert(pq.size() == expected.size());
+    if (round == 20000) { // NOLINT: while several groups are in use
+      assert(pq.groupsInUse() >= 3);
+      SmallSequenceHeapPQ<int> copy{pq};
+      std::vector<int> drained;
+      copy.drainSorted(std::back_inserter(drained));
+      assert(std::equal(drained.begin(), drained.end(), expected.rbegin(),
+                        expected.rend()));
+      auto odd = [](int elt) { return elt % 2 != 0; };
+      pq.eraseIf(odd);
+      for (auto it = expected.begin(); it != expected.end();) {
+        it = odd(*it) ? expected.erase(it) : std::next(it);
+      } // for ..it
+      assert(pq.size() == expected.size());
+    } // if
+  }   // for ..round
+  while (!expected.empty()) {
+    assert(pq.top() == *expected.rbegin());
+    pq.pop();
+    expected.erase(std::prev(expected.end()));
+  } // while
+  assert(pq.empty());
+
+  std::vector<int> vec(5000); // NOLINT: 16 * 4^5 > 5000 > 16 * 4^4
+  for (auto &val : vec) {
+    val = dist(gen);
+  } // for ..val
+  SmallSequenceHeapPQ<int, std::greater<int>> minPQ{vec.begin(), vec.end()};
+  assert(minPQ.groupsInUse() == 6);
+  std::sort(vec.begin(), vec.end());
+  for (size_t i = 0; i < vec.size(); ++i) {
+    assert(minPQ.top() == vec[i]);
+    minPQ.pop();
+    if (i % 3 == 0) { // NOLINT: new elements join the buffered ones
+      minPQ.push(vec[i]);
+      assert(minPQ.top() == vec[i]);
+      minPQ.pop();
+    } // if
+  }   // for ..i
+  assert(minPQ.empty());
+
+  SequenceHeapPQ<KeyedPayload, KeyedPayloadLess,
+                 std::allocator<KeyedPayload>,
+                 SequenceHeapSizes<64, 2>> // NOLINT: 4 elements, 2 runs
+      wide;
+  for (uint64_t i = 0; i < 1000; ++i) { // NOLINT
+    wide.push(KeyedPayload{(i * 7919) % 1000, i}); // NOLINT: a permutation
+  } // for ..i
+  for (uint64_t key = 1000; key-- > 0;) { // NOLINT
+    assert(wide.top().key == key);
+    assert((wide.top().payload * 7919) % 1000 == key); // NOLINT
+    wide.pop();
+  } // for ..key
+
+  std::cout << "testSequenceHeap succeeded!" << std::endl;
+} // testSequenceHeap()
+
+// Run the tests every PQ type must pass.
+template <template <typename...> typename PQ> void testCommonOperations() {
   testPrimitiveOperations<PQ>();
   testHiddenData<PQ>();
   testUpdatePriorities<PQ>();
+  testAllocator<PQ>();
+  testDrainSorted<PQ>();
+  testEraseIf<PQ>();
+  testReplaceTop<PQ>();
+  testRecording<PQ>();
+  testThreadPool<PQ>();
+  testSnapshot<PQ>();
+  testFlatCombining<PQ>();
+  testMemoryUsage<PQ>();
+  testCompareAssignment<PQ>();
+} // testCommonOperations()
+
+// Run all tests for a particular PQ type.
+template <template <typename...> typename PQ> void testPriorityQueue() {
+  testCommonOperations<PQ>();
+  testShrinkPolicy<PQ<int, std::less<int>, std::allocator<int>, SmallShrink>>();
 } // testPriorityQueue()
 
 // PairingPQ has some extra behavior we need to test in updateElement.
 // This template specialization handles that without changing the nice
 // uniform interface of testPriorityQueue.
 template <> void testPriorityQueue<PairingPQ>() {
-  testPrimitiveOperations<PairingPQ>();
-  testHiddenData<PairingPQ>();
-  testUpdatePriorities<PairingPQ>();
+  testCommonOperations<PairingPQ>();
   testPairing();
+  testPairingReplaceTop();
+  testPairingMerge();
+  testPairingRecording();
 } // testPriorityQueue<PairingPQ>()
 
+// CompactPairingPQ has handles of its own, and no SHRINK policy: slots
+// cannot move while handles refer to them.
+template <> void testPriorityQueue<CompactPairingPQ>() {
+  testCommonOperations<CompactPairingPQ>();
+  testCompactPairing();
+} // testPriorityQueue<CompactPairingPQ>()
+
+// BinaryPQ has three sift paths and two layouts.
+template <> void testPriorityQueue<BinaryPQ>() {
+  testCommonOperations<BinaryPQ>();
+  testShrinkPolicy<
+      BinaryPQ<int, std::less<int>, std::allocator<int>, FlatLayout,
+               SmallShrink>>();
+  testBinarySift();
+  testPushRange();
+  testCommonOperations<SmallPageBHeapPQ>();
+  testShrinkPolicy<BinaryPQ<int, std::less<int>, std::allocator<int>,
+                             BHeapLayout<64>, SmallShrink>>(); // NOLINT
+  testBHeap();
+  testConstexpr<BinaryPQ<int>>();
+  testConstexpr<BottomUpPQ<int>>();
+  testConstexpr<SmallPageBHeapPQ<int>>();
+  testCommonOperations<BottomUpPQ>();
+  testBottomUp();
+} // testPriorityQueue<BinaryPQ>()
+
+// AdaptivePQ also migrates between backends.
+template <> void testPriorityQueue<AdaptivePQ>() {
+  testCommonOperations<AdaptivePQ>();
+  testShrinkPolicy<
+      AdaptivePQ<int, std::less<int>, std::allocator<int>, SmallShrink>>();
+  testAdaptive();
+} // testPriorityQueue<AdaptivePQ>()
+
+// PersistentPQ also has O(1) copies that share nodes.
+template <> void testPriorityQueue<PersistentPQ>() {
+  testCommonOperations<PersistentPQ>();
+  testPersistent();
+} // testPriorityQueue<PersistentPQ>()
+
+// MinMaxPQ also offers bottom() and popBottom().
+template <> void testPriorityQueue<MinMaxPQ>() {
+  testCommonOperations<MinMaxPQ>();
+  testShrinkPolicy<
+      MinMaxPQ<int, std::less<int>, std::allocator<int>, SmallShrink>>();
+  testMinMax();
+} // testPriorityQueue<MinMaxPQ>()
+
+// SequenceHeapPQ has no SHRINK policy; the small one has runs in several
+// groups even in the generic tests.
+template <> void testPriorityQueue<SequenceHeapPQ>() {
+  testCommonOperations<SequenceHeapPQ>();
+  testCommonOperations<SmallSequenceHeapPQ>();
+  testSequenceHeap();
+} // testPriorityQueue<SequenceHeapPQ>()
+
 int main() {
   const std::vector<PQType> types{
       PQType::Unordered,
       PQType::Sorted,
       PQType::Binary,
       PQType::Pairing,
+      PQType::UnorderedFast,
+      PQType::MinMax,
+      PQType::Adaptive,
+      PQType::Persistent,
+      PQType::TimingWheel,
+      PQType::CompactPairing,
+      PQType::SequenceHeap,
+      PQType::Extras,
   };
 
   std::cout << "PQ tester" << std::endl << std::endl;
@@ -343,6 +2438,8 @@ int main() {
     break;
   case PQType::Sorted:
     testPriorityQueue<SortedPQ>();
+    testConstexpr<SortedPQ<int>>();
+    testRadixSort();
     break;
   case PQType::Binary:
     testPriorityQueue<BinaryPQ>();
@@ -350,9 +2447,38 @@ int main() {
   case PQType::Pairing:
     // testPriorityQueue<PairingPQ>();
     // testPairing();
+    testPriorityQueue<PairingPQ>();
     testPairing2();
     testPairing3();
     break;
+  case PQType::UnorderedFast:
+    testPriorityQueue<UnorderedFastPQ>();
+    break;
+  case PQType::MinMax:
+    testPriorityQueue<MinMaxPQ>();
+    break;
+  case PQType::Adaptive:
+    testPriorityQueue<AdaptivePQ>();
+    break;
+  case PQType::Persistent:
+    testPriorityQueue<PersistentPQ>();
+    break;
+  case PQType::TimingWheel:
+    testTimingWheel();
+    testMemoryUsage<TimingWheel>();
+    break;
+  case PQType::CompactPairing:
+    testPriorityQueue<CompactPairingPQ>();
+    break;
+  case PQType::SequenceHeap:
+    testPriorityQueue<SequenceHeapPQ>();
+    break;
+  case PQType::Extras:
+    // Utilities built on the PQs rather than PQ types of their own.
+    testTopK();
+    testLoserTree();
+    testSharedMemory();
+    break;
   default:
     std::cout << "Unrecognized PQ type " << pqType << " in main.\n"
               << "You must add tests for all PQ types." << std::endl;